@@ -0,0 +1,122 @@
+//
+//  bench_bind.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  同一份数据: parse成Json再用getter取字段, 和readJson直接读到结构体里比较
+//  写的方向: 先拼Json再dump, 和writeJson直接从结构体写出来比较
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../myJsonBind.hpp"
+
+using namespace myJson;
+
+struct Order
+{
+    int64_t id = 0;
+    std::string user;
+    double price = 0;
+    uint32_t quantity = 0;
+    bool paid = false;
+    std::vector<std::string> tags;
+};
+MYJSON_DEFINE(Order, id, user, price, quantity, paid, tags)
+
+static std::string makeOrders(size_t count)
+{
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":" + std::to_string(1000000 + i) + ",\"user\":\"user" + std::to_string(i % 977) +
+               "\",\"price\":" + std::to_string(i % 500) + ".25,\"quantity\":" + std::to_string(i % 9 + 1) +
+               ",\"paid\":" + (i % 3 ? "true" : "false") + ",\"note\":\"ignored\",\"tags\":[\"a\",\"b\"]}";
+    }
+    out += "]";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+// 经过Json树的读法
+static std::vector<Order> readThroughDom(const std::string &payload)
+{
+    Json json = parse(payload);
+    std::vector<Order> orders;
+    orders.reserve(json.getArray().size());
+    for (const Json &item : json.getArray())
+    {
+        Order order;
+        const object &members = item.getObject();
+        order.id = members.at("id").getInt64();
+        const jsonstring &user = members.at("user").getString();
+        order.user.assign(user.data(), user.size());
+        order.price = members.at("price").getNumber();
+        order.quantity = static_cast<uint32_t>(members.at("quantity").getInt64());
+        order.paid = members.at("paid").getBool();
+        for (const Json &tag : members.at("tags").getArray())
+            order.tags.emplace_back(tag.getString().data(), tag.getString().size());
+        orders.push_back(std::move(order));
+    }
+    return orders;
+}
+
+static Json buildDom(const std::vector<Order> &orders)
+{
+    Json json{array()};
+    for (const Order &order : orders)
+    {
+        Json item{object()};
+        item["id"] = order.id;
+        item["user"] = order.user;
+        item["price"] = order.price;
+        item["quantity"] = static_cast<int64_t>(order.quantity);
+        item["paid"] = order.paid;
+        Json tags{array()};
+        for (const auto &tag : order.tags)
+            tags.addToArray(tag);
+        item["tags"] = tags;
+        json.addToArray(item);
+    }
+    return json;
+}
+
+int main()
+{
+    std::string payload = makeOrders(100000);
+    double mb = payload.size() / (1024.0 * 1024.0);
+
+    std::vector<Order> orders;
+    double dom = bestOf(5, [&]
+                        { orders = readThroughDom(payload); });
+    double direct = bestOf(5, [&]
+                           { orders = readJson<std::vector<Order>>(payload); });
+    std::cout << "read:  dom+getters=" << mb / dom << "MB/s readJson=" << mb / direct << "MB/s" << std::endl;
+
+    std::string out;
+    double domWrite = bestOf(5, [&]
+                             { out = buildDom(orders).dump(); });
+    double directWrite = bestOf(5, [&]
+                                { out = writeJson(orders); });
+    std::cout << "write: dom+dump=" << orders.size() / domWrite / 1e6 << "M items/s writeJson=" << orders.size() / directWrite / 1e6 << "M items/s" << std::endl;
+    return 0;
+}
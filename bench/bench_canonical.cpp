@@ -0,0 +1,80 @@
+//
+//  bench_canonical.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  规范化输出: dump()和writeCanonical写字符串比较
+//  算摘要: 先生成完整的规范化字符串再hash, 和直接流式写进Sha256/Xxh64比较
+//
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../myJsonCanonical.hpp"
+
+using namespace myJson;
+
+static std::string makeDocument(size_t count)
+{
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"name\":\"user" + std::to_string(i) + "\",\"id\":" + std::to_string(i) + ",\"score\":" + std::to_string(i % 100) +
+               ".25,\"tags\":[\"a\",\"b\",null,true],\"address\":{\"zip\":\"" + std::to_string(10000 + i % 90000) + "\",\"city\":\"Z\\u00fcrich\"}}";
+    }
+    out += "]";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+int main()
+{
+    const std::string text = makeDocument(100000);
+    Json doc = parse(text);
+    size_t sink = 0;
+    std::cout << "document bytes: " << text.size() << std::endl;
+
+    double dumped = bestOf(5, [&]
+                           { sink += doc.dump().size(); });
+    double canonical = bestOf(5, [&]
+                              { sink += writeCanonical(doc).size(); });
+    std::cout << "string: dump " << dumped * 1e3 << " ms, canonical " << canonical * 1e3 << " ms" << std::endl;
+
+    double shaString = bestOf(5, [&]
+                              {
+        std::string out = writeCanonical(doc);
+        Sha256 sha;
+        sha.write(out.data(), out.size());
+        sink += sha.digest()[0]; });
+    double shaStream = bestOf(5, [&]
+                              { sink += canonicalSha256(doc)[0]; });
+    std::cout << "sha256: string then hash " << shaString * 1e3 << " ms, streamed " << shaStream * 1e3 << " ms" << std::endl;
+
+    double xxhString = bestOf(5, [&]
+                              {
+        std::string out = writeCanonical(doc);
+        Xxh64 xxh;
+        xxh.write(out.data(), out.size());
+        sink += xxh.digest() & 1; });
+    double xxhStream = bestOf(5, [&]
+                              { sink += canonicalXxh64(doc) & 1; });
+    std::cout << "xxh64: string then hash " << xxhString * 1e3 << " ms, streamed " << xxhStream * 1e3 << " ms" << std::endl;
+    std::cout << "(" << sink << ")" << std::endl;
+    return 0;
+}
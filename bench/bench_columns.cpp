@@ -0,0 +1,96 @@
+//
+//  bench_columns.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  对象数组上的聚合: parse后逐行operator[]取字段, 和拆成列之后在连续的数组上算比较
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "../myJsonColumns.hpp"
+
+using namespace myJson;
+
+static std::string makeRecords(size_t count)
+{
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":" + std::to_string(i) + ",\"region\":\"r" + std::to_string(i % 17) + "\",\"price\":" + std::to_string(i % 1000) +
+               ".5,\"quantity\":" + std::to_string(i % 7 + 1) + ",\"note\":\"unused field\",\"discount\":" + (i % 5 ? "0.1" : "null") + "}";
+    }
+    out += "]";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+// sum(price * quantity * (1 - discount)), discount为null时按0算
+static double aggregate(const ColumnTable &table)
+{
+    const Column &price = table["price"];
+    const Column &quantity = table["quantity"];
+    const Column &discount = table["discount"];
+    double sum = 0;
+    for (size_t i = 0; i < table.rows; i++)
+        sum += price.numbers[i] * quantity.numbers[i] * (1 - discount.numbers[i]);
+    return sum;
+}
+
+int main()
+{
+    const size_t count = 200000;
+    const std::string text = makeRecords(count);
+    const std::vector<ColumnSpec> fields = {{"price", ColumnType::NUMBER}, {"quantity", ColumnType::NUMBER}, {"discount", ColumnType::NUMBER}};
+    double checks[4] = {};
+
+    const Json json = parse(text);
+    double domScan = bestOf(5, [&]
+                            {
+        double sum = 0;
+        for (auto iter = json.const_arrayBegin(); iter != json.const_arrayEnd(); ++iter)
+        {
+            const Json &row = *iter;
+            const Json &discount = row["discount"];
+            sum += row["price"].getNumber() * row["quantity"].getNumber() * (1 - (discount.is_null() ? 0 : discount.getNumber()));
+        }
+        checks[0] = sum; });
+
+    const ColumnTable table = toColumns(json, fields);
+    double columnScan = bestOf(5, [&]
+                               { checks[1] = aggregate(table); });
+
+    double parseThenScan = bestOf(3, [&]
+                                  {
+        Json parsed = parse(text);
+        checks[2] = aggregate(toColumns(parsed, fields)); });
+
+    double streaming = bestOf(3, [&]
+                              { checks[3] = aggregate(toColumns(text, fields)); });
+
+    std::cout << "rows: " << count << ", bytes: " << text.size() << std::endl;
+    std::cout << "scan Json rows:         " << domScan * 1e3 << " ms" << std::endl;
+    std::cout << "scan columns:           " << columnScan * 1e3 << " ms (" << domScan / columnScan << "x)" << std::endl;
+    std::cout << "parse + toColumns:      " << parseThenScan * 1e3 << " ms" << std::endl;
+    std::cout << "toColumns from text:    " << streaming * 1e3 << " ms (" << parseThenScan / streaming << "x)" << std::endl;
+    std::cout << "checksums: " << checks[0] << " " << checks[1] << " " << checks[2] << " " << checks[3] << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+//  bench_edit.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  几MB的文档里改一个字段: parse + operator[] + dump, 和JsonEditor只替换那一段比较
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "../myJsonBind.hpp"
+#include "../myJsonEdit.hpp"
+
+using namespace myJson;
+
+static std::string makeDocument(size_t count)
+{
+    std::string out = "{\"version\":1,\"items\":[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":" + std::to_string(i) + ",\"name\":\"item" + std::to_string(i) + "\",\"price\":" + std::to_string(i % 100) +
+               ".5,\"tags\":[\"a\",\"b\",\"c\"],\"stock\":{\"warehouse\":\"w" + std::to_string(i % 7) + "\",\"count\":" + std::to_string(i % 50) + "}}";
+    }
+    out += "],\"updated\":\"2026-10-19\"}";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+int main()
+{
+    const size_t count = 40000;
+    const std::string text = makeDocument(count);
+    size_t sink = 0;
+
+    // 路径越靠后扫描越长, 分别测开头, 中间, 结尾
+    const std::string paths[] = {"/version", "/items/" + std::to_string(count / 2) + "/stock/count", "/updated"};
+    std::cout << "document bytes: " << text.size() << std::endl;
+
+    double reparse = bestOf(3, [&]
+                            {
+        Json doc = parse(text);
+        doc["items"][count / 2]["stock"]["count"] = 99;
+        sink += writeJson(doc).size(); });
+    std::cout << "parse + set + writeJson:        " << reparse * 1e3 << " ms" << std::endl;
+
+    for (const std::string &path : paths)
+    {
+        std::string out;
+        double locate = bestOf(5, [&]
+                               {
+            JsonEditor editor(text);
+            editor.set(path, Json(99));
+            sink += editor.size(); });
+        double copy = bestOf(5, [&]
+                             {
+            JsonEditor editor(text);
+            editor.set(path, Json(99));
+            out.clear();
+            editor.apply(out);
+            sink += out.size(); });
+        std::cout << "edit " << path << ": locate " << locate * 1e3 << " ms, locate + apply " << copy * 1e3 << " ms" << std::endl;
+    }
+    std::cout << "(" << sink << ")" << std::endl;
+    return 0;
+}
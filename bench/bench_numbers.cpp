@@ -0,0 +1,96 @@
+//
+//  bench_numbers.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  ID密集的数据上比较整数快速路径和double路径的parse/dump速度
+//  double路径的数据是在同样的数字后面加".0", 逼parseNumber走strtod
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../myJson.hpp"
+
+using namespace myJson;
+
+// 纯ID数组, parse时间基本都花在数字上
+static std::string makeIdArray(size_t count, bool asDouble)
+{
+    std::mt19937_64 rng(7);
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += std::to_string((rng() >> 2) | (uint64_t(1) << 60));
+        out += asDouble ? ".0" : "";
+    }
+    out += "]";
+    return out;
+}
+
+static std::string makePayload(size_t records, bool asDouble)
+{
+    std::mt19937_64 rng(42);
+    std::string out = "[";
+    for (size_t i = 0; i < records; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":";
+        // snowflake风格的ID, 大于2^53
+        out += std::to_string((rng() >> 2) | (uint64_t(1) << 60));
+        out += asDouble ? ".0" : "";
+        out += ",\"user_id\":";
+        out += std::to_string(rng() % 100000000);
+        out += asDouble ? ".0" : "";
+        out += ",\"count\":";
+        out += std::to_string(rng() % 1000);
+        out += asDouble ? ".0" : "";
+        out += "}";
+    }
+    out += "]";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+static void run(const char *name, const std::string &payload)
+{
+    Json json;
+    double parseSeconds = bestOf(5, [&]
+                                 { json = parse(payload); });
+    std::string out;
+    double dumpSeconds = bestOf(5, [&]
+                                { out = json.dump(); });
+    double mb = payload.size() / (1024.0 * 1024.0);
+    std::cout << name << ": bytes=" << payload.size()
+              << " parse=" << mb / parseSeconds << "MB/s"
+              << " dump=" << json.getArray().size() / dumpSeconds / 1e6 << "M items/s" << std::endl;
+}
+
+int main()
+{
+    const size_t records = 200000;
+    run("records int64 fast path", makePayload(records, false));
+    run("records double path", makePayload(records, true));
+    run("ids int64 fast path", makeIdArray(records * 5, false));
+    run("ids double path", makeIdArray(records * 5, true));
+    return 0;
+}
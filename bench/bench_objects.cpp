@@ -0,0 +1,104 @@
+//
+//  bench_objects.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  几十万个key的大对象(比如feature flag表): parse先收集成员再一次建map,
+//  和每个成员直接往map里插一次(以前parse的做法, 这里用SAX回调模拟)比较
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "../myJson.hpp"
+
+using namespace myJson;
+
+// 每个成员try_emplace一次, 每次O(log n)次key比较
+class InsertHandler : public JsonHandler
+{
+public:
+    object members;
+    std::string pending;
+
+    bool null() override { return add(Json(nullptr)); }
+    bool boolean(bool value) override { return add(Json(value)); }
+    bool integer(int64_t value) override { return add(Json(value)); }
+    bool unsignedInteger(uint64_t value) override { return add(Json(value)); }
+    bool number(double value) override { return add(Json(value)); }
+    bool string(std::string_view value) override { return add(Json(std::string(value))); }
+    bool startObject() override { return true; }
+    bool key(std::string_view value) override
+    {
+        pending.assign(value.data(), value.size());
+        return true;
+    }
+    bool endObject() override { return true; }
+    bool startArray() override { return false; }
+    bool endArray() override { return false; }
+
+private:
+    bool add(Json value)
+    {
+        members.try_emplace(jsonstring(pending), std::move(value));
+        return true;
+    }
+};
+
+static std::string makeObject(size_t count, bool shuffled)
+{
+    std::string out = "{";
+    for (size_t i = 0; i < count; i++)
+    {
+        char key[32];
+        size_t id = shuffled ? (i * 7919) % count : i;
+        snprintf(key, sizeof(key), "flag.service.%08zu", id);
+        out += std::string(i ? "," : "") + "\"" + key + "\":" + (id % 3 ? "true" : "false");
+    }
+    out += "}";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+int main()
+{
+    const size_t count = 200000;
+    size_t sink = 0;
+    for (bool shuffled : {false, true})
+    {
+        const std::string text = makeObject(count, shuffled);
+        double bulk = bestOf(5, [&]
+                             { sink += parse(text).getObject().size(); });
+        double insert = bestOf(5, [&]
+                               {
+            InsertHandler handler;
+            ParseError error;
+            parse(text, handler, error);
+            sink += handler.members.size(); });
+        double stream = bestOf(5, [&]
+                               {
+            StreamParser parser;
+            parser.feed(text);
+            parser.finish();
+            sink += parser.release().getObject().size(); });
+        std::cout << (shuffled ? "shuffled keys: " : "sorted keys:   ") << "parse " << bulk * 1e3 << " ms, per-member insert "
+                  << insert * 1e3 << " ms, StreamParser " << stream * 1e3 << " ms" << std::endl;
+    }
+    std::cout << "(" << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+//
+//  bench_parallel.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  大树上比较dump()和dumpParallel()的吞吐, 顺便检查结果一样
+//
+//  用法: myjson_bench_parallel [records]
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "../myJsonParallel.hpp"
+
+using namespace myJson;
+
+// 聚合接口的响应: 外面一层小对象, 里面是大数组
+static Json makeResponse(size_t records)
+{
+    std::string text = "{\"meta\": {\"count\": " + std::to_string(records) + "}, \"records\": [";
+    for (size_t i = 0; i < records; i++)
+    {
+        if (i)
+            text += ",";
+        text += "{\"id\": " + std::to_string(i) + ", \"name\": \"user" + std::to_string(i % 1000) +
+                "\", \"score\": " + std::to_string(i % 97) + ".25, \"tags\": [\"a\", \"b\", \"c\"], \"active\": true}";
+    }
+    text += "]}";
+    return parse(text);
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+int main(int argc, const char *argv[])
+{
+    size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    Json json = makeResponse(records);
+    std::string sequential;
+    double base = bestOf(3, [&]
+                         { sequential = json.dump(); });
+    double mb = sequential.size() / (1024.0 * 1024.0);
+    std::cout << "bytes=" << sequential.size() << " dump=" << mb / base << "MB/s" << std::endl;
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 2; threads <= cores; threads *= 2)
+    {
+        ParallelDumpOptions options;
+        options.threads = threads;
+        std::string out;
+        double seconds = bestOf(3, [&]
+                                { out = dumpParallel(json, options); });
+        std::cout << "threads=" << threads << " dumpParallel=" << mb / seconds << "MB/s speedup=" << base / seconds
+                  << (out == sequential ? "" : " MISMATCH") << std::endl;
+    }
+    return 0;
+}
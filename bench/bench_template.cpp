@@ -0,0 +1,86 @@
+//
+//  bench_template.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  同一个响应: 每次拼Json再writeJson, 和Template只填槽比较
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "../myJsonBind.hpp"
+#include "../myJsonTemplate.hpp"
+
+using namespace myJson;
+
+static const char *SKELETON = R"({
+    "code": 0, "msg": "success", "request_id": "{{request}}",
+    "data": {
+        "user": {"id": "{{id}}", "name": "{{name}}", "level": 3, "vip": false,
+                 "roles": ["reader", "writer", "reviewer"], "locale": "zh_CN", "timezone": "Asia/Shanghai"},
+        "limits": {"qps": 200, "burst": 400, "daily": 1000000, "regions": ["cn-north", "cn-east", "ap-southeast"]},
+        "features": {"search": true, "export": true, "beta": false, "theme": "dark"},
+        "balance": "{{balance}}"
+    },
+    "links": {"self": "/v1/users/me", "docs": "https://example.com/docs/users"}
+})";
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+int main()
+{
+    const int requests = 100000;
+    const Json skeleton = parse(SKELETON);
+    size_t sink = 0;
+
+    // 每个请求: 拷贝骨架, 改几个值, 整个序列化
+    double dom = bestOf(5, [&]
+                        {
+        for (int i = 0; i < requests; i++)
+        {
+            Json response = skeleton;
+            response["request_id"] = "req-" + std::to_string(i);
+            Json &user = response["data"]["user"];
+            user["id"] = static_cast<int64_t>(i);
+            user["name"] = "user" + std::to_string(i % 977);
+            response["data"]["balance"] = i * 0.01;
+            sink += writeJson(response).size();
+        } });
+
+    Template tpl = Template::compile(skeleton);
+    TemplateArgs args(tpl);
+    std::string out;
+    double templated = bestOf(5, [&]
+                              {
+        for (int i = 0; i < requests; i++)
+        {
+            args.set("request", "req-" + std::to_string(i))
+                .set("id", static_cast<int64_t>(i))
+                .set("name", "user" + std::to_string(i % 977))
+                .set("balance", i * 0.01);
+            out.clear();
+            tpl.render(args, out);
+            sink += out.size();
+        } });
+
+    std::cout << "requests: " << requests << ", response bytes: " << out.size() << std::endl;
+    std::cout << "rebuild + writeJson: " << dom * 1e9 / requests << " ns/req" << std::endl;
+    std::cout << "template render:     " << templated * 1e9 / requests << " ns/req" << std::endl;
+    std::cout << "speedup: " << dom / templated << "x (" << sink << ")" << std::endl;
+    return 0;
+}
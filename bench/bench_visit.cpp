@@ -0,0 +1,159 @@
+//
+//  bench_visit.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  遍历整棵树: type()之后再getArray()/getObject()/get*(), 和visit一次分派比较
+//  原地抹掉敏感字段: 递归地用objectBegin/arrayBegin改, 和transform比较
+//
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../myJsonVisit.hpp"
+
+using namespace myJson;
+
+static std::string makeDocument(size_t count)
+{
+    std::string out = "[";
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":" + std::to_string(i) + ",\"name\":\"user" + std::to_string(i) + "\",\"ssn\":\"123-45-" + std::to_string(i % 10000) +
+               "\",\"score\":" + std::to_string(i % 100) + ".5,\"tags\":[\"a\",\"b\",null,true],\"card\":{\"pan\":\"4111\",\"exp\":\"12/30\"}}";
+    }
+    out += "]";
+    return out;
+}
+
+template <typename F>
+static double bestOf(int rounds, F &&f)
+{
+    double best = 1e300;
+    for (int i = 0; i < rounds; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - begin).count());
+    }
+    return best;
+}
+
+// 以前的写法: 先问类型, 再按类型取值
+static double sumByType(const Json &json)
+{
+    switch (json.type())
+    {
+    case JsonValueType::NUMBER:
+    case JsonValueType::INT64:
+    case JsonValueType::UINT64:
+        return json.getNumber();
+    case JsonValueType::STRING:
+        return static_cast<double>(json.getString().size());
+    case JsonValueType::ARRAY:
+    {
+        double sum = 0;
+        for (const Json &item : json.getArray())
+            sum += sumByType(item);
+        return sum;
+    }
+    case JsonValueType::OBJECT:
+    {
+        double sum = 0;
+        for (const auto &member : json.getObject())
+            sum += sumByType(member.second);
+        return sum;
+    }
+    default:
+        return 0;
+    }
+}
+
+struct SumVisitor
+{
+    double operator()(std::nullptr_t) const { return 0; }
+    double operator()(bool) const { return 0; }
+    double operator()(int64_t value) const { return static_cast<double>(value); }
+    double operator()(uint64_t value) const { return static_cast<double>(value); }
+    double operator()(double value) const { return value; }
+    double operator()(const jsonstring &value) const { return static_cast<double>(value.size()); }
+    double operator()(const array &items) const
+    {
+        double sum = 0;
+        for (const Json &item : items)
+            sum += myJson::visit(item, *this);
+        return sum;
+    }
+    double operator()(const object &members) const
+    {
+        double sum = 0;
+        for (const auto &member : members)
+            sum += myJson::visit(member.second, *this);
+        return sum;
+    }
+};
+
+static void scrubRecursive(Json &json)
+{
+    if (json.is_array())
+    {
+        for (auto iter = json.arrayBegin(); iter != json.arrayEnd(); ++iter)
+            scrubRecursive(*iter);
+    }
+    else if (json.is_object())
+    {
+        for (auto iter = json.objectBegin(); iter != json.objectEnd(); ++iter)
+        {
+            if (iter->first == "ssn" || iter->first == "pan")
+                iter->second = "***";
+            else
+                scrubRecursive(iter->second);
+        }
+    }
+}
+
+int main()
+{
+    const std::string text = makeDocument(100000);
+    Json doc = parse(text);
+    double sink = 0;
+    std::cout << "document bytes: " << text.size() << std::endl;
+
+    double byType = bestOf(5, [&]
+                           { sink += sumByType(doc); });
+    double visited = bestOf(5, [&]
+                            { sink += myJson::visit(doc, SumVisitor()); });
+    std::cout << "walk: type() + get*() " << byType * 1e3 << " ms, visit " << visited * 1e3 << " ms" << std::endl;
+
+    // 每轮重新parse一份, 只计改写的时间
+    auto scrubTime = [&](auto &&scrub)
+    {
+        double best = 1e300;
+        for (int i = 0; i < 5; i++)
+        {
+            Json copy = parse(text);
+            best = std::min(best, bestOf(1, [&]
+                                         { scrub(copy); }));
+            sink += copy.getArray().size();
+        }
+        return best;
+    };
+    double recursive = scrubTime([](Json &json)
+                                 { scrubRecursive(json); });
+    double transformed = scrubTime([](Json &json)
+                                   { transform(json, [](Json &value, const TransformSite &site)
+                                               {
+            if (site.key == "ssn" || site.key == "pan")
+            {
+                value = "***";
+                return TransformAction::SKIP;
+            }
+            return TransformAction::DESCEND; }); });
+    std::cout << "scrub: recursive iterators " << recursive * 1e3 << " ms, transform " << transformed * 1e3 << " ms" << std::endl;
+    std::cout << "(" << sink << ")" << std::endl;
+    return 0;
+}
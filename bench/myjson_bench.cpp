@@ -0,0 +1,352 @@
+//
+//  myjson_bench.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  parse/dump吞吐和每个文档的分配次数
+//
+//  用法: myjson_bench [--corpus DIR] [--json FILE] [--runs N] [--filter NAME]
+//  - DIR里有twitter.json/canada.json/citm_catalog.json就一起测, 没有就跳过
+//    (可以从simdjson或nativejson-benchmark的仓库拿)
+//  - 另外会生成shallow/deep/nested/wide/numbers/strings几个文档
+//  - --json把结果写成机器可读的json, 方便不同版本之间对比
+//
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "myJson.hpp"
+
+using namespace myJson;
+
+#ifndef MYJSON_CORPUS_DIR
+#define MYJSON_CORPUS_DIR "bench/data"
+#endif
+
+// 替换全局的operator new, 统计堆分配次数
+static std::atomic<size_t> g_allocations{0};
+
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, size ? size : alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+struct Document
+{
+    std::string name;
+    std::string text;
+};
+
+struct Result
+{
+    std::string name;
+    size_t bytes = 0;
+    double parseMBps = 0;
+    double dumpMBps = 0;
+    size_t dumpBytes = 0;
+    double allocsPerParse = 0;
+    double pooledAllocsPerParse = 0; // Parser预热之后每次parse的堆分配
+};
+
+///////////////生成的文档//////////////////////
+static std::string makeShallow()
+{
+    // 常见的API响应: 一层数组, 每个元素是只有标量成员的小对象
+    std::string out = "[";
+    for (size_t i = 0; i < 100000; i++)
+    {
+        if (i)
+            out += ",";
+        out += "{\"id\":" + std::to_string(i) + ",\"name\":\"user" + std::to_string(i) + "\",\"active\":true,\"score\":" + std::to_string(i % 100) + ".5}";
+    }
+    out += "]";
+    return out;
+}
+
+static std::string makeDeep()
+{
+    // 10层, 每层都是带几个成员的对象+数组, 扇出8
+    const size_t maxDepth = 10;
+    std::string out;
+    // 每层是对象+数组, 占两层深度
+    std::function<void(size_t)> build = [&](size_t depth)
+    {
+        if (depth + 2 > maxDepth)
+        {
+            out += "[1,2,3]";
+            return;
+        }
+        out += "{\"level\":" + std::to_string(depth) + ",\"name\":\"node\",\"children\":[";
+        for (int i = 0; i < 8; i++)
+        {
+            if (i)
+                out += ",";
+            build(depth + 2);
+        }
+        out += "]}";
+    };
+    build(1);
+    return out;
+}
+
+static std::string makeNested()
+{
+    // 一条很深的链, 不超过默认的MAXDEPTH
+    const size_t levels = MAXDEPTH / 2 - 1;
+    std::string out;
+    for (size_t i = 0; i < levels; i++)
+        out += "{\"k\":[";
+    out += "0";
+    for (size_t i = 0; i < levels; i++)
+        out += "]}";
+    return out;
+}
+
+static std::string makeWide()
+{
+    // 一个超大对象
+    std::string out = "{";
+    for (size_t i = 0; i < 200000; i++)
+    {
+        if (i)
+            out += ",";
+        out += "\"key_" + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    out += "}";
+    return out;
+}
+
+static std::string makeNumbers()
+{
+    // 整数, 小数, 指数混在一起
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    std::string out = "[";
+    char buf[64];
+    for (size_t i = 0; i < 500000; i++)
+    {
+        if (i)
+            out += ",";
+        switch (i % 3)
+        {
+        case 0:
+            out += std::to_string(rng() >> 1);
+            break;
+        case 1:
+            snprintf(buf, sizeof(buf), "%.17g", real(rng));
+            out += buf;
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%.6e", real(rng));
+            out += buf;
+            break;
+        }
+    }
+    out += "]";
+    return out;
+}
+
+static std::string makeStrings()
+{
+    std::mt19937 rng(2);
+    std::string out = "[";
+    for (size_t i = 0; i < 200000; i++)
+    {
+        if (i)
+            out += ",";
+        out += "\"";
+        size_t len = 4 + rng() % 60;
+        for (size_t j = 0; j < len; j++)
+        {
+            out += static_cast<char>('a' + rng() % 26);
+            if (rng() % 40 == 0)
+                out += "\\n";
+        }
+        out += "\"";
+    }
+    out += "]";
+    return out;
+}
+
+static bool readFile(const std::string &path, std::string &out)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+///////////////测量//////////////////////
+template <typename F>
+static double median(int runs, F &&f)
+{
+    std::vector<double> times;
+    for (int i = 0; i < runs; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(end - begin).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static Result measure(const Document &doc, int runs)
+{
+    Result result;
+    result.name = doc.name;
+    result.bytes = doc.text.size();
+    const double mb = 1024.0 * 1024.0;
+
+    Json json;
+    double parseSeconds = median(runs, [&]
+                                 { json = parse(doc.text); });
+    result.parseMBps = doc.text.size() / mb / parseSeconds;
+
+    std::string out;
+    double dumpSeconds = median(runs, [&]
+                                { out = json.dump(); });
+    result.dumpBytes = out.size();
+    result.dumpMBps = out.size() / mb / dumpSeconds;
+
+    size_t before = g_allocations.load();
+    {
+        Json once = parse(doc.text);
+    }
+    result.allocsPerParse = static_cast<double>(g_allocations.load() - before);
+
+    Parser parser;
+    {
+        Json warm = parser.parse(doc.text);
+    }
+    before = g_allocations.load();
+    for (int i = 0; i < runs; i++)
+    {
+        Json pooled = parser.parse(doc.text);
+    }
+    result.pooledAllocsPerParse = static_cast<double>(g_allocations.load() - before) / runs;
+    return result;
+}
+
+static void writeResults(const std::string &path, const std::vector<Result> &results)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "cannot write " << path << std::endl;
+        return;
+    }
+    // 名字都是自己生成的或者文件名, 不需要转义
+    file << "{\n  \"benchmark\": \"myjson_bench\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        file << "    {\"name\": \"" << r.name << "\", \"bytes\": " << r.bytes
+             << ", \"parse_mb_per_s\": " << r.parseMBps
+             << ", \"dump_mb_per_s\": " << r.dumpMBps
+             << ", \"dump_bytes\": " << r.dumpBytes
+             << ", \"allocs_per_parse\": " << r.allocsPerParse
+             << ", \"pooled_allocs_per_parse\": " << r.pooledAllocsPerParse << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+}
+
+int main(int argc, const char *argv[])
+{
+    std::string corpus = MYJSON_CORPUS_DIR;
+    if (const char *env = std::getenv("MYJSON_CORPUS"))
+        corpus = env;
+    std::string jsonPath;
+    std::string filter;
+    int runs = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--corpus" && i + 1 < argc)
+            corpus = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--runs" && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--corpus DIR] [--json FILE] [--runs N] [--filter NAME]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Document> docs;
+    for (const char *name : {"twitter.json", "canada.json", "citm_catalog.json"})
+    {
+        Document doc;
+        doc.name = name;
+        if (readFile(corpus + "/" + name, doc.text))
+            docs.push_back(std::move(doc));
+        else
+            std::cerr << "skip " << name << ": not found in " << corpus << std::endl;
+    }
+    docs.push_back({"generated/shallow", makeShallow()});
+    docs.push_back({"generated/deep", makeDeep()});
+    docs.push_back({"generated/nested", makeNested()});
+    docs.push_back({"generated/wide", makeWide()});
+    docs.push_back({"generated/numbers", makeNumbers()});
+    docs.push_back({"generated/strings", makeStrings()});
+
+    std::vector<Result> results;
+    printf("%-22s %12s %12s %12s %14s %14s\n", "document", "bytes", "parse MB/s", "dump MB/s", "allocs/parse", "pooled allocs");
+    for (const auto &doc : docs)
+    {
+        if (!filter.empty() && doc.name.find(filter) == std::string::npos)
+            continue;
+        Result r;
+        try
+        {
+            r = measure(doc, runs);
+        }
+        catch (const myJsonException &e)
+        {
+            std::cerr << doc.name << ": " << e.what() << std::endl;
+            continue;
+        }
+        printf("%-22s %12zu %12.1f %12.1f %14.0f %14.1f\n", r.name.c_str(), r.bytes, r.parseMBps, r.dumpMBps, r.allocsPerParse, r.pooledAllocsPerParse);
+        results.push_back(r);
+    }
+    if (!jsonPath.empty())
+        writeResults(jsonPath, results);
+    return 0;
+}
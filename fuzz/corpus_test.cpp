@@ -0,0 +1,75 @@
+//
+//  corpus_test.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  跑一遍JSONTestSuite格式的语料(文件名前缀 y_必须接受 n_必须拒绝 i_由实现决定)
+//
+//  - 先验参考解析器本身: y_都判ACCEPT, n_都不判ACCEPT, 保证拿来当标准的它是对的
+//  - parse()的结论要和文件名一致
+//  - 每个文件再走一遍fuzz_oracle的全部检查(各种解析方式, 往返)
+//
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "fuzz_oracle.hpp"
+
+int main(int argc, char **argv)
+{
+    using namespace myJson;
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "usage: %s <corpus dir>\n", argv[0]);
+        return 2;
+    }
+    std::vector<std::filesystem::path> files;
+    for (const auto &entry : std::filesystem::directory_iterator(argv[1]))
+    {
+        if (entry.is_regular_file())
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+
+    size_t failures = 0;
+    size_t counts[3] = {};
+    for (const auto &path : files)
+    {
+        std::string name = path.filename().string();
+        char expect = name[0];
+        if ((expect != 'y' && expect != 'n' && expect != 'i') || name[1] != '_')
+            continue;
+        std::ifstream file(path, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        fuzz::RefResult ref = fuzz::reference(text);
+        if ((expect == 'y' && ref.verdict != fuzz::Verdict::ACCEPT) || (expect == 'n' && ref.verdict == fuzz::Verdict::ACCEPT))
+        {
+            std::fprintf(stderr, "FAIL %s: reference parser disagrees\n", name.c_str());
+            failures++;
+            continue;
+        }
+        ParseError error;
+        parse(text, error);
+        bool accepted = !error;
+        if (expect == 'y' && !accepted)
+        {
+            std::fprintf(stderr, "FAIL %s: rejected, %s at offset %zu\n", name.c_str(), error.message(), error.offset);
+            failures++;
+        }
+        else if (expect == 'n' && accepted)
+        {
+            std::fprintf(stderr, "FAIL %s: accepted\n", name.c_str());
+            failures++;
+        }
+        // 分块大小随文件变, 1字节一块的情况也覆盖到
+        fuzz::checkAll(text, name.size() % 7 + 1);
+        counts[expect == 'y' ? 0 : expect == 'n' ? 1 : 2]++;
+    }
+    std::printf("corpus: %zu y_, %zu n_, %zu i_, %zu failures\n", counts[0], counts[1], counts[2], failures);
+    return failures == 0 && counts[0] + counts[1] > 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+//
+//  fuzz_driver.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  没有libFuzzer时(gcc, AFL)用的main: 参数是文件或目录, 每个文件跑一次LLVMFuzzerTestOneInput
+//  没有参数时从stdin读一个输入, 给afl-fuzz用: afl-fuzz -i fuzz/corpus -o out -- ./myjson_fuzz_modes
+//
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void runFile(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::string data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+        return 0;
+    }
+    size_t count = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(path))
+            {
+                if (entry.is_regular_file())
+                {
+                    runFile(entry.path());
+                    count++;
+                }
+            }
+        }
+        else
+        {
+            runFile(path);
+            count++;
+        }
+    }
+    std::printf("ran %zu inputs\n", count);
+    return 0;
+}
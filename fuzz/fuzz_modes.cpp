@@ -0,0 +1,22 @@
+//
+//  fuzz_modes.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  所有解析方式互相对比(包括扩展语法), 第一个字节决定StreamParser的分块大小, 剩下的是文档
+//
+#include "fuzz_oracle.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size == 0)
+        return 0;
+    size_t chunk = data[0] % 16 + 1;
+    std::string text(reinterpret_cast<const char *>(data) + 1, size - 1);
+    myJson::fuzz::RefResult ref = myJson::fuzz::reference(text);
+    myJson::fuzz::checkParse(text, ref);
+    myJson::fuzz::checkModes(text, ref, chunk);
+    myJson::fuzz::checkRelaxed(text, ref, chunk);
+    return 0;
+}
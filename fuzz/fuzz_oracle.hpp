@@ -0,0 +1,958 @@
+//
+//  fuzz_oracle.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  模糊测试和差分测试的判定
+//
+//  - RefParser是照着RFC 8259逐条写的参考解析器, 只求对不求快, 递归下降, 建的是和myJson无关的RefValue
+//  - 每种解析方式(parse / keepNumberText / 自带resource / SAX / StreamParser分块 / Parser池子 / _json字面量的解析器)
+//    接受与否都要和参考解析器一致, 接受时的值要完全一样: 整数按INT64/UINT64区分, double按位比较
+//  - parse出来的再用bind::writeAny写成json重新parse, 值要一样, 再写一遍要逐字节一样
+//    (dump()是旧格式, 不是合法的json, 不参与往返)
+//  - 参考解析器也按myJson的约定拒绝: 超出double范围的数字, 落单的代理, 嵌套超过maxDepth
+//  - 不检查UTF-8是否合法, 原样保留, 和myJson一致
+//  - 根值后面还有内容时判成TRAILING, 默认的严格模式必须拒绝
+//  - ParseOptions::relaxed()(不含allowTrailingContent)是严格语法的超集: 严格合法的文档结果不变,
+//    扩展语法的文档上parse/SAX/StreamParser接受与否和值都要一致
+//  - 不一致时把输入和原因打到stderr然后abort, libFuzzer/AFL都当成crash记下输入
+//
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "myJson.hpp"
+#include "myJsonBind.hpp"
+#if __cplusplus >= 202002L
+#include "myJsonLiteral.hpp"
+#endif
+
+namespace myJson
+{
+    namespace fuzz
+    {
+        struct RefValue
+        {
+            enum class Kind
+            {
+                NUL,
+                BOOL,
+                INT,
+                UINT,
+                DOUBLE,
+                STRING,
+                ARRAY,
+                OBJECT
+            };
+
+            Kind kind = Kind::NUL;
+            bool b = false;
+            int64_t i = 0;
+            uint64_t u = 0;
+            double d = 0;
+            std::string s;
+            std::vector<RefValue> items;
+            std::vector<std::pair<std::string, RefValue>> members; // 按key的字节序排好, 重复的key只留最后一个
+
+            // 对象结束时调用
+            void sortMembers()
+            {
+                std::stable_sort(members.begin(), members.end(), [](const auto &lhs, const auto &rhs)
+                                 { return lhs.first < rhs.first; });
+                size_t out = 0;
+                for (size_t i = 0; i < members.size(); i++)
+                {
+                    if (i + 1 < members.size() && members[i + 1].first == members[i].first)
+                        continue;
+                    if (out != i)
+                        members[out] = std::move(members[i]);
+                    out++;
+                }
+                members.resize(out);
+            }
+        };
+
+        enum class Verdict
+        {
+            ACCEPT,
+            REJECT,
+            TRAILING // 根值合法, 后面还有别的内容
+        };
+
+        struct RefResult
+        {
+            Verdict verdict = Verdict::REJECT;
+            RefValue value;
+            size_t depth = 0; // 解析过程中到过的最深的嵌套
+        };
+
+        class RefParser
+        {
+        public:
+            RefParser(std::string_view in, size_t maxDepth) : m_in(in), m_maxDepth(maxDepth) {}
+
+            RefResult run()
+            {
+                RefResult result;
+                skipWhiteSpace();
+                if (!value(result.value, 0))
+                {
+                    result.depth = m_depth;
+                    return result;
+                }
+                skipWhiteSpace();
+                result.verdict = m_pos == m_in.size() ? Verdict::ACCEPT : Verdict::TRAILING;
+                result.depth = m_depth;
+                return result;
+            }
+
+        private:
+            std::string_view m_in;
+            size_t m_maxDepth;
+            size_t m_pos = 0;
+            size_t m_depth = 0;
+
+            bool more() const { return m_pos < m_in.size(); }
+            char cur() const { return m_in[m_pos]; }
+            bool isDigit() const { return more() && cur() >= '0' && cur() <= '9'; }
+
+            // ws = *( %x20 / %x09 / %x0A / %x0D )
+            void skipWhiteSpace()
+            {
+                while (more() && (cur() == ' ' || cur() == '\t' || cur() == '\n' || cur() == '\r'))
+                    m_pos++;
+            }
+
+            bool literal(std::string_view word)
+            {
+                if (m_in.substr(m_pos, word.size()) != word)
+                    return false;
+                m_pos += word.size();
+                return true;
+            }
+
+            bool value(RefValue &out, size_t depth)
+            {
+                if (!more())
+                    return false;
+                switch (cur())
+                {
+                case 'n':
+                    out.kind = RefValue::Kind::NUL;
+                    return literal("null");
+                case 't':
+                    out.kind = RefValue::Kind::BOOL;
+                    out.b = true;
+                    return literal("true");
+                case 'f':
+                    out.kind = RefValue::Kind::BOOL;
+                    return literal("false");
+                case '\"':
+                    out.kind = RefValue::Kind::STRING;
+                    return string(out.s);
+                case '[':
+                    return array(out, depth + 1);
+                case '{':
+                    return object(out, depth + 1);
+                default:
+                    return number(out);
+                }
+            }
+
+            bool array(RefValue &out, size_t depth)
+            {
+                m_depth = std::max(m_depth, depth);
+                if (depth > m_maxDepth)
+                    return false;
+                out.kind = RefValue::Kind::ARRAY;
+                m_pos++;
+                skipWhiteSpace();
+                if (more() && cur() == ']')
+                {
+                    m_pos++;
+                    return true;
+                }
+                while (1)
+                {
+                    skipWhiteSpace();
+                    out.items.emplace_back();
+                    if (!value(out.items.back(), depth))
+                        return false;
+                    skipWhiteSpace();
+                    if (!more())
+                        return false;
+                    if (cur() == ']')
+                    {
+                        m_pos++;
+                        return true;
+                    }
+                    if (cur() != ',')
+                        return false;
+                    m_pos++;
+                }
+            }
+
+            bool object(RefValue &out, size_t depth)
+            {
+                m_depth = std::max(m_depth, depth);
+                if (depth > m_maxDepth)
+                    return false;
+                out.kind = RefValue::Kind::OBJECT;
+                m_pos++;
+                skipWhiteSpace();
+                if (more() && cur() == '}')
+                {
+                    m_pos++;
+                    return true;
+                }
+                while (1)
+                {
+                    skipWhiteSpace();
+                    if (!more() || cur() != '\"')
+                        return false;
+                    out.members.emplace_back();
+                    if (!string(out.members.back().first))
+                        return false;
+                    skipWhiteSpace();
+                    if (!more() || cur() != ':')
+                        return false;
+                    m_pos++;
+                    skipWhiteSpace();
+                    if (!value(out.members.back().second, depth))
+                        return false;
+                    skipWhiteSpace();
+                    if (!more())
+                        return false;
+                    if (cur() == '}')
+                    {
+                        m_pos++;
+                        out.sortMembers();
+                        return true;
+                    }
+                    if (cur() != ',')
+                        return false;
+                    m_pos++;
+                }
+            }
+
+            bool hex4(uint32_t &out)
+            {
+                if (m_in.size() - m_pos < 4)
+                    return false;
+                out = 0;
+                for (size_t i = 0; i < 4; i++)
+                {
+                    char c = m_in[m_pos++];
+                    uint32_t digit;
+                    if (c >= '0' && c <= '9')
+                        digit = static_cast<uint32_t>(c - '0');
+                    else if (c >= 'a' && c <= 'f')
+                        digit = static_cast<uint32_t>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F')
+                        digit = static_cast<uint32_t>(c - 'A' + 10);
+                    else
+                        return false;
+                    out = out * 16 + digit;
+                }
+                return true;
+            }
+
+            static void appendUtf8(std::string &out, uint32_t code)
+            {
+                if (code < 0x80)
+                {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            // string = quotation-mark *char quotation-mark, 控制字符必须转义
+            bool string(std::string &out)
+            {
+                m_pos++;
+                while (1)
+                {
+                    if (!more())
+                        return false;
+                    unsigned char c = static_cast<unsigned char>(cur());
+                    m_pos++;
+                    if (c == '\"')
+                        return true;
+                    if (c < 0x20)
+                        return false;
+                    if (c != '\\')
+                    {
+                        out += static_cast<char>(c);
+                        continue;
+                    }
+                    if (!more())
+                        return false;
+                    char escape = cur();
+                    m_pos++;
+                    switch (escape)
+                    {
+                    case '\"':
+                    case '\\':
+                    case '/':
+                        out += escape;
+                        break;
+                    case 'b':
+                        out += '\b';
+                        break;
+                    case 'f':
+                        out += '\f';
+                        break;
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 'r':
+                        out += '\r';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    case 'u':
+                    {
+                        uint32_t code;
+                        if (!hex4(code) || (code >= 0xDC00 && code <= 0xDFFF))
+                            return false;
+                        if (code >= 0xD800 && code <= 0xDBFF)
+                        {
+                            uint32_t low;
+                            if (!literal("\\u") || !hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                                return false;
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+            }
+
+            // number = [ minus ] int [ frac ] [ exp ], 数字按最长的匹配切, 01/1./1e这种直接算错
+            bool number(RefValue &out)
+            {
+                size_t begin = m_pos;
+                if (more() && cur() == '-')
+                    m_pos++;
+                if (!isDigit())
+                    return false;
+                if (cur() == '0')
+                {
+                    m_pos++;
+                    if (isDigit())
+                        return false;
+                }
+                while (isDigit())
+                    m_pos++;
+                bool integer = true;
+                if (more() && cur() == '.')
+                {
+                    integer = false;
+                    m_pos++;
+                    if (!isDigit())
+                        return false;
+                    while (isDigit())
+                        m_pos++;
+                }
+                if (more() && (cur() == 'e' || cur() == 'E'))
+                {
+                    integer = false;
+                    m_pos++;
+                    if (more() && (cur() == '+' || cur() == '-'))
+                        m_pos++;
+                    if (!isDigit())
+                        return false;
+                    while (isDigit())
+                        m_pos++;
+                }
+                std::string text(m_in.substr(begin, m_pos - begin));
+                const char *first = text.data();
+                const char *last = first + text.size();
+                if (integer)
+                {
+                    // 放得进int64的是INT, 正数放不进int64但放得进uint64的是UINT, 其余的当double
+                    auto result = std::from_chars(first, last, out.i);
+                    if (result.ec == std::errc() && result.ptr == last)
+                    {
+                        out.kind = RefValue::Kind::INT;
+                        return true;
+                    }
+                    if (text[0] != '-')
+                    {
+                        result = std::from_chars(first, last, out.u);
+                        if (result.ec == std::errc() && result.ptr == last)
+                        {
+                            out.kind = RefValue::Kind::UINT;
+                            return true;
+                        }
+                    }
+                }
+                out.kind = RefValue::Kind::DOUBLE;
+                auto result = std::from_chars(first, last, out.d);
+                if (result.ec == std::errc())
+                    return true;
+                // 溢出是错; 下溢到0在RFC 8259里是合法的数. from_chars两种都报result_out_of_range, 按量级分开
+                if (overflows(text))
+                    return false;
+                out.d = text[0] == '-' ? -0.0 : 0.0;
+                return true;
+            }
+
+            // 尾数的数字串里第一个非0数字到小数点的距离, 加上指数, 就是十进制量级
+            static bool overflows(const std::string &text)
+            {
+                size_t exp = text.find_first_of("eE");
+                std::string mantissa = text.substr(0, exp);
+                size_t point = mantissa.find('.');
+                std::string digits;
+                for (char c : mantissa)
+                {
+                    if (c >= '0' && c <= '9')
+                        digits += c;
+                }
+                size_t intDigits = point == std::string::npos ? digits.size() : point - (text[0] == '-');
+                long long magnitude = static_cast<long long>(intDigits) - static_cast<long long>(digits.find_first_not_of('0'));
+                if (exp != std::string::npos)
+                {
+                    long long exponent = 0;
+                    size_t i = exp + 1;
+                    bool negative = text[i] == '-';
+                    if (text[i] == '+' || text[i] == '-')
+                        i++;
+                    for (; i < text.size(); i++)
+                        exponent = std::min(exponent * 10 + (text[i] - '0'), 1000000000LL);
+                    magnitude += negative ? -exponent : exponent;
+                }
+                return magnitude > 0;
+            }
+        };
+
+        ///////////////比较//////////////////////
+        // 出问题时打印输入(不可见的字节转成\xNN, 太长的截断)和原因
+        [[noreturn]] inline void report(const std::string &text, const char *mode, const std::string &reason)
+        {
+            std::string shown;
+            for (size_t i = 0; i < text.size() && i < 512; i++)
+            {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                if (c >= 0x20 && c < 0x7F)
+                {
+                    shown += static_cast<char>(c);
+                }
+                else
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\x%02X", c);
+                    shown += buffer;
+                }
+            }
+            if (text.size() > 512)
+                shown += "...";
+            std::fprintf(stderr, "[fuzz] %s: %s\n  input (%zu bytes): %s\n", mode, reason.c_str(), text.size(), shown.c_str());
+            std::abort();
+        }
+
+        inline bool sameDouble(double lhs, double rhs)
+        {
+            return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+        }
+
+        // loose: 往返时1.0写成1会变成整数, 只比数值
+        inline bool sameNumber(const RefValue &ref, JsonValueType type, int64_t i, uint64_t u, double d, bool loose)
+        {
+            if (!loose)
+            {
+                switch (ref.kind)
+                {
+                case RefValue::Kind::INT:
+                    return type == JsonValueType::INT64 && i == ref.i;
+                case RefValue::Kind::UINT:
+                    return type == JsonValueType::UINT64 && u == ref.u;
+                default:
+                    return type == JsonValueType::NUMBER && sameDouble(d, ref.d);
+                }
+            }
+            if (ref.kind == RefValue::Kind::INT && type == JsonValueType::INT64)
+                return i == ref.i;
+            if (ref.kind == RefValue::Kind::UINT && type == JsonValueType::UINT64)
+                return u == ref.u;
+            double lhs = ref.kind == RefValue::Kind::INT ? static_cast<double>(ref.i) : ref.kind == RefValue::Kind::UINT ? static_cast<double>(ref.u)
+                                                                                                                          : ref.d;
+            double rhs = type == JsonValueType::INT64 ? static_cast<double>(i) : type == JsonValueType::UINT64 ? static_cast<double>(u)
+                                                                                                                 : d;
+            return lhs == rhs;
+        }
+
+        // 返回空串表示一样, 否则是第一处不同的路径
+        inline std::string diff(const RefValue &ref, const Json &json, bool loose, const std::string &path = "$")
+        {
+            switch (ref.kind)
+            {
+            case RefValue::Kind::NUL:
+                return json.is_null() ? "" : path + ": expected null";
+            case RefValue::Kind::BOOL:
+                return json.is_bool() && json.getBool() == ref.b ? "" : path + ": expected bool";
+            case RefValue::Kind::STRING:
+                return json.is_string() && std::string_view(json.getString().data(), json.getString().size()) == ref.s ? "" : path + ": expected string";
+            case RefValue::Kind::ARRAY:
+            {
+                if (!json.is_array() || json.getArray().size() != ref.items.size())
+                    return path + ": expected array of " + std::to_string(ref.items.size());
+                for (size_t k = 0; k < ref.items.size(); k++)
+                {
+                    std::string inner = diff(ref.items[k], json.getArray()[k], loose, path + "[" + std::to_string(k) + "]");
+                    if (!inner.empty())
+                        return inner;
+                }
+                return "";
+            }
+            case RefValue::Kind::OBJECT:
+            {
+                if (!json.is_object() || json.getObject().size() != ref.members.size())
+                    return path + ": expected object of " + std::to_string(ref.members.size());
+                auto iter = json.getObject().begin();
+                for (const auto &member : ref.members)
+                {
+                    if (std::string_view(iter->first.data(), iter->first.size()) != member.first)
+                        return path + ": key order differs";
+                    std::string inner = diff(member.second, iter->second, loose, path + "." + member.first);
+                    if (!inner.empty())
+                        return inner;
+                    ++iter;
+                }
+                return "";
+            }
+            default:
+            {
+                JsonValueType type = json.type();
+                if (!isNumberType(type))
+                    return path + ": expected number";
+                int64_t i = type == JsonValueType::INT64 ? json.getInt64() : 0;
+                uint64_t u = type == JsonValueType::UINT64 ? json.getUint64() : 0;
+                double d = type == JsonValueType::NUMBER ? json.getNumber() : 0;
+                return sameNumber(ref, type, i, u, d, loose) ? "" : path + ": number differs";
+            }
+            }
+        }
+
+        // RefValue之间, SAX和字面量的结果都先转成RefValue
+        inline bool sameValue(const RefValue &lhs, const RefValue &rhs)
+        {
+            if (lhs.kind != rhs.kind)
+                return false;
+            switch (lhs.kind)
+            {
+            case RefValue::Kind::NUL:
+                return true;
+            case RefValue::Kind::BOOL:
+                return lhs.b == rhs.b;
+            case RefValue::Kind::INT:
+                return lhs.i == rhs.i;
+            case RefValue::Kind::UINT:
+                return lhs.u == rhs.u;
+            case RefValue::Kind::DOUBLE:
+                return sameDouble(lhs.d, rhs.d);
+            case RefValue::Kind::STRING:
+                return lhs.s == rhs.s;
+            case RefValue::Kind::ARRAY:
+                return lhs.items.size() == rhs.items.size() && std::equal(lhs.items.begin(), lhs.items.end(), rhs.items.begin(), sameValue);
+            case RefValue::Kind::OBJECT:
+                return lhs.members.size() == rhs.members.size() && std::equal(lhs.members.begin(), lhs.members.end(), rhs.members.begin(), [](const auto &a, const auto &b)
+                                                                              { return a.first == b.first && sameValue(a.second, b.second); });
+            }
+            return false;
+        }
+
+        // SAX事件建成RefValue
+        class RefBuilder : public JsonHandler
+        {
+        public:
+            bool null() override { return add(RefValue()); }
+
+            bool boolean(bool value) override
+            {
+                RefValue ref;
+                ref.kind = RefValue::Kind::BOOL;
+                ref.b = value;
+                return add(std::move(ref));
+            }
+
+            bool integer(int64_t value) override
+            {
+                RefValue ref;
+                ref.kind = RefValue::Kind::INT;
+                ref.i = value;
+                return add(std::move(ref));
+            }
+
+            bool unsignedInteger(uint64_t value) override
+            {
+                RefValue ref;
+                ref.kind = RefValue::Kind::UINT;
+                ref.u = value;
+                return add(std::move(ref));
+            }
+
+            bool number(double value) override
+            {
+                RefValue ref;
+                ref.kind = RefValue::Kind::DOUBLE;
+                ref.d = value;
+                return add(std::move(ref));
+            }
+
+            bool string(std::string_view value) override
+            {
+                RefValue ref;
+                ref.kind = RefValue::Kind::STRING;
+                ref.s.assign(value.data(), value.size());
+                return add(std::move(ref));
+            }
+
+            bool startObject() override { return open(RefValue::Kind::OBJECT); }
+
+            bool key(std::string_view key) override
+            {
+                m_stack.back().members.emplace_back(std::string(key), RefValue());
+                return true;
+            }
+
+            bool endObject() override
+            {
+                m_stack.back().sortMembers();
+                return close();
+            }
+
+            bool startArray() override { return open(RefValue::Kind::ARRAY); }
+            bool endArray() override { return close(); }
+
+            const RefValue &root() const { return m_root; }
+
+        private:
+            std::vector<RefValue> m_stack;
+            RefValue m_root;
+
+            bool open(RefValue::Kind kind)
+            {
+                m_stack.emplace_back();
+                m_stack.back().kind = kind;
+                return true;
+            }
+
+            bool close()
+            {
+                RefValue value = std::move(m_stack.back());
+                m_stack.pop_back();
+                return add(std::move(value));
+            }
+
+            bool add(RefValue value)
+            {
+                if (m_stack.empty())
+                    m_root = std::move(value);
+                else if (m_stack.back().kind == RefValue::Kind::OBJECT)
+                    m_stack.back().members.back().second = std::move(value);
+                else
+                    m_stack.back().items.push_back(std::move(value));
+                return true;
+            }
+        };
+
+        ///////////////判定//////////////////////
+        // 一种解析方式的结果和参考解析器对一下
+        inline void expectVerdict(const std::string &text, const char *mode, const RefResult &ref, bool accepted)
+        {
+            if (ref.verdict == Verdict::ACCEPT && !accepted)
+                report(text, mode, "rejected a valid document");
+            if (ref.verdict != Verdict::ACCEPT && accepted)
+                report(text, mode, ref.verdict == Verdict::TRAILING ? "accepted trailing content" : "accepted an invalid document");
+        }
+
+        inline void expectSame(const std::string &text, const char *mode, const RefResult &ref, const Json &json, bool loose = false)
+        {
+            std::string where = diff(ref.value, json, loose);
+            if (!where.empty())
+                report(text, mode, where);
+        }
+
+        inline void expectSame(const std::string &text, const char *mode, const RefResult &ref, const RefValue &value)
+        {
+            if (!sameValue(ref.value, value))
+                report(text, mode, "value differs from reference");
+        }
+
+        // 流式解析: 按chunk字节一块喂进去
+        inline bool feedChunks(StreamParser &parser, const std::string &text, size_t chunk)
+        {
+            for (size_t pos = 0; pos < text.size(); pos += chunk)
+            {
+                if (!parser.feed(std::string_view(text).substr(pos, chunk)))
+                    return false;
+            }
+            return parser.finish();
+        }
+
+#if __cplusplus >= 202002L
+        inline RefValue fromLiteral(const std::vector<literal::LiteralNode> &nodes, size_t index)
+        {
+            const literal::LiteralNode &node = nodes[index];
+            RefValue ref;
+            switch (node.type)
+            {
+            case JsonValueType::BOOL:
+                ref.kind = RefValue::Kind::BOOL;
+                ref.b = node.payload != 0;
+                break;
+            case JsonValueType::INT64:
+                ref.kind = RefValue::Kind::INT;
+                ref.i = static_cast<int64_t>(node.payload);
+                break;
+            case JsonValueType::UINT64:
+                ref.kind = RefValue::Kind::UINT;
+                ref.u = node.payload;
+                break;
+            case JsonValueType::NUMBER:
+                ref.kind = RefValue::Kind::DOUBLE;
+                std::memcpy(&ref.d, &node.payload, sizeof(double));
+                break;
+            case JsonValueType::STRING:
+                ref.kind = RefValue::Kind::STRING;
+                ref.s = node.text;
+                break;
+            case JsonValueType::ARRAY:
+                ref.kind = RefValue::Kind::ARRAY;
+                for (size_t child : node.children)
+                    ref.items.push_back(fromLiteral(nodes, child));
+                break;
+            case JsonValueType::OBJECT:
+                ref.kind = RefValue::Kind::OBJECT;
+                for (size_t k = 0; k < node.children.size(); k++)
+                    ref.members.emplace_back(node.keys[k], fromLiteral(nodes, node.children[k]));
+                ref.sortMembers();
+                break;
+            default:
+                break;
+            }
+            return ref;
+        }
+#endif
+
+        // Json转成RefValue, 两棵Json之间比较时用(double按位比, NaN也能比)
+        inline RefValue toRef(const Json &json)
+        {
+            RefValue ref;
+            switch (json.type())
+            {
+            case JsonValueType::BOOL:
+                ref.kind = RefValue::Kind::BOOL;
+                ref.b = json.getBool();
+                break;
+            case JsonValueType::INT64:
+                ref.kind = RefValue::Kind::INT;
+                ref.i = json.getInt64();
+                break;
+            case JsonValueType::UINT64:
+                ref.kind = RefValue::Kind::UINT;
+                ref.u = json.getUint64();
+                break;
+            case JsonValueType::NUMBER:
+                ref.kind = RefValue::Kind::DOUBLE;
+                ref.d = json.getNumber();
+                break;
+            case JsonValueType::STRING:
+                ref.kind = RefValue::Kind::STRING;
+                ref.s.assign(json.getString().data(), json.getString().size());
+                break;
+            case JsonValueType::ARRAY:
+                ref.kind = RefValue::Kind::ARRAY;
+                for (const Json &item : json.getArray())
+                    ref.items.push_back(toRef(item));
+                break;
+            case JsonValueType::OBJECT:
+                ref.kind = RefValue::Kind::OBJECT;
+                for (const auto &member : json.getObject())
+                    ref.members.emplace_back(std::string(member.first.data(), member.first.size()), toRef(member.second));
+                break;
+            default:
+                break;
+            }
+            return ref;
+        }
+
+        inline RefResult reference(const std::string &text)
+        {
+            return RefParser(text, MAXDEPTH).run();
+        }
+
+        // parse()
+        inline void checkParse(const std::string &text, const RefResult &ref)
+        {
+            ParseError error;
+            Json json = parse(text, error);
+            expectVerdict(text, "parse", ref, !error);
+            if (!error)
+                expectSame(text, "parse", ref, json);
+        }
+
+        // parse -> writeAny -> parse, 再写一遍要和第一遍逐字节一样
+        inline void checkRoundTrip(const std::string &text, const RefResult &ref)
+        {
+            ParseError error;
+            Json json = parse(text, error);
+            if (error)
+                return;
+            std::string first;
+            bind::writeAny(first, json);
+            Json again = parse(first, error);
+            if (error)
+                report(text, "roundtrip", std::string("cannot parse writeAny output: ") + error.message() + " in " + first);
+            expectSame(text, "roundtrip", ref, again, true);
+            std::string second;
+            bind::writeAny(second, again);
+            if (first != second)
+                report(text, "roundtrip", "writeAny is not stable: " + first + " vs " + second);
+        }
+
+        // 其余的解析方式, chunk是StreamParser每块的字节数
+        inline void checkModes(const std::string &text, const RefResult &ref, size_t chunk)
+        {
+            ParseError error;
+            {
+                ParseOptions options;
+                options.keepNumberText = true;
+                Json json = parse(text, options, error);
+                expectVerdict(text, "keepNumberText", ref, !error);
+                if (!error)
+                    expectSame(text, "keepNumberText", ref, json);
+            }
+            {
+                std::pmr::monotonic_buffer_resource arena;
+                Json json = parse(text, ParseOptions(), &arena, error);
+                expectVerdict(text, "resource", ref, !error);
+                if (!error)
+                    expectSame(text, "resource", ref, json);
+            }
+            {
+                RefBuilder builder;
+                bool accepted = parse(text, builder, error);
+                expectVerdict(text, "sax", ref, accepted);
+                if (accepted)
+                    expectSame(text, "sax", ref, builder.root());
+            }
+            {
+                StreamParser parser;
+                bool accepted = feedChunks(parser, text, chunk);
+                expectVerdict(text, "stream", ref, accepted);
+                if (accepted)
+                    expectSame(text, "stream", ref, parser.release());
+            }
+            {
+                RefBuilder builder;
+                StreamParser parser(builder);
+                bool accepted = feedChunks(parser, text, chunk * 3 + 1);
+                expectVerdict(text, "stream sax", ref, accepted);
+                if (accepted)
+                    expectSame(text, "stream sax", ref, builder.root());
+            }
+            {
+                // 池子跨输入复用, 顺带测空闲链表
+                static Parser pool;
+                Json json = pool.parse(text, error);
+                expectVerdict(text, "Parser", ref, !error);
+                if (!error)
+                    expectSame(text, "Parser", ref, json);
+            }
+#if __cplusplus >= 202002L
+            // 字面量的解析器运行期一样能调, 嵌套的上限更小, 根值后面不许有内容
+            if (ref.depth <= literal::MAX_LITERAL_DEPTH)
+            {
+                bool accepted = true;
+                RefValue value;
+                try
+                {
+                    literal::LiteralParser parser(text);
+                    size_t root = parser.parse();
+                    value = fromLiteral(parser.nodes(), root);
+                }
+                catch (const myJsonException &)
+                {
+                    accepted = false;
+                }
+                expectVerdict(text, "literal", ref, accepted);
+                if (accepted)
+                    expectSame(text, "literal", ref, value);
+            }
+#endif
+        }
+
+        // 扩展语法: 严格合法的文档结果不变, 其余的文档上各种解析方式互相一致
+        inline void checkRelaxed(const std::string &text, const RefResult &ref, size_t chunk)
+        {
+            ParseOptions options = ParseOptions::relaxed();
+            options.allowTrailingContent = false; // 根值后面的垃圾和数字粘在一起时, 按字符解析和按token解析切的地方不一样
+            ParseError error;
+            Json json = parse(text, options, error);
+            bool accepted = !error;
+            if (ref.verdict == Verdict::ACCEPT)
+            {
+                if (!accepted)
+                    report(text, "relaxed", std::string("rejected a valid document: ") + error.message());
+                expectSame(text, "relaxed", ref, json);
+            }
+            RefValue value = accepted ? toRef(json) : RefValue();
+            {
+                RefBuilder builder;
+                if (parse(text, options, builder, error) != accepted)
+                    report(text, "relaxed sax", accepted ? "rejected what parse accepted" : "accepted what parse rejected");
+                if (accepted && !sameValue(value, builder.root()))
+                    report(text, "relaxed sax", "value differs from parse");
+            }
+            {
+                StreamParser parser(options);
+                if (feedChunks(parser, text, chunk) != accepted)
+                    report(text, "relaxed stream", accepted ? "rejected what parse accepted" : "accepted what parse rejected");
+                if (accepted && !sameValue(value, toRef(parser.release())))
+                    report(text, "relaxed stream", "value differs from parse");
+            }
+        }
+
+        inline void checkAll(const std::string &text, size_t chunk)
+        {
+            RefResult ref = reference(text);
+            checkParse(text, ref);
+            checkRoundTrip(text, ref);
+            checkModes(text, ref, chunk);
+            checkRelaxed(text, ref, chunk);
+        }
+    }
+}
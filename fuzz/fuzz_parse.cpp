@@ -0,0 +1,16 @@
+//
+//  fuzz_parse.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  parse()和参考解析器对比: 接受与否, 接受时的值
+//
+#include "fuzz_oracle.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string text(reinterpret_cast<const char *>(data), size);
+    myJson::fuzz::checkParse(text, myJson::fuzz::reference(text));
+    return 0;
+}
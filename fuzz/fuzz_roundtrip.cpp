@@ -0,0 +1,16 @@
+//
+//  fuzz_roundtrip.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  parse -> writeAny -> parse 往返, 值不变, 写出来的文本稳定
+//
+#include "fuzz_oracle.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string text(reinterpret_cast<const char *>(data), size);
+    myJson::fuzz::checkRoundTrip(text, myJson::fuzz::reference(text));
+    return 0;
+}
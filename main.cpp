@@ -5,12 +5,40 @@
 //  Created by garyxuan on 2024/7/16.
 //
 
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <unordered_set>
+#include <memory_resource>
 #include "myJson.hpp"
+#include "myJsonSnapshot.hpp"
+#include "myJsonPatch.hpp"
+#include "myJsonBind.hpp"
+#include "myJsonSchema.hpp"
+#include "myJsonAsync.hpp"
+#include "myJsonParallel.hpp"
+#include "myJsonLiteral.hpp"
+#include "myJsonTemplate.hpp"
+#include "myJsonColumns.hpp"
+#include "myJsonEdit.hpp"
+#include "myJsonVisit.hpp"
+#include "myJsonCanonical.hpp"
 
 using namespace std;
 using namespace myJson;
 
+// 检查失败只记下来, 最后main返回非0, 不受NDEBUG影响
+static int g_failures = 0;
+#define EXPECT(cond)                                                             \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond))                                                             \
+        {                                                                        \
+            g_failures++;                                                        \
+            cerr << __FILE__ << ":" << __LINE__ << ": EXPECT(" #cond ") failed" << endl; \
+        }                                                                        \
+    } while (0)
+
 void TestSetObject()
 {
     myJson::object test = {};
@@ -120,13 +148,1562 @@ void TestLiteral()
     //TestparseLiteral("\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"");
 }
 
+void TestSnapshot()
+{
+    Json j = parse("{ \"name\":\"myJson\" , \"ok\": true , \"tags\":[ \"name\" , null , 1.5 ] , \"nested\" :{ \"k\":\"v\" }}");
+    std::string bytes = dumpSnapshot(j);
+
+    Snapshot snap(bytes.data(), bytes.size());
+    SnapshotValue root = snap.root();
+    EXPECT(root.is_object() && root.size() == 4);
+    EXPECT(root["name"].getString() == "myJson");
+    EXPECT(root["ok"].getBool());
+    EXPECT(root["tags"].size() == 3);
+    EXPECT(root["tags"][0].getString() == "name");
+    EXPECT(root["tags"][1].is_null());
+    EXPECT(root["tags"][2].getNumber() == 1.5);
+    EXPECT(root["nested"]["k"].getString() == "v");
+    EXPECT(!root.contains("missing"));
+    EXPECT(root.toJson() == j);
+
+    for (auto iter = root.objectBegin(); iter != root.objectEnd(); ++iter)
+    {
+        cout << "snapshot key :" << iter->first << endl;
+    }
+
+    std::string path = "/tmp/myjson_snapshot_test.bin";
+    writeSnapshot(j, path);
+    Snapshot mapped = Snapshot::open(path);
+    EXPECT(mapped.root().toJson() == j);
+}
+
+void TestNumberTypes()
+{
+    Json j = parse("[9007199254740993, -9223372036854775808, 18446744073709551615, 1.5, 12, 123456789012345678901234567890]");
+    EXPECT(j[0].type() == JsonValueType::INT64 && j[0].getInt64() == 9007199254740993LL);
+    EXPECT(j[1].getInt64() == INT64_MIN);
+    EXPECT(j[2].type() == JsonValueType::UINT64 && j[2].getUint64() == UINT64_MAX);
+    EXPECT(j[3].type() == JsonValueType::NUMBER && j[3].is_number() && !j[3].is_integer());
+    EXPECT(j[5].type() == JsonValueType::NUMBER); // 超出uint64退回double
+    EXPECT(j[4] == Json(12.0) && Json(12) < Json(12.5) && Json(-1) < Json(0u));
+    EXPECT(j.dump() == "[9007199254740993, -9223372036854775808, 18446744073709551615, 1.500000, 12, 123456789012345677877719597056.000000]");
+
+    ParseOptions options;
+    options.keepNumberText = true;
+    Json raw = parse("[123456789012345678901234567890, 0.1000000000000000055511151231257827, 7]", options);
+    EXPECT(raw.dump() == "[123456789012345678901234567890, 0.1000000000000000055511151231257827, 7]");
+    EXPECT(raw[2].getInt64() == 7 && raw[2] == Json(7));
+    // 改过的数字用最短能还原的文本, 不丢精度
+    raw[1].setNumber(1e-7);
+    raw[2].setNumber(8);
+    EXPECT(raw.dump() == "[123456789012345678901234567890, 1e-07, 8]");
+    EXPECT(raw[1].getNumber() == 1e-7 && raw[2] == Json(8));
+
+    std::string bytes = dumpSnapshot(j);
+    Snapshot snap(bytes.data(), bytes.size());
+    EXPECT(snap.root()[0].getInt64() == 9007199254740993LL);
+    EXPECT(snap.root().toJson() == j);
+}
+
+// 统计分配次数的memory_resource
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t bytesInUse = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        bytesInUse += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        bytesInUse -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+void TestAllocator()
+{
+    CountingResource counter;
+    {
+        Json j = parse("{ \"a\": [1, 2.5, \"a fairly long string value\", null], \"b\": {\"c\": true}, \"d\": []}", &counter);
+        EXPECT(j.resource() == &counter && j["a"].resource() == &counter);
+        EXPECT(j["a"].getArray().get_allocator().resource() == &counter);
+        EXPECT(counter.allocations > 0);
+
+        // 拷贝到默认resource上, 和原来的resource无关
+        Json copy = j;
+        EXPECT(copy == j && copy.resource() == std::pmr::get_default_resource());
+        EXPECT(copy["a"].resource() == std::pmr::get_default_resource());
+
+        // 新加进来的值拷贝到容器自己的resource上
+        size_t before = counter.allocations;
+        j.addToObject("e", copy["b"]);
+        j["a"].addToArray("appended");
+        EXPECT(j["e"].resource() == &counter && j["a"][4].resource() == &counter);
+        EXPECT(counter.allocations > before);
+
+        Json moved(std::move(copy), Json::allocator_type(&counter));
+        EXPECT(moved.resource() == &counter && moved["b"]["c"].getBool());
+    }
+    EXPECT(counter.bytesInUse == 0);
+}
+
+void TestParserPool()
+{
+    const std::string doc = "{ \"id\": 42, \"name\": \"a name long enough to leave the SSO buffer\", \"tags\": [\"x\", \"y\", \"z\", 1, 2, 3, 4, 5, 6, 7, 8], \"meta\": {\"ok\": true, \"score\": 1.5}}";
+    Parser parser;
+    {
+        Json first = parser.parse(doc); // 预热
+        EXPECT(first["tags"].getArray().size() == 11);
+    }
+    size_t warm = parser.counters().upstreamAllocations;
+    EXPECT(warm > 0 && parser.counters().bytesInUse == 0);
+    for (int i = 0; i < 100; i++)
+    {
+        Json j = parser.parse(doc);
+        EXPECT(j["meta"]["score"].getNumber() == 1.5);
+    }
+    // 预热之后不再向堆要内存
+    EXPECT(parser.counters().upstreamAllocations == warm);
+    EXPECT(parser.counters().parses == 101 && parser.counters().allocations > 100);
+    cout << "parser pool: " << parser.counters().allocations << " pool allocations, "
+         << parser.counters().upstreamAllocations << " upstream allocations" << endl;
+}
+
+void TestParseError()
+{
+    ParseError error;
+    Json j = parse("{\"users\": [{\"name\": \"a\"},\n {\"name\": tru}]}", error);
+    EXPECT(error && error.code == ParseErrorCode::INVALID_LITERAL && j.is_null());
+    EXPECT(error.line == 2 && error.column == 11 && error.offset == 36);
+    EXPECT(std::string(error.path) == "$.users[1].name");
+
+    parse("[1, 2", error);
+    EXPECT(error.code == ParseErrorCode::UNEXPECTED_END && error.offset == 5 && std::string(error.path) == "$[1]");
+    parse("{\"a\" 1}", error);
+    EXPECT(error.code == ParseErrorCode::EXPECTED_COLON && std::string(error.path) == "$");
+    parse("[1 2]", error);
+    EXPECT(error.code == ParseErrorCode::EXPECTED_ARRAY_END);
+
+    // 路径太长时截断
+    std::string longKey(200, 'k');
+    parse("{\"" + longKey + "\": x}", error);
+    EXPECT(error.code == ParseErrorCode::INVALID_NUMBER);
+    std::string path = error.path;
+    EXPECT(path.size() == ParseError::PATH_CAPACITY - 1 && path.compare(path.size() - 3, 3, "...") == 0);
+
+    // 成功时清掉上一次的错误
+    j = parse("[true]", error);
+    EXPECT(!error && j[0].getBool());
+
+    // 抛异常的版本带上位置
+    try
+    {
+        parse("[1, nul]");
+        EXPECT(false);
+    }
+    catch (const myJsonException &e)
+    {
+        EXPECT(e.getPosition() == 4 && std::string(e.what()).find("$[1]") != std::string::npos);
+    }
+}
+
+void TestDepth()
+{
+    // 合作方的12层文档
+    std::string twelve = std::string(12, '[') + "1" + std::string(12, ']');
+    EXPECT(parse(twelve).dump().size() > 0);
+
+    // 显式栈, 几千层也不会爆栈
+    ParseOptions options;
+    options.maxDepth = 5000;
+    std::string deep;
+    for (int i = 0; i < 2000; i++)
+        deep += "{\"a\":[";
+    deep += "null";
+    for (int i = 0; i < 2000; i++)
+        deep += "]}";
+    ParseError error;
+    Json j = parse(deep, options, error);
+    EXPECT(!error && j.is_object() && j["a"][0]["a"].is_array());
+
+    // 超过限制就报错
+    options.maxDepth = 100;
+    parse(deep, options, error);
+    EXPECT(error.code == ParseErrorCode::DEPTH_EXCEEDED && error.offset == 300);
+    parse(deep, error);
+    EXPECT(error.code == ParseErrorCode::DEPTH_EXCEEDED);
+}
+
+void TestLimits()
+{
+    ParseError error;
+    ParseOptions options;
+    options.maxInputBytes = 8;
+    parse("[1, 2, 3, 4]", options, error);
+    EXPECT(error.code == ParseErrorCode::INPUT_TOO_LARGE && error.offset == 8);
+
+    // 一大串null, 到第maxNodes+1个节点就停下, 不会把剩下的都解析完
+    std::string nulls = "[";
+    for (int i = 0; i < 100000; i++)
+        nulls += i ? ",null" : "null";
+    nulls += "]";
+    options = ParseOptions();
+    options.maxNodes = 1000;
+    parse(nulls, options, error);
+    EXPECT(error.code == ParseErrorCode::TOO_MANY_NODES && std::string(error.path) == "$[999]");
+    EXPECT(error.offset == 1 + 999 * 5);
+
+    options = ParseOptions();
+    options.maxStringLength = 4;
+    EXPECT(parse("[\"abcd\"]", options, error).getArray().size() == 1 && !error);
+    parse("[\"abcd\", \"abcdefghijk\"]", options, error);
+    EXPECT(error.code == ParseErrorCode::STRING_TOO_LONG && error.offset == 15);
+    parse("{\"abcdef\": 1}", options, error);
+    EXPECT(error.code == ParseErrorCode::STRING_TOO_LONG);
+
+    options = ParseOptions();
+    options.maxObjectMembers = 2;
+    EXPECT(parse("{\"a\": 1, \"b\": 2}", options, error).getObject().size() == 2 && !error);
+    parse("{\"a\": 1, \"b\": 2, \"c\": 3}", options, error);
+    EXPECT(error.code == ParseErrorCode::TOO_MANY_MEMBERS && std::string(error.path) == "$");
+
+    options = ParseOptions();
+    options.memoryBudget = 4096;
+    parse(nulls, options, error);
+    EXPECT(error.code == ParseErrorCode::MEMORY_BUDGET_EXCEEDED && error.offset < 1000);
+
+    // 抛异常的版本带位置
+    try
+    {
+        options = ParseOptions();
+        options.maxNodes = 3;
+        parse("[1, 2, 3]", options);
+        EXPECT(false);
+    }
+    catch (const myJsonException &e)
+    {
+        EXPECT(e.getPosition() == 7);
+    }
+}
+
+void TestPatch()
+{
+    Json from = parse("{\"name\": \"node-1\", \"tags\": [\"a\", \"b\", \"c\", \"d\"], \"limits\": {\"cpu\": 2, \"mem\": 4}, \"old\": true, \"a/b\": 1}");
+    Json to = parse("{\"name\": \"node-1\", \"tags\": [\"a\", \"x\", \"d\", \"e\"], \"limits\": {\"cpu\": 4, \"mem\": 4}, \"new\": [1], \"a/b\": 1}");
+    Json patch = diff(from, to);
+    // 没变的name/mem/a~1b不出现在patch里
+    EXPECT(patch.dump().find("name") == std::string::npos && patch.dump().find("mem") == std::string::npos);
+    Json patched = from;
+    applyPatch(patched, patch);
+    EXPECT(patched == to);
+    EXPECT(diff(to, to).getArray().empty());
+
+    // 整个替换和类型变化
+    Json scalar = 1;
+    applyPatch(scalar, diff(scalar, to));
+    EXPECT(scalar == to);
+
+    // JSON Pointer
+    EXPECT(findPointer(to, "/a~1b") && findPointer(to, "/a~1b")->getInt64() == 1);
+    EXPECT(findPointer(to, "/tags/3")->getString() == "e" && !findPointer(to, "/tags/4") && !findPointer(to, "/tags/01"));
+    EXPECT(findPointer(to, "") == &to && escapePointerToken("a/~b") == "a~1~0b");
+
+    // RFC 6902的其他op
+    Json doc = parse("{\"a\": {\"b\": [1, 2]}, \"c\": 3}");
+    Json ops = parse("[{\"op\": \"test\", \"path\": \"/c\", \"value\": 3},"
+                     " {\"op\": \"copy\", \"from\": \"/a/b\", \"path\": \"/d\"},"
+                     " {\"op\": \"move\", \"from\": \"/c\", \"path\": \"/a/b/0\"},"
+                     " {\"op\": \"add\", \"path\": \"/d/-\", \"value\": 9}]");
+    applyPatch(doc, ops);
+    Json expected = parse("{\"a\": {\"b\": [3, 1, 2]}, \"d\": [1, 2, 9]}");
+    EXPECT(doc == expected);
+    try
+    {
+        applyPatch(doc, parse("[{\"op\": \"test\", \"path\": \"/d/0\", \"value\": 1}, {\"op\": \"remove\", \"path\": \"/nope\"}]"));
+        EXPECT(false);
+    }
+    catch (const myJsonException &e)
+    {
+        EXPECT(e.getPosition() == 1);
+    }
+
+    // RFC 7386
+    Json target = parse("{\"a\": \"b\", \"c\": {\"d\": \"e\", \"f\": \"g\"}}");
+    mergePatch(target, parse("{\"a\": \"z\", \"c\": {\"f\": null}, \"n\": {\"x\": null, \"y\": 1}}"));
+    EXPECT(target == parse("{\"a\": \"z\", \"c\": {\"d\": \"e\"}, \"n\": {\"y\": 1}}"));
+    mergePatch(target, parse("[1]"));
+    EXPECT(target.is_array());
+}
+
+void TestHash()
+{
+    Json a = parse("{\"id\": 1, \"tags\": [\"x\", \"y\"], \"score\": 2.5}");
+    Json b = parse("{\"score\": 2.5, \"tags\": [\"x\", \"y\"], \"id\": 1.0}");
+    EXPECT(a == b && a.hash() == b.hash());
+    // 跨类型相等的数字hash一样
+    EXPECT(Json(1).hash() == Json(1.0).hash() && Json(uint64_t(7)).hash() == Json(int64_t(7)).hash());
+    EXPECT(Json(-1).hash() != Json(uint64_t(-1)).hash() && Json(0.5).hash() != Json(0).hash());
+    EXPECT(Json("1").hash() != Json(1).hash() && Json(true).hash() != Json(1).hash());
+
+    // 修改之后缓存失效
+    uint64_t before = a.hash();
+    a["tags"][1] = "z";
+    EXPECT(a.hash() != before && a != b);
+    a["tags"][1] = "y";
+    EXPECT(a.hash() == before && a == b);
+    a["tags"].addToArray(3);
+    EXPECT(a.hash() != before);
+
+    // 拿着子节点的引用跨过hash()再改, 父节点的缓存也要作废
+    Json outer = parse("[[1], true]");
+    Json other = parse("[[2], false]");
+    Json &inner = outer[0];
+    Json &flag = outer[1];
+    outer.hash();
+    other.hash();
+    inner[0].setNumber(2);
+    flag.setBool(false);
+    EXPECT(outer == other && outer.hash() == other.hash());
+    Json &first = other[0];
+    outer.hash();
+    first = parse("[]");
+    EXPECT(outer != other && outer.hash() != other.hash());
+    // 迭代器和transform交出的引用也一样
+    Json viaIter = parse("[[1], 2]");
+    auto iter = viaIter.arrayBegin();
+    uint64_t beforeIter = viaIter.hash();
+    (*iter)[0].setNumber(5);
+    EXPECT(viaIter.hash() != beforeIter && viaIter == parse("[[5], 2]"));
+    Json transformed = parse("{\"a\": {\"b\": 1}}");
+    Json *stashed = nullptr;
+    transform(transformed, [&stashed](Json &value, const TransformSite &site)
+    {
+        if (site.key == "b")
+            stashed = &value;
+        return TransformAction::DESCEND;
+    });
+    uint64_t beforeTransform = transformed.hash();
+    stashed->setNumber(2);
+    EXPECT(transformed.hash() != beforeTransform && transformed.hash() == parse("{\"a\": {\"b\": 2}}").hash());
+    // 没交出过引用的子树照常缓存, 拷贝出来的树也是
+    Json copy = viaIter;
+    EXPECT(copy.hash() == viaIter.hash() && copy == viaIter);
+
+    // 不同进程里也一样, 可以存下来当key
+    EXPECT(parse("{\"a\": [1, \"b\", null, true]}").hash() == 0x707ae30dc5886128ULL);
+
+    std::unordered_set<Json> seen;
+    seen.insert(parse("[1, 2, 3]"));
+    seen.insert(parse("[1.0, 2, 3]"));
+    seen.insert(parse("[3, 2, 1]"));
+    EXPECT(seen.size() == 2 && seen.count(parse("[3, 2, 1]")) == 1);
+}
+
+struct BindAddress
+{
+    std::string city;
+    uint16_t zip = 0;
+};
+MYJSON_DEFINE(BindAddress, city, zip)
+
+struct BindUser
+{
+    int64_t id = 0;
+    std::string name;
+    double score = 0;
+    bool active = false;
+    std::vector<std::string> tags;
+    std::optional<BindAddress> address;
+    std::map<std::string, int> counters;
+    Json extra;
+};
+MYJSON_DEFINE(BindUser, id, name, score, active, tags, address, counters, extra)
+
+void TestBind()
+{
+    // 编译期就能查字段
+    static_assert(BindUser_myJsonFields::table.find("counters") == 6, "perfect hash");
+    static_assert(BindUser_myJsonFields::table.find("count") == -1, "perfect hash");
+
+    std::string text = "{\"unknown\": {\"x\": [1, \"]\", {}]}, \"id\": 42, \"name\": \"a\\\"b\\n\", \"score\": 2.5,"
+                       " \"active\": true, \"tags\": [\"x\", \"y\"], \"address\": {\"city\": \"SZ\", \"zip\": 518000},"
+                       " \"counters\": {\"a\": 1}, \"extra\": {\"k\": [null, 1.5]}}";
+    try
+    {
+        readJson<BindUser>(text);
+        EXPECT(false); // zip超出uint16_t
+    }
+    catch (const myJsonException &e)
+    {
+        EXPECT(string(e.what()).find("out of range") != string::npos);
+    }
+
+    text.replace(text.find("518000"), 6, "51800");
+    BindUser user = readJson<BindUser>(text);
+    EXPECT(user.id == 42 && user.name == "a\"b\n" && user.score == 2.5 && user.active);
+    EXPECT(user.tags.size() == 2 && user.tags[1] == "y");
+    EXPECT(user.address && user.address->city == "SZ" && user.address->zip == 51800);
+    EXPECT(user.counters.at("a") == 1);
+    EXPECT(user.extra["k"][1].getNumber() == 1.5);
+
+    // 写出来的是合法json, 再读回来一样
+    std::string out = writeJson(user);
+    EXPECT(out == "{\"id\":42,\"name\":\"a\\\"b\\n\",\"score\":2.5,\"active\":true,\"tags\":[\"x\",\"y\"],"
+                  "\"address\":{\"city\":\"SZ\",\"zip\":51800},\"counters\":{\"a\":1},\"extra\":{\"k\":[null,1.5]}}");
+    BindUser again = readJson<BindUser>(out);
+    EXPECT(writeJson(again) == out);
+    EXPECT(parse(out)["address"]["zip"].getInt64() == 51800);
+
+    // 缺少的字段保持原值, null清空optional
+    readJson("{\"name\": \"b\", \"address\": null}", again);
+    EXPECT(again.id == 42 && again.name == "b" && !again.address);
+
+    for (const char *bad : {"{\"id\": 1.5}", "{\"id\": \"1\"}", "{\"tags\": [\"x\",]}", "{\"id\": 1} x", "{\"id\": 1"})
+    {
+        try
+        {
+            readJson<BindUser>(bad);
+            EXPECT(false);
+        }
+        catch (const myJsonException &)
+        {
+        }
+    }
+}
+
+// 把事件记成一行文本
+class RecordingHandler : public JsonHandler
+{
+public:
+    std::string events;
+    size_t stopAfter = SIZE_MAX;
+
+    bool null() override { return add("n"); }
+    bool boolean(bool value) override { return add(value ? "t" : "f"); }
+    bool integer(int64_t value) override { return add("i" + to_string(value)); }
+    bool unsignedInteger(uint64_t value) override { return add("u" + to_string(value)); }
+    bool number(double value) override { return add("d" + to_string(value)); }
+    bool string(std::string_view value) override { return add("s" + std::string(value)); }
+    bool startObject() override { return add("{"); }
+    bool key(std::string_view key) override { return add("k" + std::string(key)); }
+    bool endObject() override { return add("}"); }
+    bool startArray() override { return add("["); }
+    bool endArray() override { return add("]"); }
+
+private:
+    bool add(const std::string &event)
+    {
+        events += event + " ";
+        return --stopAfter > 0;
+    }
+};
+
+void TestSax()
+{
+    RecordingHandler handler;
+    ParseError error;
+    EXPECT(parse("{\"a\": [1, -2, 18446744073709551615, 0.5, \"x\\n\"], \"b\": {}, \"c\": [null, true, false]}", handler, error));
+    EXPECT(handler.events == "{ ka [ i1 i-2 u18446744073709551615 d0.500000 sx\n ] kb { } kc [ n t f ] } ");
+
+    // 错误和DOM解析一样带路径
+    RecordingHandler broken;
+    EXPECT(!parse("{\"a\": [1, 2 3]}", broken, error));
+    EXPECT(error.code == ParseErrorCode::EXPECTED_ARRAY_END && string(error.path) == "$.a[1]");
+
+    // 回调返回false就停下
+    RecordingHandler stopping;
+    stopping.stopAfter = 3;
+    EXPECT(!parse("[1, 2, 3, 4]", stopping, error));
+    EXPECT(error.code == ParseErrorCode::HANDLER_ABORTED && stopping.events == "[ i1 i2 ");
+
+    ParseOptions options;
+    options.maxDepth = 2;
+    RecordingHandler deep;
+    EXPECT(!parse("[[[1]]]", options, deep, error) && error.code == ParseErrorCode::DEPTH_EXCEEDED);
+    options = ParseOptions();
+    options.maxObjectMembers = 2;
+    EXPECT(!parse("{\"a\": 1, \"b\": 2, \"c\": 3}", options, deep, error) && error.code == ParseErrorCode::TOO_MANY_MEMBERS);
+}
+
+void TestSchema()
+{
+    Schema schema = Schema::compile(parse(R"({
+        "type": "object",
+        "required": ["id", "name"],
+        "properties": {
+            "id": {"type": "integer", "minimum": 1},
+            "name": {"type": "string", "minLength": 2, "maxLength": 8, "pattern": "^[a-z]+$"},
+            "role": {"enum": ["admin", "user", {"custom": [1, 2]}]},
+            "score": {"type": "number", "exclusiveMaximum": 100},
+            "tags": {"type": "array", "items": {"type": "string"}, "maxItems": 2},
+            "meta": {"type": "object", "additionalProperties": false, "properties": {"v": {"const": 1}}}
+        }
+    })"));
+
+    std::string good = R"({"id": 7, "name": "gary", "role": {"custom": [1, 2.0]}, "score": 99.5, "tags": ["a"], "meta": {"v": 1.0}})";
+    std::vector<SchemaError> errors;
+    EXPECT(schema.validate(parse(good), &errors) && errors.empty());
+    ParseError parseError;
+    EXPECT(schema.validate(good, &errors, parseError) && errors.empty());
+
+    // DOM和SAX两条路报的错误一样, 位置是JSON Pointer
+    std::string bad = R"({"id": 0.5, "name": "Gary", "role": {"custom": [2]}, "score": 100, "tags": ["a", 1, "c"], "meta": {"v": 1, "x/y": 2}})";
+    std::vector<SchemaError> fromDom;
+    EXPECT(!schema.validate(parse(bad), &fromDom));
+    EXPECT(!schema.validate(bad, &errors, parseError) && !parseError);
+    EXPECT(errors.size() == fromDom.size());
+    auto has = [&](const std::string &pointer, const std::string &text)
+    {
+        for (const auto &e : errors)
+        {
+            if (e.pointer == pointer && e.message.find(text) != std::string::npos)
+                return true;
+        }
+        return false;
+    };
+    EXPECT(has("/id", "expected integer") && has("/name", "pattern") && has("/role", "enum"));
+    EXPECT(has("/score", "< 100") && has("/tags/1", "expected string") && has("/tags", "more than 2"));
+    EXPECT(has("/meta/x~1y", "not allowed"));
+    EXPECT(errors.size() == 7);
+
+    EXPECT(!schema.validate(parse("{\"id\": 1}"), &errors) && errors.size() == 1 && errors[0].pointer == "" && errors[0].message.find("\"name\"") != std::string::npos);
+    EXPECT(!schema.validate(parse("[]"), &errors) && errors.size() == 1 && errors[0].message == "expected object, got array");
+
+    // 验证和别的handler在同一遍里
+    RecordingHandler next;
+    SchemaValidator validator(schema, &next);
+    EXPECT(parse("{\"id\": 3, \"name\": \"ab\"}", validator, parseError) && validator.ok());
+    EXPECT(next.events == "{ kid i3 kname sab } ");
+
+    EXPECT(!schema.validate("{\"id\": 3,", &errors, parseError) && parseError.code == ParseErrorCode::UNEXPECTED_END);
+
+    // 重复的key以最后一个为准, 和先parse成树再验证的结论一样
+    Schema single = Schema::compile(parse(R"({"type": "object", "maxProperties": 1, "properties": {"a": {"type": "integer"}, "b": {"type": "integer"}}})"));
+    EXPECT(single.validate(std::string(R"({"a": "x", "a": 1})"), &errors, parseError) && errors.empty());
+    EXPECT(single.validate(parse(R"({"a": "x", "a": 1})")));
+    EXPECT(!single.validate(std::string(R"({"a": 1, "b": "y", "a": "x", "b": 2})"), &errors, parseError));
+    EXPECT(errors.size() == 2 && errors[0].pointer == "/a" && errors[1].message == "more than 1 properties");
+
+    // pattern: 不锚定, 字符类, 量词, 分组, 非ASCII字符
+    auto matches = [](const std::string &pattern, const std::string &value)
+    {
+        Json schema = Json(object());
+        schema.addToObject("pattern", Json(pattern));
+        return Schema::compile(schema).validate(Json(value));
+    };
+    EXPECT(matches("b+c", "abbbcd") && !matches("^b+c", "abbbcd") && matches("^(ab|cd){2}$", "abcd") && !matches("^(ab|cd){2}$", "abcdab"));
+    EXPECT(matches("^[\\w.-]+@[^\\s@]+\\.[a-z]{2,}$", "gary.x@mail.example.org") && !matches("^\\d{3,4}$", "12345"));
+    EXPECT(matches("^[^a-c]é\\u00e9?$", "zé") && matches("^a.c$", "a中c") && !matches("^a.c$", "a\nc") && matches("\\bcat\\b", "a cat!"));
+    EXPECT(matches("^(a*)*b?$", "aaaa") && matches("[\\]\\-]x{1,}?$", "-xx") && matches("^x{2}{$", "xx{"));
+    // 很长的字符串不会爆栈, 也不会指数回溯
+    std::string longValue(1 << 20, 'a');
+    EXPECT(matches("^(a|b)*$", longValue) && !matches("^(a|aa)*c$", longValue));
+    EXPECT(matches("^(a|b)*$", std::string(100 * 1024, 'b') + "a"));
+
+    for (const char *invalid : {"[]", "{\"type\": \"text\"}", "{\"minLength\": -1}", "{\"pattern\": \"(\"}", "{\"properties\": {\"a\": 1}}",
+                                "{\"pattern\": \"(a)\\\\1\"}", "{\"pattern\": \"(?=a)\"}", "{\"pattern\": \"*a\"}", "{\"pattern\": \"a{1000}{1000}\"}", "{\"pattern\": \"[b-a]\"}"})
+    {
+        try
+        {
+            Schema::compile(parse(invalid));
+            EXPECT(false);
+        }
+        catch (const myJsonException &)
+        {
+        }
+    }
+}
+
+void TestStreamParser()
+{
+    std::string text = "{\"name\": \"a\\\"b\", \"list\": [1, -20, 3.5e2, true, null, 18446744073709551615],\n \"nested\": {\"k\": []}, \"s\": \"\"}";
+    Json expected = parse(text);
+    // 按各种大小切块, 结果都和一次parse一样
+    for (size_t size : {1, 2, 3, 7, 64, 1000})
+    {
+        StreamParser parser;
+        for (size_t i = 0; i < text.size(); i += size)
+            EXPECT(parser.feed(std::string_view(text).substr(i, size)));
+        EXPECT(parser.done() && parser.finish());
+        EXPECT(parser.release() == expected);
+    }
+
+    // 根是数字时要到finish才知道结束了
+    StreamParser number;
+    EXPECT(number.feed("12") && number.feed("34") && !number.done() && number.finish());
+    EXPECT(number.release().getInt64() == 1234);
+
+    // 出错的位置和路径和parse一样, 不管从哪里切开
+    std::string bad = "{\"a\": [1,\n 2, tru]}";
+    ParseError expectedError;
+    parse(bad, expectedError);
+    for (size_t size : {1, 4, 100})
+    {
+        StreamParser parser;
+        bool ok = true;
+        for (size_t i = 0; ok && i < bad.size(); i += size)
+            ok = parser.feed(std::string_view(bad).substr(i, size));
+        EXPECT(!ok && !parser.finish());
+        const ParseError &error = parser.error();
+        EXPECT(error.code == expectedError.code && error.offset == expectedError.offset);
+        EXPECT(error.line == 2 && error.column == expectedError.column && string(error.path) == expectedError.path);
+    }
+
+    StreamParser truncated;
+    EXPECT(truncated.feed("[1, \"ab") && !truncated.finish() && truncated.error().code == ParseErrorCode::UNEXPECTED_END);
+    EXPECT(truncated.error().offset == 7 && string(truncated.error().path) == "$[1]");
+
+    ParseOptions options;
+    options.maxInputBytes = 5;
+    StreamParser limited(options);
+    EXPECT(limited.feed("[1,") && !limited.feed("2,3]") && limited.error().code == ParseErrorCode::INPUT_TOO_LARGE);
+
+    // 跨块的字符串/数字超长时在feed里就失败, 不等结束的引号
+    options = ParseOptions();
+    options.maxStringLength = 16;
+    StreamParser longString(options);
+    EXPECT(longString.feed("[\"\\n\\u00e9") && longString.feed(std::string(14, 'x')));
+    EXPECT(!longString.feed("x") && longString.error().code == ParseErrorCode::STRING_TOO_LONG);
+    EXPECT(longString.error().offset == 24 && string(longString.error().path) == "$[0]");
+    StreamParser longKey(options);
+    EXPECT(longKey.feed("{\"") && !longKey.feed(std::string(1 << 20, 'k')) && longKey.error().code == ParseErrorCode::STRING_TOO_LONG);
+    StreamParser longNumber(options);
+    EXPECT(longNumber.feed("[1") && !longNumber.feed(std::string(1 << 20, '0')) && longNumber.error().code == ParseErrorCode::STRING_TOO_LONG);
+    StreamParser longLiteral;
+    EXPECT(longLiteral.feed("[fals") && !longLiteral.feed("eeeeee") && longLiteral.error().code == ParseErrorCode::INVALID_LITERAL);
+}
+
+Task<Json> readRequest(AsyncPipe &pipe)
+{
+    Json body = co_await parseAsync(pipe);
+    body["seen"] = true;
+    co_return body;
+}
+
+Task<bool> readEvents(AsyncPipe &pipe, JsonHandler &handler, ParseError &error)
+{
+    co_return co_await parseAsync(pipe, handler, error);
+}
+
+void TestAsync()
+{
+    AsyncPipe pipe;
+    Task<Json> task = readRequest(pipe);
+    task.start();
+    EXPECT(!task.done()); // 没有数据, 挂起
+    pipe.write("{\"id\": 4");
+    EXPECT(!task.done());
+    pipe.write("2, \"tags\": [\"x\", \"y");
+    pipe.write("\"]}");
+    EXPECT(task.done()); // 根值完整就返回, 不用等close
+    EXPECT(task.result() == parse("{\"id\": 42, \"tags\": [\"x\", \"y\"], \"seen\": true}"));
+
+    AsyncPipe broken;
+    Task<Json> failing = readRequest(broken);
+    failing.start();
+    broken.write("[1, 2");
+    broken.close();
+    EXPECT(failing.done());
+    try
+    {
+        failing.result();
+        EXPECT(false);
+    }
+    catch (const myJsonException &e)
+    {
+        EXPECT(string(e.what()).find("unexpected end") != string::npos && e.getPosition() == 5);
+    }
+
+    AsyncPipe events;
+    RecordingHandler handler;
+    ParseError error;
+    Task<bool> streaming = readEvents(events, handler, error);
+    streaming.start();
+    events.write("[1, {\"k\"");
+    EXPECT(handler.events == "[ i1 { kk "); // 已经到的部分马上发出去
+    events.write(": false}]");
+    EXPECT(streaming.done() && streaming.result() && !error);
+    EXPECT(handler.events == "[ i1 { kk f } ] ");
+
+    // 同一块里有两条消息, 第二条留在pipe里给下一次parse
+    AsyncPipe connection;
+    connection.write("{\"x\":1}{\"y\":");
+    Task<Json> first = readRequest(connection);
+    first.start();
+    EXPECT(first.done() && first.result() == parse("{\"x\": 1, \"seen\": true}"));
+    Task<Json> second = readRequest(connection);
+    second.start();
+    EXPECT(!second.done());
+    connection.write("2} ");
+    EXPECT(second.done() && second.result() == parse("{\"y\": 2, \"seen\": true}"));
+
+    // 根是数字时要看到分隔符才知道结束
+    StreamParser number;
+    size_t consumed;
+    EXPECT(number.feed("7", consumed) && !number.done() && consumed == 1);
+    EXPECT(number.feed(" 8", consumed) && number.done() && consumed == 0);
+    EXPECT(number.finish() && number.release().getInt64() == 7);
+
+    ParseOptions options;
+    options.maxInputBytes = 8;
+    StreamParser limited(options);
+    EXPECT(limited.feed("[1,2]\n[3,4,5]", consumed) && limited.done() && consumed == 5);
+    StreamParser overflow(options);
+    EXPECT(!overflow.feed("[1,2,3,4,5]", consumed) && overflow.error().code == ParseErrorCode::INPUT_TOO_LARGE);
+}
+
+void TestParallelDump()
+{
+    // 大数组, 大对象, 小容器套大容器, 空容器, 深层的链
+    Json doc{object()};
+    Json records{myJson::array()};
+    for (int i = 0; i < 3000; i++)
+    {
+        Json record{object()};
+        record["id"] = i;
+        record["name"] = "user" + to_string(i);
+        record["scores"] = Json(myJson::array{Json(i * 0.5), Json(true), Json(nullptr)});
+        records.addToArray(record);
+    }
+    doc["records"] = records;
+    Json wide{object()};
+    for (int i = 0; i < 500; i++)
+        wide["key" + to_string(i)] = Json(myJson::array{Json(i), Json(object())});
+    doc["wide"] = wide;
+    doc["empty"] = Json(object());
+    Json chain = Json(myJson::array{Json(1)});
+    for (int i = 0; i < 40; i++)
+        chain = Json(myJson::array{chain, Json(i)});
+    doc["chain"] = chain;
+
+    std::string expected = doc.dump();
+    for (size_t threads : {1, 2, 3, 8})
+    {
+        ParallelDumpOptions options;
+        options.threads = threads;
+        options.minParallelNodes = 1;
+        EXPECT(dumpParallel(doc, options) == expected);
+        EXPECT(dumpParallel(records, options) == records.dump());
+    }
+    EXPECT(dumpParallel(Json(42)) == Json(42).dump());
+
+    // writev直接写到文件
+    FILE *file = tmpfile();
+    ParallelDumpOptions options;
+    options.threads = 4;
+    options.minParallelNodes = 1;
+    EXPECT(file && dumpParallel(doc, fileno(file), options));
+    std::string written(expected.size() + 1, '\0');
+    rewind(file);
+    written.resize(fread(&written[0], 1, written.size(), file));
+    fclose(file);
+    EXPECT(written == expected);
+}
+
+void TestJsonLiteral()
+{
+    using namespace myJson::literals;
+    // 编译期解析, 运行时直接读静态的快照字节
+    constexpr SnapshotValue config = R"({"port": 8080, "hosts": ["a", "b\n"], "tls": {"on": true, "ratio": 0.1}, "none": null})"_json;
+    EXPECT(config.is_object() && config.size() == 4);
+    EXPECT(config["port"].getInt64() == 8080);
+    EXPECT(config["hosts"].size() == 2 && config["hosts"][1].getString() == "b\n");
+    EXPECT(config["tls"]["on"].getBool() && config["tls"]["ratio"].getNumber() == 0.1);
+    EXPECT(config["none"].is_null() && !config.contains("missing"));
+    EXPECT("[]"_json.size() == 0 && "-0"_json.getInt64() == 0 && "\"s\""_json.getString() == "s");
+
+    // 和dumpSnapshot(parse(文本))逐字节相同, 包括数字的舍入, 重复key, 字符串去重
+    constexpr literal::FixedString text = R"( {"z": [1, -9223372036854775808, 18446744073709551615, 123456789012345678901234567890],
+        "d": [0.1, 2.5e-3, 1e308, 2.2250738585072014e-308, 4.4501477170144023e-308, -0.0, 1.7976931348623157e308, 0.30000000000000004, 3.14159265358979323846264338327950288,
+              5e-324, 2.2250738585072014e-310, 2.4703282292062328e-324, 1e-400, -1e-400],
+        "s": ["x", "x", "\t\"\\\/"], "x": {"k": 1, "k": 2, "a": {}}, "e": [[], [[]]]} )";
+    std::string_view bytes = literal::snapshotBytes<text>();
+    EXPECT(bytes == dumpSnapshot(parse(std::string(text.view()))));
+    Snapshot snap(bytes.data(), bytes.size());
+    EXPECT(snap.root()["x"]["k"].getInt64() == 2);
+    EXPECT(snap.root()["d"][3].getNumber() == 2.2250738585072014e-308 && snap.root()["d"][7].getNumber() == 0.30000000000000004);
+    EXPECT(snap.root()["d"][9].getNumber() == 5e-324 && snap.root()["d"][10].getNumber() == 2.2250738585072014e-310);
+    EXPECT(snap.root()["d"][11].getNumber() == 5e-324 && std::signbit(snap.root()["d"][13].getNumber()));
+}
+
+void TestTemplate()
+{
+    Template tpl = Template::compile(parse(R"({"code": 0, "msg": "ok", "data": {"id": "{{id}}", "name": "{{name}}", "tags": ["{{tag}}", "x", "{{tag}}"], "extra": "{{extra}}"}, "{{not}}x": "{not}"})"));
+    EXPECT(tpl.slotCount() == 4 && tpl.slotName(tpl.slot("tag")) == "tag");
+
+    TemplateArgs args(tpl);
+    args.set("id", 42).set("name", "a\"b\n").set("tag", std::string("t")).set("extra", parse("{\"k\": [1.5, null]}"));
+    std::string out = tpl.render(args);
+
+    // 和把值填进骨架后writeJson一样
+    Json filled = parse(R"({"code": 0, "msg": "ok", "data": {"id": 42, "name": "", "tags": ["t", "x", "t"], "extra": {"k": [1.5, null]}}, "{{not}}x": "{not}"})");
+    filled["data"]["name"] = "a\"b\n";
+    EXPECT(out == writeJson(filled));
+    EXPECT(parse(out) == filled);
+
+    // 复用同一个args, 没set的槽报错
+    args.clear();
+    args.set("id", nullptr).set("name", std::string_view("n")).set("tag", true);
+    bool thrown = false;
+    try
+    {
+        tpl.render(args);
+    }
+    catch (const myJsonException &)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+    args.set("extra", -1.25);
+    EXPECT(tpl.render(args) == R"({"code":0,"data":{"extra":-1.25,"id":null,"name":"n","tags":[true,"x",true]},"msg":"ok","{{not}}x":"{not}"})");
+
+    thrown = false;
+    try
+    {
+        args.set("missing", 1);
+    }
+    catch (const myJsonException &)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+
+    // 整个骨架就是一个槽
+    Template whole = Template::compile(Json("{{v}}"));
+    EXPECT(whole.render(TemplateArgs(whole).set("v", Json(myJson::array()))) == "[]");
+}
+
+void TestColumns()
+{
+    std::string text = R"([{"price": 1.5, "sku": "a", "qty": 3, "extra": {"price": 9}},
+                            {"sku": "bc", "price": null, "qty": 18446744073709551615},
+                            {"price": -2, "sku": "", "price": 7, "tags": [1, "x"]},
+                            {}])";
+    std::vector<ColumnSpec> fields = {{"price", ColumnType::NUMBER}, {"sku", ColumnType::STRING}, {"qty", ColumnType::NUMBER}};
+    // 走SAX和走Json树的结果一样
+    for (const ColumnTable &table : {toColumns(text, fields), toColumns(parse(text), fields)})
+    {
+        EXPECT(table.rows == 4 && table.columns.size() == 3);
+        const Column &price = table["price"];
+        EXPECT(price.numbers.size() == 4 && price.numbers[0] == 1.5 && price.numbers[1] == 0 && price.numbers[3] == 0);
+        EXPECT(price.isValid(0) && !price.isValid(1) && price.isValid(2) && !price.isValid(3));
+        const Column &sku = table["sku"];
+        EXPECT(sku.offsets.size() == 5 && sku.blob == "abc");
+        EXPECT(sku.string(0) == "a" && sku.string(1) == "bc" && sku.string(2).empty() && sku.isValid(2) && !sku.isValid(3));
+        EXPECT(table["qty"].numbers[1] == 18446744073709551615.0 && !table["qty"].isValid(2));
+    }
+    // 重复的key: SAX和Json树都和parse()一样取最后一个
+    EXPECT(toColumns(text, fields)["price"].numbers[2] == 7 && toColumns(parse(text), fields)["price"].numbers[2] == 7);
+    ColumnTable dup = toColumns(std::string(R"([{"sku": "abc", "sku": "d"}, {"sku": "e", "sku": null}])"), fields);
+    EXPECT(dup["sku"].blob == "d" && dup["sku"].string(0) == "d" && !dup["sku"].isValid(1));
+
+    // 超过64行, 位图跨越多个字
+    std::string many = "[";
+    for (int i = 0; i < 130; i++)
+        many += std::string(i ? "," : "") + (i % 3 ? "{\"v\": " + to_string(i) + "}" : "{\"v\": null}");
+    many += "]";
+    ColumnTable big = toColumns(many, {{"v", ColumnType::NUMBER}});
+    EXPECT(big.rows == 130 && big["v"].valid.size() == 3 && big["v"].isValid(128) && !big["v"].isValid(129) && big["v"].numbers[128] == 128);
+
+    // 类型不对, 或者不是对象数组
+    for (const char *bad : {R"([{"price": "1"}])", R"([{"sku": 1}])", R"([{"price": [1]}])", R"([1])", R"({"a": 1})", R"([{"price": 1)"})
+    {
+        bool thrown = false;
+        try
+        {
+            toColumns(std::string(bad), fields);
+        }
+        catch (const myJsonException &)
+        {
+            thrown = true;
+        }
+        EXPECT(thrown);
+    }
+}
+
+void TestEdit()
+{
+    const std::string text = "{ \"users\": [ {\"name\": \"a\", \"age\": 1},\n {\"name\": \"b\\\"\", \"tmp\": [1, {\"x\": \"}\"}]} ],\n  \"meta\" : {\"v\": 1.50}, \"empty\": {}, \"list\": [] }";
+    auto expectSame = [](const std::string &out, const std::string &json)
+    {
+        EXPECT(parse(out) == parse(json));
+    };
+
+    // 改一个值, 其他字节不动
+    JsonEditor editor(text);
+    editor.set("/users/1/name", Json("c"));
+    std::string out = editor.apply();
+    EXPECT(out.size() == editor.size());
+    size_t at = text.find("\"b\\\"\"");
+    EXPECT(out.compare(0, at, text, 0, at) == 0 && out.substr(at, 3) == "\"c\"");
+    EXPECT(out.compare(at + 3, std::string::npos, text, at + 5, std::string::npos) == 0);
+
+    // 加成员, 删成员(第一个/最后一个), 追加数组, 空容器
+    JsonEditor many(text);
+    many.set("/meta/w", Json(myJson::array{Json(true)}))
+        .remove("/users/0/name")
+        .remove("/users/1/tmp")
+        .set("/list/-", Json(1))
+        .set("/list/-", Json("x"))
+        .set("/empty/k", Json(nullptr))
+        .setRaw("/meta/v", "2.25")
+        .set("/users/-", Json(object()));
+    expectSame(many.apply(), R"({"users": [{"age": 1}, {"name": "b\""}, {}], "meta": {"v": 2.25, "w": [true]}, "empty": {"k": null}, "list": [1, "x"]})");
+
+    // 删掉唯一的成员之后再加, 不能多出逗号
+    JsonEditor only("{\"a\": {\"k\": 1}}");
+    only.remove("/a/k").set("/a/n", Json(2));
+    EXPECT(only.apply() == "{\"a\": {\"n\":2}}");
+
+    // 删掉相邻的成员, 删光, 删光再加
+    JsonEditor neighbours("{\"a\":1,\"b\":2,\"c\":3}");
+    neighbours.remove("/b").remove("/c");
+    EXPECT(neighbours.apply() == "{\"a\":1}" && neighbours.size() == 7);
+    JsonEditor leading("{\"a\":1, \"b\":2, \"c\":3}");
+    leading.remove("/b").remove("/a");
+    EXPECT(leading.apply() == "{\"c\":3}");
+    JsonEditor pair("[1,2]");
+    pair.remove("/0").remove("/1");
+    EXPECT(pair.apply() == "[]");
+    JsonEditor all("[ 1, 2 ,3 ]");
+    all.remove("/2").remove("/0").remove("/1");
+    EXPECT(all.apply() == "[  ]");
+    JsonEditor gap("[1, 2, 3, 4]");
+    gap.remove("/3").remove("/1").set("/2", Json(5));
+    EXPECT(gap.apply() == "[1, 5]");
+    JsonEditor refill("{\"a\": 1, \"b\": 2}");
+    refill.set("/c", Json(3)).remove("/a").remove("/b").set("/d", Json(4));
+    EXPECT(refill.apply() == "{\"c\":3,\"d\":4}");
+#ifndef _WIN32
+    std::string pieces;
+    for (const iovec &iov : refill.iovecs())
+        pieces.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    EXPECT(pieces == refill.apply());
+#endif
+
+    // 转义的key, 整个文档
+    JsonEditor escaped("{\"a/b\": 1, \"t\\n\": 2}");
+    escaped.set("/a~1b", Json(3));
+    EXPECT(escaped.apply() == "{\"a/b\": 3, \"t\\n\": 2}");
+    JsonEditor root(" [1] ");
+    root.set("", Json(object()));
+    EXPECT(root.apply() == " {} ");
+
+#ifndef _WIN32
+    std::string joined;
+    for (const iovec &iov : many.iovecs())
+        joined.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    EXPECT(joined == many.apply());
+#endif
+
+    // 找不到的路径, 重叠的编辑
+    for (const char *bad : {"/users/5/name", "/meta/v/x", "/nope/x", "/users/x", "a"})
+    {
+        bool thrown = false;
+        try
+        {
+            JsonEditor(text).set(bad, Json(1));
+        }
+        catch (const myJsonException &)
+        {
+            thrown = true;
+        }
+        EXPECT(thrown);
+    }
+    bool thrown = false;
+    try
+    {
+        JsonEditor(text).set("/users/0", Json(1)).set("/users/0/age", Json(2));
+    }
+    catch (const myJsonException &)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+    thrown = false;
+    try
+    {
+        JsonEditor(text).remove("/meta/v").remove("/meta/v");
+    }
+    catch (const myJsonException &)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+}
+
+void TestMemoryUsage()
+{
+    Json doc = parse(R"({"name": "a string that is long enough to live on the heap", "short": "s",
+                         "items": [1, 2.5, true, null, "another string that does not fit into SSO"],
+                         "nested": {"a key that is long enough to live on the heap too": 18446744073709551615}})");
+    MemoryUsage usage = doc.memoryUsage();
+    EXPECT(usage[JsonValueType::OBJECT].count == 2 && usage[JsonValueType::ARRAY].count == 1);
+    EXPECT(usage[JsonValueType::STRING].count == 3 && usage[JsonValueType::UINT64].count == 1 && usage[JsonValueType::NUL].count == 1);
+    size_t byType = 0, nodes = 0;
+    for (const MemoryUsage::Entry &entry : usage.types)
+    {
+        byType += entry.bytes;
+        nodes += entry.count;
+    }
+    EXPECT(nodes == 11 && byType == usage.total());
+    EXPECT(usage.stringBytes > 100 && usage.containerBytes >= 5 * sizeof(Json));
+
+    // 删掉元素后数组留着预留空间, shrink_to_fit还回去
+    Json list{myJson::array()};
+    for (int i = 0; i < 100; i++)
+        list.addToArray(Json("element number " + to_string(i) + " with some padding"));
+    for (int i = 0; i < 90; i++)
+        list.removeFromArray(0);
+    MemoryUsage before = list.memoryUsage();
+    EXPECT(before.slackBytes >= 90 * sizeof(Json));
+    uint64_t h = list.hash();
+    list.shrink_to_fit();
+    MemoryUsage after = list.memoryUsage();
+    EXPECT(after.slackBytes == 0 && after.total() < before.total() && list.hash() == h);
+    EXPECT(list[0].getString() == "element number 90 with some padding");
+
+    // compact到一块连续的内存上
+    std::string text = doc.dump();
+    std::pmr::monotonic_buffer_resource arena(usage.total() * 2);
+    Json copy = doc;
+    copy.compact(&arena);
+    EXPECT(copy == doc && copy.resource() == &arena && copy["items"][4].resource() == &arena);
+    EXPECT(copy.memoryUsage().slackBytes == 0 && copy.dump() == text);
+    doc.compact();
+    EXPECT(doc == copy && doc.memoryUsage().total() <= usage.total());
+}
+
+void TestStats()
+{
+    JsonStats stats;
+    {
+        StatsScope scope(stats);
+        Json j = parse("{ \"a\": [1, 2.5, \"s\", null, true], \"b\": {\"c\": false}}");
+        std::string out = j.dump();
+        try
+        {
+            parse("[1, 2");
+        }
+        catch (const myJsonException &)
+        {
+        }
+    }
+#ifdef MYJSON_ENABLE_STATS
+    EXPECT(stats.parses == 2 && stats.errors == 1);
+    EXPECT(stats.nodeCount(JsonValueType::INT64) >= 1 && stats.nodeCount(JsonValueType::NUMBER) == 1);
+    EXPECT(stats.nodeCount(JsonValueType::OBJECT) == 2 && stats.nodeCount(JsonValueType::ARRAY) == 1);
+    EXPECT(stats.nodeCount(JsonValueType::BOOL) == 2 && stats.nodeCount(JsonValueType::STRING) == 1);
+    EXPECT(stats.maxDepth == 2 && stats.allocations > 0);
+    EXPECT(stats.dumps == 1 && stats.dumpBytes > 0);
+    EXPECT(stats.parseNanos >= stats.stringNanos + stats.numberNanos);
+    size_t exported = 0;
+    stats.forEach([&](const char *, uint64_t)
+                  { exported++; });
+    EXPECT(exported == 22);
+#else
+    // 没打开统计时什么都不收集
+    EXPECT(stats.parses == 0 && stats.dumps == 0 && stats.nodeCount(JsonValueType::OBJECT) == 0);
+#endif
+}
+
+void TestRfcGrammar()
+{
+    // 只认RFC 8259的数字, strtod收的这些都拒绝
+    const char *badNumbers[] = {"[+1]", "[01]", "[-01]", "[1.]", "[.5]", "[1e]", "[1e+]", "[-]", "[-nan]", "[1.5e]"};
+    for (const char *text : badNumbers)
+    {
+        ParseError error;
+        parse(text, error);
+        EXPECT(error.code == ParseErrorCode::INVALID_NUMBER);
+        StreamParser stream;
+        EXPECT(!(stream.feed(text) && stream.finish()));
+        EXPECT(stream.error().code == ParseErrorCode::INVALID_NUMBER);
+    }
+    // 0x1是数字0后面跟着x
+    ParseError hex;
+    parse("[0x1]", hex);
+    EXPECT(hex.code == ParseErrorCode::EXPECTED_ARRAY_END && hex.offset == 2);
+    Json numbers = parse("[0, -0, 0.5, 1E+2, 2e-3, -0.0e0]");
+    EXPECT(numbers[0].getInt64() == 0 && numbers[3].getNumber() == 100 && numbers[4].getNumber() == 0.002);
+    EXPECT(numbers[5].getNumber() == 0 && std::signbit(numbers[5].getNumber()));
+    // 非规格化数是合法的double, 太小的下溢成±0, 只有溢出成无穷大的才算超出范围
+    Json tiny = parse("[5e-324, 2.2250738585072014e-310, 1e-400, -123e-10000000]");
+    EXPECT(tiny[0].getNumber() == 5e-324 && tiny[1].getNumber() == 2.2250738585072014e-310);
+    EXPECT(tiny[2].getNumber() == 0 && tiny[3].getNumber() == 0 && std::signbit(tiny[3].getNumber()));
+    for (const char *text : {"[1e309]", "[-1.8e308]", "[1e10000000000]"})
+    {
+        ParseError error;
+        parse(text, error);
+        EXPECT(error.code == ParseErrorCode::NUMBER_OUT_OF_RANGE);
+    }
+    EXPECT(readJson<std::vector<double>>("[5e-324, -1e-400]")[1] == 0);
+
+    // \u转义, 代理对合成一个码点, 都按UTF-8存
+    Json s = parse(R"(["\u0041\u00e9\u4E2D", "\ud83d\ude00", "a\u0000b"])");
+    EXPECT(s[0].getString() == "A\xC3\xA9\xE4\xB8\xAD");
+    EXPECT(s[1].getString() == "\xF0\x9F\x98\x80");
+    EXPECT(s[2].getString().size() == 3 && s[2].getString()[1] == '\0');
+    const char *badEscapes[] = {R"(["\u12"])", R"(["\uzzzz"])", R"(["\ud800"])", R"(["\udc00"])", R"(["\ud800\u0041"])", R"(["\ud800\n"])"};
+    for (const char *text : badEscapes)
+    {
+        ParseError error;
+        parse(text, error);
+        EXPECT(error.code == ParseErrorCode::INVALID_ESCAPE && error.offset == 2);
+    }
+
+    // 控制字符必须转义
+    ParseError error;
+    parse("[\"a\tb\"]", error);
+    EXPECT(error.code == ParseErrorCode::INVALID_CHARACTER && error.offset == 3);
+
+    // 跨块的\u和代理对
+    StreamParser stream;
+    std::string text = R"({"k\u00e9": "\ud83d\ude00"})";
+    for (char c : text)
+        EXPECT(stream.feed(std::string_view(&c, 1)));
+    EXPECT(stream.finish());
+    Json streamed = stream.release();
+    EXPECT(streamed["k\xC3\xA9"].getString() == "\xF0\x9F\x98\x80");
+
+    // 其他读json的地方和parse一样
+    using namespace myJson::literals;
+    EXPECT(R"("\u00e9\ud83d\ude00")"_json.getString() == "\xC3\xA9\xF0\x9F\x98\x80");
+    EXPECT(readJson<std::vector<std::string>>(R"(["\u00e9"])")[0] == "\xC3\xA9");
+    try
+    {
+        readJson<std::vector<double>>("[01]");
+        EXPECT(false);
+    }
+    catch (const myJsonException &)
+    {
+    }
+    JsonEditor editor(R"({"\u00e9": 1})");
+    EXPECT(editor.set("/\xC3\xA9", Json(2)).apply() == R"({"\u00e9": 2})");
+}
+
+// 流式解析, 每次喂chunk个字节
+static bool feedBy(StreamParser &stream, const std::string &text, size_t chunk)
+{
+    for (size_t i = 0; i < text.size(); i += chunk)
+    {
+        if (!stream.feed(std::string_view(text).substr(i, chunk)))
+            return false;
+    }
+    return stream.finish();
+}
+
+void TestParseOptions()
+{
+    // 默认是严格的RFC 8259
+    const char *extensions[] = {"[1, 2,]", "{\"a\": 1,}", "[NaN]", "['a']", "[1] // c", "/* c */ 1"};
+    for (const char *text : extensions)
+    {
+        ParseError error;
+        parse(text, error);
+        EXPECT(error);
+        StreamParser stream;
+        EXPECT(!feedBy(stream, text, 1));
+    }
+    ParseError error;
+    parse("[1] x", error);
+    EXPECT(error.code == ParseErrorCode::TRAILING_CONTENT && error.offset == 4);
+    StreamParser strict;
+    EXPECT(!feedBy(strict, "{} {}", 64) && strict.error().code == ParseErrorCode::TRAILING_CONTENT);
+
+    // 扩展逐个打开
+    ParseOptions options;
+    options.allowTrailingContent = true;
+    EXPECT(parse("[1] x", options, error).getArray().size() == 1 && !error);
+
+    options = ParseOptions();
+    options.allowComments = true;
+    std::string commented = "// head\n{/* a */\"a\" /**/ : [1, // one\n 2]/***/} // tail";
+    Json json = parse(commented, options, error);
+    EXPECT(!error && json["a"][1].getInt64() == 2);
+    for (size_t chunk = 1; chunk <= commented.size(); chunk++)
+    {
+        StreamParser stream(options);
+        EXPECT(feedBy(stream, commented, chunk));
+        EXPECT(stream.release()["a"].getArray().size() == 2);
+    }
+    const char *badComments[] = {"[1 /* open", "[1 / 2]", "1 /"};
+    for (const char *text : badComments)
+    {
+        parse(text, options, error);
+        EXPECT(error.code == ParseErrorCode::INVALID_COMMENT || error.code == ParseErrorCode::UNEXPECTED_END);
+        StreamParser stream(options);
+        EXPECT(!feedBy(stream, text, 1));
+    }
+    parse("[1 / 2]", options, error);
+    EXPECT(error.code == ParseErrorCode::INVALID_COMMENT && error.offset == 3);
+
+    options = ParseOptions();
+    options.allowTrailingCommas = true;
+    json = parse("{\"a\": [1, 2,], \"b\": {},}", options, error);
+    EXPECT(!error && json["a"].getArray().size() == 2 && json.getObject().size() == 2);
+    parse("[1,,]", options, error);
+    EXPECT(error);
+    parse("[,]", options, error);
+    EXPECT(error);
+
+    options = ParseOptions();
+    options.allowNanInf = true;
+    json = parse("[NaN, Infinity, -Infinity]", options, error);
+    EXPECT(!error && std::isnan(json[0].getNumber()) && json[1].getNumber() == HUGE_VAL && json[2].getNumber() == -HUGE_VAL);
+    parse("[nan]", options, error);
+    EXPECT(error);
+
+    options = ParseOptions();
+    options.allowSingleQuotes = true;
+    json = parse(R"({'it\'s': "a'b", "c": 'say "hi"'})", options, error);
+    EXPECT(!error && json["it's"].getString() == "a'b" && json["c"].getString() == "say \"hi\"");
+    parse(R"(["\'"])", options, error);
+    EXPECT(error.code == ParseErrorCode::INVALID_ESCAPE);
+
+    // 重复的key
+    const std::string dup = R"({"a": 1, "b": 2, "a": 3})";
+    options = ParseOptions();
+    EXPECT(parse(dup, options, error)["a"].getInt64() == 3);
+    StreamParser last(options);
+    EXPECT(feedBy(last, dup, 3) && last.release()["a"].getInt64() == 3);
+    options.duplicateKeys = DuplicateKeys::FIRST;
+    EXPECT(parse(dup, options, error)["a"].getInt64() == 1);
+    StreamParser first(options);
+    EXPECT(feedBy(first, dup, 3) && first.release()["a"].getInt64() == 1);
+    options.duplicateKeys = DuplicateKeys::REJECT;
+    parse(dup, options, error);
+    EXPECT(error.code == ParseErrorCode::DUPLICATE_KEY && string(error.path) == "$.a");
+    StreamParser reject(options);
+    EXPECT(!feedBy(reject, dup, 3) && reject.error().code == ParseErrorCode::DUPLICATE_KEY);
+
+    // SAX: 扩展一样认, 重复的key照样回调
+    RecordingHandler handler;
+    EXPECT(parse("{'a': [1,], /* c */ 'a': NaN,}", ParseOptions::relaxed(), handler, error));
+    EXPECT(handler.events == "{ ka [ i1 ] ka dnan } ");
+}
+
+void TestDuplicateKeys()
+{
+    // 默认和addToObject一样, 后面的覆盖前面的; 嵌套的对象各自去重
+    std::string text = R"({"b": 1, "a": {"x": 1, "y": 2, "x": 3}, "b": 2, "c": [{"k": 1, "k": 2}]})";
+    Json json = parse(text);
+    Json built(object{});
+    built.addToObject("b", Json(1));
+    built.addToObject("a", parse(R"({"x": 1, "y": 2})"));
+    built.addToObject("b", Json(2));
+    built["a"].addToObject("x", Json(3));
+    built.addToObject("c", parse(R"([{"k": 2}])"));
+    EXPECT(json == built);
+    ParseOptions options;
+    options.duplicateKeys = DuplicateKeys::REJECT;
+    ParseError error;
+    parse(text, options, error);
+    EXPECT(error.code == ParseErrorCode::DUPLICATE_KEY && string(error.path) == "$.a.x");
+
+    // Parser复用时出错留下的成员要清掉
+    Parser parser(options);
+    parser.parse(R"({"a": {"b": 1, "b": 2}})", error);
+    EXPECT(error.code == ParseErrorCode::DUPLICATE_KEY);
+    EXPECT(parser.parse(R"({"a": {"b": 1}, "c": 2})", error)["a"]["b"].getInt64() == 1 && !error);
+
+    // 大对象: 升序的key不用排序, 乱序的排一次, 结果一样
+    const size_t count = 100000;
+    std::string sorted = "{", shuffled = "{";
+    for (size_t i = 0; i < count; i++)
+    {
+        char key[16];
+        snprintf(key, sizeof(key), "k%07zu", i);
+        sorted += std::string(i ? "," : "") + "\"" + key + "\":" + to_string(i);
+        snprintf(key, sizeof(key), "k%07zu", (i * 7919) % count);
+        shuffled += std::string(i ? "," : "") + "\"" + key + "\":" + to_string((i * 7919) % count);
+    }
+    sorted += "}";
+    shuffled += ",\"k0000000\":-1}";
+    Json a = parse(sorted), b = parse(shuffled);
+    EXPECT(a.getObject().size() == count && b.getObject().size() == count);
+    EXPECT(b["k0000000"].getInt64() == -1 && b["k0099999"].getInt64() == 99999);
+    b["k0000000"] = Json(0);
+    EXPECT(a == b);
+    parse(shuffled, options, error);
+    EXPECT(error.code == ParseErrorCode::DUPLICATE_KEY && string(error.path) == "$.k0000000");
+    StreamParser stream(options);
+    EXPECT(!(stream.feed(shuffled) && stream.finish()) && stream.error().code == ParseErrorCode::DUPLICATE_KEY);
+
+    // 其他读json的地方也认最后一个
+    JsonEditor editor(R"({"a": 1, "b": 2, "a": 3})");
+    EXPECT(editor.set("/a", Json(4)).apply() == R"({"a": 1, "b": 2, "a": 4})");
+    EXPECT(JsonEditor(R"({"a": 1, "b": 2, "a": 3})").remove("/a").apply() == R"({"a": 1, "b": 2})");
+    using namespace myJson::literals;
+    EXPECT(R"({"a": 1, "a": 2})"_json["a"].getInt64() == 2);
+}
+
+// 每种类型各有几个, 子节点在visitor里接着visit
+struct TypeCounter
+{
+    size_t counts[JSON_VALUE_TYPE_COUNT] = {};
+
+    void operator()(std::nullptr_t) { counts[static_cast<size_t>(JsonValueType::NUL)]++; }
+    void operator()(bool) { counts[static_cast<size_t>(JsonValueType::BOOL)]++; }
+    void operator()(int64_t) { counts[static_cast<size_t>(JsonValueType::INT64)]++; }
+    void operator()(uint64_t) { counts[static_cast<size_t>(JsonValueType::UINT64)]++; }
+    void operator()(double) { counts[static_cast<size_t>(JsonValueType::NUMBER)]++; }
+    void operator()(const jsonstring &) { counts[static_cast<size_t>(JsonValueType::STRING)]++; }
+    void operator()(const myJson::array &items)
+    {
+        counts[static_cast<size_t>(JsonValueType::ARRAY)]++;
+        for (const Json &item : items)
+            myJson::visit(item, *this);
+    }
+    void operator()(const myJson::object &members)
+    {
+        counts[static_cast<size_t>(JsonValueType::OBJECT)]++;
+        for (const auto &member : members)
+            myJson::visit(member.second, *this);
+    }
+    size_t of(JsonValueType type) const { return counts[static_cast<size_t>(type)]; }
+};
+
+void TestVisit()
+{
+    std::string text = R"({"a": [1, -2, 18446744073709551615, 0.5, "s", null, true], "b": {"c": {}, "d": []}})";
+    for (bool keepText : {false, true})
+    {
+        ParseOptions options;
+        options.keepNumberText = keepText; // 保留原文的数字也按解析出来的类型分派
+        TypeCounter counter;
+        myJson::visit(parse(text, options), counter);
+        EXPECT(counter.of(JsonValueType::OBJECT) == 3 && counter.of(JsonValueType::ARRAY) == 2);
+        EXPECT(counter.of(JsonValueType::INT64) == 2 && counter.of(JsonValueType::UINT64) == 1 && counter.of(JsonValueType::NUMBER) == 1);
+        EXPECT(counter.of(JsonValueType::STRING) == 1 && counter.of(JsonValueType::NUL) == 1 && counter.of(JsonValueType::BOOL) == 1);
+    }
+    Json json = parse(text);
+    size_t size = myJson::visit(json["a"], overloaded{[](const myJson::array &items) { return items.size(); },
+                                                      [](const auto &) { return size_t(0); }});
+    EXPECT(size == 7);
+    EXPECT(myJson::visit(json["a"][0], [](const auto &value) { return std::is_same<std::decay_t<decltype(value)>, int64_t>::value; }));
+
+    // 原地改写: 换值, 删对象成员, 删数组元素
+    Json payload = parse(R"({"user": {"name": "bob", "ssn": "123", "debug": 1,
+                             "cards": [{"pan": "4111", "debug": true}, 7, {"pan": "5500"}, 7, 8]},
+                             "debug": [1, 2]})");
+    uint64_t before = payload.hash();
+    std::string path;
+    transform(payload, [&](Json &value, const TransformSite &site)
+              {
+        path += site.isMember ? std::string(site.key) : to_string(site.index);
+        path += ":" + to_string(site.depth) + " ";
+        if (site.key == "ssn" || site.key == "pan")
+        {
+            value = "***";
+            return TransformAction::SKIP;
+        }
+        if (site.key == "debug" || (value.is_integer() && value.getInt64() == 7))
+            return TransformAction::REMOVE;
+        return TransformAction::DESCEND; });
+    Json expected = parse(R"({"user": {"name": "bob", "ssn": "***", "cards": [{"pan": "***"}, {"pan": "***"}, 8]}})");
+    EXPECT(payload == expected && payload.hash() == expected.hash() && payload.hash() != before);
+    EXPECT(path == "0:0 debug:1 user:1 cards:2 0:3 debug:4 pan:4 1:3 2:3 pan:4 3:3 4:3 debug:2 name:2 ssn:2 ");
+
+    Json root = parse("[1, 2]");
+    transform(root, [](Json &, const TransformSite &) { return TransformAction::REMOVE; });
+    EXPECT(root.is_null());
+
+    // 很深的树也不递归
+    ParseOptions deepOptions;
+    deepOptions.maxDepth = 5000;
+    Json deep = parse(std::string(4000, '[') + "1" + std::string(4000, ']'), deepOptions);
+    size_t deepest = 0;
+    transform(deep, [&](Json &value, const TransformSite &site)
+              {
+        deepest = std::max(deepest, site.depth);
+        if (value.is_integer())
+            value = Json(2);
+        return TransformAction::DESCEND; });
+    EXPECT(deepest == 4000);
+
+    // fn抛异常时: 删掉的已经删了, 没看到的还在
+    Json items = parse("[1, 2, 3, 4, 5]");
+    try
+    {
+        transform(items, [](Json &value, const TransformSite &)
+                  {
+            if (value.is_integer() && value.getInt64() == 4)
+                throw std::runtime_error("stop");
+            return value.is_integer() && value.getInt64() % 2 == 0 ? TransformAction::REMOVE : TransformAction::DESCEND; });
+        EXPECT(false);
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+    EXPECT(items == parse("[1, 3, 4, 5]"));
+}
+
+// 每次写一个字节, 验证流式的hash和分块方式无关
+struct ByteByByte : ByteSink
+{
+    ByteSink &inner;
+    explicit ByteByByte(ByteSink &sink) : inner(sink) {}
+    void write(const char *data, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            inner.write(data + i, 1);
+    }
+};
+
+void TestCanonical()
+{
+    // RFC 8785 3.2.2的例子
+    Json rfc = parse(R"({"numbers":[333333333.33333329,1E30,4.50,2e-3,0.000000000000000000000000001],)"
+                     R"("string":"\u20ac$\u000F\u000aA'\u0042\u0022\u005c\\\"\/","literals":[null,true,false]})");
+    EXPECT(writeCanonical(rfc) == "{\"literals\":[null,true,false],\"numbers\":[333333333.3333333,1e+30,4.5,0.002,1e-27],"
+                                  "\"string\":\"\xE2\x82\xAC$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\"}");
+
+    // RFC 8785 附录B的数字
+    struct
+    {
+        uint64_t bits;
+        const char *text;
+    } numbers[] = {
+        {0x0000000000000000, "0"},
+        {0x8000000000000000, "0"},
+        {0x0000000000000001, "5e-324"},
+        {0x8000000000000001, "-5e-324"},
+        {0x7fefffffffffffff, "1.7976931348623157e+308"},
+        {0x4340000000000000, "9007199254740992"},
+        {0xc340000000000000, "-9007199254740992"},
+        {0x4430000000000000, "295147905179352830000"},
+        {0x44b52d02c7e14af5, "9.999999999999997e+22"},
+        {0x44b52d02c7e14af6, "1e+23"},
+        {0x44b52d02c7e14af7, "1.0000000000000001e+23"},
+        {0x444b1ae4d6e2ef4e, "999999999999999700000"},
+        {0x444b1ae4d6e2ef4f, "999999999999999900000"},
+        {0x444b1ae4d6e2ef50, "1e+21"},
+        {0x3eb0c6f7a0b5ed8c, "9.999999999999997e-7"},
+        {0x3eb0c6f7a0b5ed8d, "0.000001"},
+        {0x41b3de4355555553, "333333333.3333332"},
+        {0x41b3de4355555554, "333333333.33333325"},
+        {0x41b3de4355555555, "333333333.3333333"},
+        {0xbecbf647612f3696, "-0.0000033333333333333333"},
+        {0x43143ff3c1cb0959, "1424953923781206.2"},
+    };
+    for (const auto &number : numbers)
+    {
+        double value;
+        std::memcpy(&value, &number.bits, sizeof(value));
+        EXPECT(writeCanonical(Json(value)) == number.text);
+    }
+    // 整数也按double写
+    EXPECT(writeCanonical(parse("[18446744073709551615, -9223372036854775808, 100, 1e2, -0.0]")) ==
+           "[18446744073709552000,-9223372036854776000,100,100,0]");
+
+    // key按UTF-16码元排序: U+FB33在UTF-8里排在😀(F0...)前面, UTF-16里😀是D83D, 排在前面
+    Json keys = parse(R"({"\ufb33": 7, "\u20ac": 4, "\ud83d\ude00": 6, "\r": 1, "1": 2, "\u0080": 3, "\u00f6": 5, "a": {"z": 1, "\ufb33": 2, "\ud83d\ude00": 3}})");
+    EXPECT(writeCanonical(keys) == "{\"\\r\":1,\"1\":2,\"a\":{\"z\":1,\"\xF0\x9F\x98\x80\":3,\"\xEF\xAC\xB3\":2},\"\xC2\x80\":3,"
+                                   "\"\xC3\xB6\":5,\"\xE2\x82\xAC\":4,\"\xF0\x9F\x98\x80\":6,\"\xEF\xAC\xB3\":7}");
+    // 空白和成员顺序不影响结果
+    EXPECT(writeCanonical(parse("{ \"b\" : [ 1 , 2 ] , \"a\" : 1.0 }")) == writeCanonical(parse(R"({"a":1,"b":[1,2]})")));
+
+    ParseOptions nanOptions;
+    nanOptions.allowNanInf = true;
+    for (const char *text : {"[NaN]", "{\"x\": -Infinity}"})
+    {
+        try
+        {
+            writeCanonical(parse(text, nanOptions));
+            EXPECT(false);
+        }
+        catch (const myJsonException &)
+        {
+        }
+    }
+
+    // SHA-256和XXH64的标准向量
+    auto sha = [](const std::string &text)
+    {
+        Sha256 hasher;
+        hasher.write(text.data(), text.size());
+        return hasher.hexDigest();
+    };
+    EXPECT(sha("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT(sha("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT(sha("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    EXPECT(sha(std::string(1000000, 'a')) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    auto xxh = [](const std::string &text, uint64_t seed)
+    {
+        Xxh64 hasher(seed);
+        hasher.write(text.data(), text.size());
+        return hasher.digest();
+    };
+    EXPECT(xxh("", 0) == 0xEF46DB3751D8E999ULL);
+    EXPECT(xxh("abc", 0) == 0x44BC2CF5AD770999ULL);
+    EXPECT(xxh("Nobody inspects the spammish repetition", 0) == 0xFBCEA83C8A378BF1ULL); // 超过32字节, 走四个累加器
+
+    // 流式和一次性的结果一样: 文档比缓冲区大, sink一次只收一个字节
+    std::string bigText = "[";
+    for (int i = 0; i < 2000; i++)
+        bigText += (i ? "," : "") + std::string(R"({"score": 0.25, "id": )") + to_string(i) + R"(, "name": "item", "tags": ["x", "\u00e9"]})";
+    Json big = parse(bigText + "]");
+    std::string text = writeCanonical(big);
+    EXPECT(text.size() > 3 * 4096);
+    Sha256 whole;
+    whole.write(text.data(), text.size());
+    EXPECT(canonicalSha256(big) == whole.digest());
+    Sha256 bytes;
+    ByteByByte slow(bytes);
+    writeCanonical(slow, big);
+    EXPECT(bytes.digest() == whole.digest());
+    EXPECT(canonicalXxh64(big, 42) == xxh(text, 42) && canonicalXxh64(big) == xxh(text, 0));
+    Xxh64 xxhBytes;
+    ByteByByte slowXxh(xxhBytes);
+    writeCanonical(slowXxh, big);
+    EXPECT(xxhBytes.digest() == xxh(text, 0));
+    // 成员顺序不同的两个对象hash相同
+    EXPECT(canonicalSha256(parse(R"({"a": 1, "b": 2})")) == canonicalSha256(parse(R"({"b":2.0,"a":1})")));
+}
+
 int main(int argc, const char * argv[])
 {
     //TestSetNumber();
     //TestSetArray();
     //TestSetObject();
     TestLiteral();
-    
-    
-    return 0;
+    TestSnapshot();
+    TestNumberTypes();
+    TestAllocator();
+    TestParserPool();
+    TestStats();
+    TestParseError();
+    TestDepth();
+    TestLimits();
+    TestPatch();
+    TestHash();
+    TestBind();
+    TestSax();
+    TestSchema();
+    TestStreamParser();
+    TestAsync();
+    TestParallelDump();
+    TestJsonLiteral();
+    TestTemplate();
+    TestColumns();
+    TestEdit();
+    TestMemoryUsage();
+    TestRfcGrammar();
+    TestParseOptions();
+    TestDuplicateKeys();
+    TestVisit();
+    TestCanonical();
+
+    return g_failures == 0 ? 0 : 1;
 }
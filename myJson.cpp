@@ -5,12 +5,119 @@
 //  Created by garyxuan on 2024/7/16.
 //
 #include "myJson.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
 
 namespace myJson
 {
+    // 所有节点统一按max_align_t对齐分配, 释放时不用再区分类型
+    const size_t NODE_ALIGN = alignof(std::max_align_t);
+
+    // 从resource上分配并构造一个节点
+    template <typename T, typename... Args>
+    JsonValuePtr makeValue(std::pmr::memory_resource *resource, Args &&...args)
+    {
+        void *mem = resource->allocate(sizeof(T), NODE_ALIGN);
+        try
+        {
+            return JsonValuePtr(new (mem) T(std::forward<Args>(args)...), JsonValueDeleter{resource});
+        }
+        catch (...)
+        {
+            resource->deallocate(mem, sizeof(T), NODE_ALIGN);
+            throw;
+        }
+    }
+
+    void JsonValueDeleter::operator()(JsonValue *value) const noexcept
+    {
+        size_t size = value->allocSize();
+        value->~JsonValue();
+        resource->deallocate(value, size, NODE_ALIGN);
+    }
+
+    // 按内容算hash, 定义在后面
+    uint64_t computeHash(const JsonValue *value);
+
+    // 容器的hash要遍历整棵子树才算得出来, 缓存在节点上
+    // 字符串不缓存: 节点多8字节在字符串多的文档上解析明显变慢, 而字符串本身hash很快
+    // 自己的set/add/remove只清自己的缓存. 子节点没有指向父节点的指针, 改子节点时通知不到父节点,
+    // 所以交出过子节点的非const引用(operator[], 迭代器, mutableView)的容器记成"借出过", 以后不再缓存, 每次重新合并子节点的hash
+    // 能拿到某个节点的非const引用, 它往上的每一层都借出过, 所以缓存不会过期; 没借出过的子树照常缓存, parse和拷贝出来的树都是这样
+    class HashCache
+    {
+    protected:
+        mutable std::atomic<uint64_t> m_hash{0}; // 0表示还没算
+        bool m_lent = false;                     // 只在非const访问里写, 之后一直是true
+
+        void invalidateHash() { m_hash.store(0, std::memory_order_relaxed); }
+
+        void lendChildren()
+        {
+            m_lent = true;
+            invalidateHash();
+        }
+
+        uint64_t cachedHashValue() const
+        {
+            return m_lent ? 0 : m_hash.load(std::memory_order_relaxed);
+        }
+
+        void storeHash(uint64_t hash) const
+        {
+            if (!m_lent)
+                m_hash.store(hash, std::memory_order_relaxed);
+        }
+    };
+
+    // 标量和字符串的hash直接算, 不占空间
+    class NoHashCache
+    {
+    protected:
+        void invalidateHash() {}
+        void lendChildren() {}
+    };
+
+    template <JsonValueType Tag>
+    using HashCacheFor = typename std::conditional<Tag == JsonValueType::ARRAY || Tag == JsonValueType::OBJECT,
+                                                   HashCache, NoHashCache>::type;
+
+    // 堆上的字符串: 超过SSO的才分配, 多一个结尾的\0
+    size_t stringHeapBytes(const jsonstring &str)
+    {
+        static const size_t sso = jsonstring().capacity();
+        return str.capacity() > sso ? str.capacity() + 1 : 0;
+    }
+
+    size_t stringSlackBytes(const jsonstring &str)
+    {
+        return stringHeapBytes(str) ? str.capacity() - str.size() : 0;
+    }
+
+    void addUsage(MemoryUsage &usage, JsonValueType type, size_t nodeBytes, size_t stringBytes = 0, size_t containerBytes = 0, size_t slackBytes = 0)
+    {
+        MemoryUsage::Entry &entry = usage.types[static_cast<size_t>(type)];
+        entry.count++;
+        entry.bytes += nodeBytes + stringBytes + containerBytes;
+        usage.nodeBytes += nodeBytes;
+        usage.stringBytes += stringBytes;
+        usage.containerBytes += containerBytes;
+        usage.slackBytes += slackBytes;
+    }
+
     // JsonValue模版类
+    // 子类不能再加成员, allocSize直接用sizeof(Value)
     template <JsonValueType Tag, typename T>
-    class Value : public JsonValue
+    class Value : public JsonValue, protected HashCacheFor<Tag>
     {
     protected:
         T m_value;
@@ -20,12 +127,84 @@ namespace myJson
             : m_value(value){};
         explicit Value(T &&value)
             : m_value(std::move(value)){};
+        // 带allocator的成员用这个构造
+        template <typename... Args>
+        explicit Value(std::in_place_t, Args &&...args)
+            : m_value(std::forward<Args>(args)...){};
+
+        size_t allocSize() const override
+        {
+            return sizeof(*this);
+        }
+
+        void measure(MemoryUsage &usage) const override
+        {
+            addUsage(usage, type(), allocSize());
+        }
+
+        void shrinkToFit() override
+        {
+        }
 
         JsonValueType type() const override
         {
             return Tag;
         }
 
+        JsonView view() const override
+        {
+            JsonView view;
+            view.type = Tag;
+            if constexpr (std::is_same<T, bool>::value)
+                view.boolean = m_value;
+            else if constexpr (std::is_same<T, int64_t>::value)
+                view.int64 = m_value;
+            else if constexpr (std::is_same<T, uint64_t>::value)
+                view.uint64 = m_value;
+            else if constexpr (std::is_same<T, double>::value)
+                view.number = m_value;
+            else if constexpr (std::is_same<T, jsonstring>::value)
+                view.string = &m_value;
+            else if constexpr (std::is_same<T, array>::value)
+                view.items = &m_value;
+            else if constexpr (std::is_same<T, object>::value)
+                view.members = &m_value;
+            return view;
+        }
+
+        JsonView mutableView() override
+        {
+            this->lendChildren();
+            return view();
+        }
+
+        uint64_t hash() const override
+        {
+            if constexpr (std::is_same<HashCacheFor<Tag>, HashCache>::value)
+            {
+                uint64_t h = this->cachedHashValue();
+                if (h == 0)
+                {
+                    h = computeHash(this);
+                    h = h ? h : 1; // 0留给"还没算"
+                    this->storeHash(h);
+                }
+                return h;
+            }
+            else
+            {
+                return computeHash(this);
+            }
+        }
+
+        uint64_t cachedHash() const override
+        {
+            if constexpr (std::is_same<HashCacheFor<Tag>, HashCache>::value)
+                return this->cachedHashValue();
+            else
+                return 0;
+        }
+
         bool equals(const JsonValue *other) const override
         {
             return m_value == static_cast<const Value<Tag, T> *>(other)->m_value;
@@ -41,12 +220,22 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
+        int64_t getInt64() const override
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+
+        uint64_t getUint64() const override
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+
         bool getBool() const override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        const std::string &getString() const override
+        const jsonstring &getString() const override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -66,7 +255,7 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        Json &operator[](const std::string &key) override
+        Json &operator[](std::string_view key) override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -76,7 +265,7 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        const Json &operator[](const std::string &key) const override
+        const Json &operator[](std::string_view key) const override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -91,7 +280,7 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        void setString(const std::string &value) override
+        void setString(std::string_view value) override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -111,7 +300,12 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        void addToObject(const std::string &key, const Json &value) override
+        void insertToArray(size_t index, const Json &value) override
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+
+        void addToObject(std::string_view key, const Json &value) override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -121,7 +315,7 @@ namespace myJson
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
 
-        void removeFromObject(const std::string &key) override
+        void removeFromObject(std::string_view key) override
         {
             THROW_INVALID_TYPE_EXCEPTION(type());
         }
@@ -175,9 +369,9 @@ namespace myJson
             : Value(NullClass()){};
 
     private:
-        std::unique_ptr<JsonValue> clone() const override
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
         {
-            return std::make_unique<JsonNull>();
+            return makeValue<JsonNull>(resource);
         }
 
         void dump(std::string &str, size_t depth) const override
@@ -185,6 +379,40 @@ namespace myJson
             str += "null";
         }
     };
+    // 数值之间的转换, 超出范围或者不是整数就抛异常
+    int64_t toInt64(double value)
+    {
+        // 2^63是第一个超出int64的double
+        if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0) || std::trunc(value) != value)
+        {
+            throw myJsonException("Number is not representable as int64", 0);
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    uint64_t toUint64(double value)
+    {
+        if (!(value >= 0 && value < 18446744073709551616.0) || std::trunc(value) != value)
+        {
+            throw myJsonException("Number is not representable as uint64", 0);
+        }
+        return static_cast<uint64_t>(value);
+    }
+
+    void dumpInteger(std::string &str, int64_t value)
+    {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        str.append(buf, result.ptr);
+    }
+
+    void dumpInteger(std::string &str, uint64_t value)
+    {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        str.append(buf, result.ptr);
+    }
+
     class JsonNumber : public Value<JsonValueType::NUMBER, double>
     {
     public:
@@ -196,13 +424,21 @@ namespace myJson
         {
             return m_value;
         }
+        int64_t getInt64() const override
+        {
+            return toInt64(m_value);
+        }
+        uint64_t getUint64() const override
+        {
+            return toUint64(m_value);
+        }
         void setNumber(double value) override
         {
             m_value = value;
         }
-        std::unique_ptr<JsonValue> clone() const override
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
         {
-            return std::make_unique<JsonNumber>(m_value);
+            return makeValue<JsonNumber>(resource, m_value);
         }
 
         void dump(std::string &str, size_t depth) const override
@@ -211,760 +447,3192 @@ namespace myJson
         }
     };
 
-    class JsonBool : public Value<JsonValueType::BOOL, bool>
+    class JsonInt64 : public Value<JsonValueType::INT64, int64_t>
     {
     public:
-        explicit JsonBool(bool value)
+        explicit JsonInt64(int64_t value)
             : Value(value){};
 
     private:
-        bool getBool() const override
+        double getNumber() const override
+        {
+            return static_cast<double>(m_value);
+        }
+        int64_t getInt64() const override
         {
             return m_value;
         }
-        void setBool(bool value) override
+        uint64_t getUint64() const override
         {
-            m_value = value;
+            if (m_value < 0)
+            {
+                throw myJsonException("Number is not representable as uint64", 0);
+            }
+            return static_cast<uint64_t>(m_value);
         }
-        std::unique_ptr<JsonValue> clone() const override
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
         {
-            return std::make_unique<JsonBool>(m_value);
+            return makeValue<JsonInt64>(resource, m_value);
         }
+
         void dump(std::string &str, size_t depth) const override
         {
-            str += (m_value ? "true" : "false");
+            dumpInteger(str, m_value);
         }
     };
 
-    class JsonString : public Value<JsonValueType::STRING, std::string>
+    class JsonUint64 : public Value<JsonValueType::UINT64, uint64_t>
     {
     public:
-        explicit JsonString(const std::string &value)
-            : Value(value)
+        explicit JsonUint64(uint64_t value)
+            : Value(value){};
+
+    private:
+        double getNumber() const override
         {
+            return static_cast<double>(m_value);
         }
-        explicit JsonString(std::string &&value)
-            : Value(std::move(value))
+        int64_t getInt64() const override
         {
+            if (m_value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+            {
+                throw myJsonException("Number is not representable as int64", 0);
+            }
+            return static_cast<int64_t>(m_value);
         }
-
-    private:
-        const std::string &getString() const override
+        uint64_t getUint64() const override
         {
             return m_value;
         }
-
-        void setString(const std::string &value) override
-        {
-            m_value = value;
-        }
-        std::unique_ptr<JsonValue> clone() const override
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
         {
-            return std::make_unique<JsonString>(m_value);
+            return makeValue<JsonUint64>(resource, m_value);
         }
+
         void dump(std::string &str, size_t depth) const override
         {
-            str += "\"" + m_value + "\"";
+            dumpInteger(str, m_value);
         }
     };
 
-    class JsonArray : public Value<JsonValueType::ARRAY, array>
+    // 保留原文的数字, 类型按解析出来的值归到NUMBER/INT64/UINT64
+    struct RawNumber
+    {
+        jsonstring text;
+        JsonValueType kind;
+        union
+        {
+            double d;
+            int64_t i;
+            uint64_t u;
+        };
+
+        explicit RawNumber(std::pmr::memory_resource *resource)
+            : text(resource), kind(JsonValueType::NUMBER), u(0) {}
+        RawNumber(const RawNumber &other, std::pmr::memory_resource *resource)
+            : text(other.text, resource), kind(other.kind), u(other.u) {}
+        RawNumber(RawNumber &&other) = default;
+
+        bool operator==(const RawNumber &other) const { return text == other.text; }
+        bool operator<(const RawNumber &other) const { return text < other.text; }
+    };
+
+    class JsonRawNumber : public Value<JsonValueType::NUMBER, RawNumber>
     {
     public:
-        explicit JsonArray(const array &value)
-            : Value(value){};
-        explicit JsonArray(array &&value)
+        JsonRawNumber(const RawNumber &value, std::pmr::memory_resource *resource)
+            : Value(std::in_place, value, resource){};
+        explicit JsonRawNumber(RawNumber &&value)
             : Value(std::move(value)){};
 
-    private:
-        const array &getArray() const override
+        const jsonstring &text() const
         {
-            return m_value;
+            return m_value.text;
         }
 
-        void setArray(const array &value) override
+    private:
+        JsonValueType type() const override
         {
-            m_value = value;
+            return m_value.kind;
         }
-
-        void addToArray(const Json &value) override
+        JsonView view() const override
         {
-            m_value.emplace_back(value);
+            JsonView view;
+            view.type = m_value.kind;
+            if (m_value.kind == JsonValueType::INT64)
+                view.int64 = m_value.i;
+            else if (m_value.kind == JsonValueType::UINT64)
+                view.uint64 = m_value.u;
+            else
+                view.number = m_value.d;
+            return view;
         }
-
-        void removeFromArray(size_t index) override
+        double getNumber() const override
         {
-            if (index < m_value.size())
-            {
-                m_value.erase(m_value.begin() + index);
-            }
-            else
+            switch (m_value.kind)
             {
-                throw myJsonException(std::string(__func__) + "index out of range", 0);
+            case JsonValueType::INT64:
+                return static_cast<double>(m_value.i);
+            case JsonValueType::UINT64:
+                return static_cast<double>(m_value.u);
+            default:
+                return m_value.d;
             }
         }
-
-        Json &operator[](size_t index) override
+        int64_t getInt64() const override
         {
-            if (index < m_value.size())
-            {
-                return m_value[index];
-            }
+            if (m_value.kind == JsonValueType::INT64)
+                return m_value.i;
+            if (m_value.kind == JsonValueType::UINT64 && m_value.u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+                return static_cast<int64_t>(m_value.u);
+            if (m_value.kind == JsonValueType::NUMBER)
+                return toInt64(m_value.d);
+            throw myJsonException("Number is not representable as int64", 0);
+        }
+        uint64_t getUint64() const override
+        {
+            if (m_value.kind == JsonValueType::UINT64)
+                return m_value.u;
+            if (m_value.kind == JsonValueType::INT64 && m_value.i >= 0)
+                return static_cast<uint64_t>(m_value.i);
+            if (m_value.kind == JsonValueType::NUMBER)
+                return toUint64(m_value.d);
+            throw myJsonException("Number is not representable as uint64", 0);
+        }
+        // 和JsonNumber一样变成double, 文本用最短能还原的写法, 整数值没有小数部分
+        void setNumber(double value) override
+        {
+            m_value.kind = JsonValueType::NUMBER;
+            m_value.d = value;
+            if (std::isnan(value))
+                m_value.text = "NaN";
+            else if (std::isinf(value))
+                m_value.text = value > 0 ? "Infinity" : "-Infinity";
             else
             {
-                throw myJsonException(std::string(__func__) + "index out of range", 0);
+                char buf[32];
+                auto result = std::to_chars(buf, buf + sizeof(buf), value);
+                m_value.text.assign(buf, result.ptr);
             }
         }
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
+        {
+            return makeValue<JsonRawNumber>(resource, m_value, resource);
+        }
 
-        const Json &operator[](size_t index) const override
+        void measure(MemoryUsage &usage) const override
         {
-            if (index < m_value.size())
-            {
-                return m_value[index];
-            }
-            else
-            {
-                throw myJsonException(std::string(__func__) + "index out of range", 0);
-            }
+            addUsage(usage, type(), allocSize(), stringHeapBytes(m_value.text), 0, stringSlackBytes(m_value.text));
         }
 
-        std::unique_ptr<JsonValue> clone() const override
+        void shrinkToFit() override
         {
-            return std::make_unique<JsonArray>(m_value);
+            m_value.text.shrink_to_fit();
         }
 
         void dump(std::string &str, size_t depth) const override
         {
-            str += "[";
-            bool first = true;
-            for (const auto &item : m_value)
-            {
-                if (!first)
-                {
-                    str += ", ";
-                }
-                first = false;
-                item.dump(str, depth + 1);
-            }
-            str += "]";
+            str += m_value.text;
         }
-
-        arrayiter arrayBegin() override { return m_value.begin(); }
-        const_arrayiter const_arrayBegin() const override { return m_value.cbegin(); }
-        arrayiter arrayEnd() override { return m_value.end(); }
-        const_arrayiter const_arrayEnd() const override { return m_value.cend(); }
     };
 
-    class JsonObject : public Value<JsonValueType::OBJECT, object>
+    // 数值比较, 不同种类之间按精确值比, 返回-1/0/1
+    int compareDoubleInt64(double d, int64_t i)
+    {
+        if (d != d)
+            return 1; // NaN排最后
+        if (d < -9223372036854775808.0)
+            return -1;
+        if (d >= 9223372036854775808.0)
+            return 1;
+        double t = std::trunc(d);
+        int64_t ti = static_cast<int64_t>(t);
+        if (ti != i)
+            return ti < i ? -1 : 1;
+        return d < t ? -1 : (d > t ? 1 : 0);
+    }
+
+    int compareDoubleUint64(double d, uint64_t u)
+    {
+        if (d != d)
+            return 1;
+        if (d < 0)
+            return -1;
+        if (d >= 18446744073709551616.0)
+            return 1;
+        double t = std::trunc(d);
+        uint64_t tu = static_cast<uint64_t>(t);
+        if (tu != u)
+            return tu < u ? -1 : 1;
+        return d > t ? 1 : 0;
+    }
+
+    int compareNumbers(const JsonValue *a, const JsonValue *b)
+    {
+        JsonValueType ta = a->type(), tb = b->type();
+        if (ta == JsonValueType::NUMBER && tb == JsonValueType::NUMBER)
+        {
+            double x = a->getNumber(), y = b->getNumber();
+            return x < y ? -1 : (y < x ? 1 : 0);
+        }
+        if (ta == JsonValueType::NUMBER)
+        {
+            return tb == JsonValueType::INT64 ? compareDoubleInt64(a->getNumber(), b->getInt64())
+                                              : compareDoubleUint64(a->getNumber(), b->getUint64());
+        }
+        if (tb == JsonValueType::NUMBER)
+        {
+            return -compareNumbers(b, a);
+        }
+        // 都是整数
+        if (ta == JsonValueType::INT64 && tb == JsonValueType::INT64)
+        {
+            int64_t x = a->getInt64(), y = b->getInt64();
+            return x < y ? -1 : (y < x ? 1 : 0);
+        }
+        if (ta == JsonValueType::UINT64 && tb == JsonValueType::UINT64)
+        {
+            uint64_t x = a->getUint64(), y = b->getUint64();
+            return x < y ? -1 : (y < x ? 1 : 0);
+        }
+        if (ta == JsonValueType::INT64) // a是INT64, b是UINT64
+        {
+            int64_t x = a->getInt64();
+            if (x < 0)
+                return -1;
+            uint64_t y = b->getUint64();
+            return static_cast<uint64_t>(x) < y ? -1 : (static_cast<uint64_t>(x) > y ? 1 : 0);
+        }
+        return -compareNumbers(b, a);
+    }
+
+    // 排序时所有数值类型都当成NUMBER
+    JsonValueType orderType(JsonValueType type)
+    {
+        return isNumberType(type) ? JsonValueType::NUMBER : type;
+    }
+
+    class JsonBool : public Value<JsonValueType::BOOL, bool>
     {
     public:
-        explicit JsonObject(const object &value)
+        explicit JsonBool(bool value)
             : Value(value){};
-        explicit JsonObject(object &&value)
-            : Value(std::move(value)){};
 
     private:
-        const object &getObject() const override
+        bool getBool() const override
         {
             return m_value;
         }
-
-        void setObject(const object &value) override
+        void setBool(bool value) override
         {
             m_value = value;
         }
-
-        void addToObject(const std::string &key, const Json &value) override
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
+        {
+            return makeValue<JsonBool>(resource, m_value);
+        }
+        void dump(std::string &str, size_t depth) const override
         {
-            m_value[key] = value;
+            str += (m_value ? "true" : "false");
         }
+    };
 
-        void removeFromObject(const std::string &key) override
+    class JsonString : public Value<JsonValueType::STRING, jsonstring>
+    {
+    public:
+        JsonString(std::string_view value, std::pmr::memory_resource *resource)
+            : Value(std::in_place, value, resource)
+        {
+        }
+        // value必须和节点在同一个resource上
+        explicit JsonString(jsonstring &&value)
+            : Value(std::move(value))
         {
-            auto iter = m_value.find(key);
-            if (iter != m_value.end())
-            {
-                m_value.erase(iter);
-            }
-            else
-            {
-                throw myJsonException(std::string(__func__) + "key[" + key + "] not exists!", 0);
-            }
         }
 
-        Json &operator[](const std::string &key) override
+    private:
+        const jsonstring &getString() const override
         {
-            return m_value[key];
+            return m_value;
         }
 
-        const Json &operator[](const std::string &key) const override
+        void setString(std::string_view value) override
         {
-            auto iter = m_value.find(key);
-            if (iter != m_value.end())
-            {
-                return iter->second;
-            }
-            else
-            {
-                throw myJsonException(std::string(__func__) + "key[" + key + "] not exists!", 0);
-            }
+            invalidateHash();
+            m_value.assign(value.data(), value.size());
+        }
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
+        {
+            return makeValue<JsonString>(resource, m_value, resource);
         }
 
-        std::unique_ptr<JsonValue> clone() const override
+        void measure(MemoryUsage &usage) const override
         {
-            return std::make_unique<JsonObject>(m_value);
+            addUsage(usage, type(), allocSize(), stringHeapBytes(m_value), 0, stringSlackBytes(m_value));
         }
 
-        void dump(std::string &str, size_t depth) const override
+        void shrinkToFit() override
         {
-            bool first = true;
+            m_value.shrink_to_fit();
+        }
+        void dump(std::string &str, size_t depth) const override
+        {
+            str += "\"" + m_value + "\"";
+        }
+    };
+
+    void DumpFormat::beginArray(std::string &str, size_t)
+    {
+        str += "[";
+    }
+
+    void DumpFormat::arrayItem(std::string &str, size_t index, size_t)
+    {
+        if (index)
+            str += ", ";
+    }
+
+    void DumpFormat::endArray(std::string &str, size_t, size_t)
+    {
+        str += "]";
+    }
+
+    // 对象的开头跟着第一个成员输出, 空对象只有结尾
+    void DumpFormat::beginObject(std::string &, size_t)
+    {
+    }
+
+    void DumpFormat::objectMember(std::string &str, size_t index, const jsonstring &key, size_t depth)
+    {
+        if (index)
+        {
+            str += ",\n";
+            str.append(depth, '\t');
+        }
+        else
+        {
+            str += "{\n";
+        }
+        str += key;
+        str += " : ";
+    }
+
+    void DumpFormat::endObject(std::string &str, size_t, size_t)
+    {
+        str += "\n}";
+    }
+
+    class JsonArray : public Value<JsonValueType::ARRAY, array>
+    {
+    public:
+        JsonArray(const array &value, std::pmr::memory_resource *resource)
+            : Value(std::in_place, value, resource){};
+        // value必须和节点在同一个resource上
+        explicit JsonArray(array &&value)
+            : Value(std::move(value)){};
+
+    private:
+        const array &getArray() const override
+        {
+            return m_value;
+        }
+
+        void setArray(const array &value) override
+        {
+            invalidateHash();
+            m_value = value;
+        }
+
+        void addToArray(const Json &value) override
+        {
+            invalidateHash();
+            m_value.emplace_back(value);
+        }
+
+        void insertToArray(size_t index, const Json &value) override
+        {
+            invalidateHash();
+            if (index <= m_value.size())
+            {
+                m_value.emplace(m_value.begin() + index, value);
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "index out of range", 0);
+            }
+        }
+
+        void removeFromArray(size_t index) override
+        {
+            invalidateHash();
+            if (index < m_value.size())
+            {
+                m_value.erase(m_value.begin() + index);
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "index out of range", 0);
+            }
+        }
+
+        Json &operator[](size_t index) override
+        {
+            lendChildren(); // 拿到引用就可能被改
+            if (index < m_value.size())
+            {
+                return m_value[index];
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "index out of range", 0);
+            }
+        }
+
+        const Json &operator[](size_t index) const override
+        {
+            if (index < m_value.size())
+            {
+                return m_value[index];
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "index out of range", 0);
+            }
+        }
+
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
+        {
+            return makeValue<JsonArray>(resource, m_value, resource);
+        }
+
+        void measure(MemoryUsage &usage) const override
+        {
+            addUsage(usage, type(), allocSize(), 0, m_value.capacity() * sizeof(Json), (m_value.capacity() - m_value.size()) * sizeof(Json));
+        }
+
+        void shrinkToFit() override
+        {
+            m_value.shrink_to_fit();
+            for (Json &item : m_value)
+                item.shrink_to_fit();
+        }
+
+        void dump(std::string &str, size_t depth) const override
+        {
+            DumpFormat::beginArray(str, depth);
+            for (size_t i = 0; i < m_value.size(); i++)
+            {
+                DumpFormat::arrayItem(str, i, depth);
+                m_value[i].dump(str, depth + 1);
+            }
+            DumpFormat::endArray(str, m_value.size(), depth);
+        }
+
+        arrayiter arrayBegin() override
+        {
+            lendChildren();
+            return m_value.begin();
+        }
+        const_arrayiter const_arrayBegin() const override { return m_value.cbegin(); }
+        arrayiter arrayEnd() override
+        {
+            lendChildren();
+            return m_value.end();
+        }
+        const_arrayiter const_arrayEnd() const override { return m_value.cend(); }
+    };
+
+    class JsonObject : public Value<JsonValueType::OBJECT, object>
+    {
+    public:
+        JsonObject(const object &value, std::pmr::memory_resource *resource)
+            : Value(std::in_place, value, resource){};
+        // value必须和节点在同一个resource上
+        explicit JsonObject(object &&value)
+            : Value(std::move(value)){};
+
+    private:
+        const object &getObject() const override
+        {
+            return m_value;
+        }
+
+        void setObject(const object &value) override
+        {
+            invalidateHash();
+            m_value = value;
+        }
+
+        void addToObject(std::string_view key, const Json &value) override
+        {
+            (*this)[key] = value;
+        }
+
+        void removeFromObject(std::string_view key) override
+        {
+            invalidateHash();
+            auto iter = m_value.find(key);
+            if (iter != m_value.end())
+            {
+                m_value.erase(iter);
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "key[" + std::string(key) + "] not exists!", 0);
+            }
+        }
+
+        Json &operator[](std::string_view key) override
+        {
+            lendChildren(); // 拿到引用就可能被改
+            // map::operator[]不支持异构查找, 先find, 没有再插入
+            auto iter = m_value.lower_bound(key);
+            if (iter == m_value.end() || iter->first != key)
+            {
+                iter = m_value.emplace_hint(iter, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+            }
+            return iter->second;
+        }
+
+        const Json &operator[](std::string_view key) const override
+        {
+            auto iter = m_value.find(key);
+            if (iter != m_value.end())
+            {
+                return iter->second;
+            }
+            else
+            {
+                throw myJsonException(std::string(__func__) + "key[" + std::string(key) + "] not exists!", 0);
+            }
+        }
+
+        JsonValuePtr clone(std::pmr::memory_resource *resource) const override
+        {
+            return makeValue<JsonObject>(resource, m_value, resource);
+        }
+
+        // map的节点: 红黑树的头(颜色 + 3个指针) + pair<key, Json>, key超过SSO的部分另算
+        void measure(MemoryUsage &usage) const override
+        {
+            const size_t nodeBytes = 4 * sizeof(void *) + sizeof(object::value_type);
+            size_t keyBytes = 0, keySlack = 0;
+            for (const auto &member : m_value)
+            {
+                keyBytes += stringHeapBytes(member.first);
+                keySlack += stringSlackBytes(member.first);
+            }
+            addUsage(usage, type(), allocSize(), keyBytes, m_value.size() * nodeBytes, keySlack);
+        }
+
+        // key是const的, 没法单独收缩, 拷贝的时候才会去掉
+        void shrinkToFit() override
+        {
+            for (auto &member : m_value)
+                member.second.shrink_to_fit();
+        }
+
+        void dump(std::string &str, size_t depth) const override
+        {
+            DumpFormat::beginObject(str, depth);
+            size_t index = 0;
             for (const auto &item : m_value)
             {
+                DumpFormat::objectMember(str, index++, item.first, depth);
+                item.second.dump(str, depth + 1);
+            }
+            DumpFormat::endObject(str, m_value.size(), depth);
+        }
+
+        objectiter objectBegin() override
+        {
+            lendChildren();
+            return m_value.begin();
+        }
+        const_objectiter const_objectBegin() const override { return m_value.cbegin(); }
+        objectiter objectEnd() override
+        {
+            lendChildren();
+            return m_value.end();
+        }
+        const_objectiter const_objectEnd() const override { return m_value.cend(); }
+    };
+
+    // 子类没有额外成员, Value::allocSize才是对的
+    static_assert(sizeof(JsonNull) == sizeof(Value<JsonValueType::NUL, NullClass>), "JsonNull must not add members");
+    static_assert(sizeof(JsonNumber) == sizeof(Value<JsonValueType::NUMBER, double>), "JsonNumber must not add members");
+    static_assert(sizeof(JsonInt64) == sizeof(Value<JsonValueType::INT64, int64_t>), "JsonInt64 must not add members");
+    static_assert(sizeof(JsonUint64) == sizeof(Value<JsonValueType::UINT64, uint64_t>), "JsonUint64 must not add members");
+    static_assert(sizeof(JsonRawNumber) == sizeof(Value<JsonValueType::NUMBER, RawNumber>), "JsonRawNumber must not add members");
+    static_assert(sizeof(JsonBool) == sizeof(Value<JsonValueType::BOOL, bool>), "JsonBool must not add members");
+    static_assert(sizeof(JsonString) == sizeof(Value<JsonValueType::STRING, jsonstring>), "JsonString must not add members");
+    static_assert(sizeof(JsonArray) == sizeof(Value<JsonValueType::ARRAY, array>), "JsonArray must not add members");
+    static_assert(sizeof(JsonObject) == sizeof(Value<JsonValueType::OBJECT, object>), "JsonObject must not add members");
+
+    ///////////////hash//////////////////////
+    // XXH64, 不带随机种子, 同样的内容在不同进程/机器上hash一样
+    const uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t XXH_PRIME3 = 0x165667B19E3779F9ULL;
+    const uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotl64(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // 按小端读
+    inline uint64_t readLE64(const unsigned char *p)
+    {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline uint32_t readLE32(const unsigned char *p)
+    {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+    {
+        acc += input * XXH_PRIME2;
+        acc = rotl64(acc, 31);
+        return acc * XXH_PRIME1;
+    }
+
+    inline uint64_t xxhMerge(uint64_t acc, uint64_t val)
+    {
+        acc ^= xxhRound(0, val);
+        return acc * XXH_PRIME1 + XXH_PRIME4;
+    }
+
+    uint64_t xxh64(const void *data, size_t length, uint64_t seed)
+    {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        const unsigned char *end = p + length;
+        uint64_t h;
+        if (length >= 32)
+        {
+            uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+            uint64_t v2 = seed + XXH_PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - XXH_PRIME1;
+            do
+            {
+                v1 = xxhRound(v1, readLE64(p));
+                v2 = xxhRound(v2, readLE64(p + 8));
+                v3 = xxhRound(v3, readLE64(p + 16));
+                v4 = xxhRound(v4, readLE64(p + 24));
+                p += 32;
+            } while (end - p >= 32);
+            h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+            h = xxhMerge(h, v1);
+            h = xxhMerge(h, v2);
+            h = xxhMerge(h, v3);
+            h = xxhMerge(h, v4);
+        }
+        else
+        {
+            h = seed + XXH_PRIME5;
+        }
+        h += static_cast<uint64_t>(length);
+        while (end - p >= 8)
+        {
+            h ^= xxhRound(0, readLE64(p));
+            h = rotl64(h, 27) * XXH_PRIME1 + XXH_PRIME4;
+            p += 8;
+        }
+        if (end - p >= 4)
+        {
+            h ^= static_cast<uint64_t>(readLE32(p)) * XXH_PRIME1;
+            h = rotl64(h, 23) * XXH_PRIME2 + XXH_PRIME3;
+            p += 4;
+        }
+        while (p < end)
+        {
+            h ^= (*p) * XXH_PRIME5;
+            h = rotl64(h, 11) * XXH_PRIME1;
+            p++;
+        }
+        h ^= h >> 33;
+        h *= XXH_PRIME2;
+        h ^= h >> 29;
+        h *= XXH_PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // 把几个64位的值拼起来再hash, 用不同的种子区分类型
+    inline uint64_t hashWords(uint64_t seed, uint64_t a, uint64_t b = 0)
+    {
+        unsigned char buf[16];
+        for (int i = 0; i < 8; i++)
+        {
+            buf[i] = static_cast<unsigned char>(a >> (8 * i));
+            buf[8 + i] = static_cast<unsigned char>(b >> (8 * i));
+        }
+        return xxh64(buf, sizeof(buf), seed);
+    }
+
+    enum HashSeed : uint64_t
+    {
+        HASH_NULL = 1,
+        HASH_FALSE,
+        HASH_TRUE,
+        HASH_NONNEGATIVE, // 非负整数
+        HASH_NEGATIVE,    // 负整数
+        HASH_DOUBLE,      // 不是整数的double
+        HASH_STRING,
+        HASH_ARRAY,
+        HASH_OBJECT
+    };
+
+    // 数字按数值hash, 和compareNumbers一致: 1, 1.0, UINT64的1 hash都一样
+    uint64_t hashNumber(const JsonValue *value)
+    {
+        switch (value->type())
+        {
+        case JsonValueType::INT64:
+        {
+            int64_t i = value->getInt64();
+            return i < 0 ? hashWords(HASH_NEGATIVE, static_cast<uint64_t>(i)) : hashWords(HASH_NONNEGATIVE, static_cast<uint64_t>(i));
+        }
+        case JsonValueType::UINT64:
+            return hashWords(HASH_NONNEGATIVE, value->getUint64());
+        default:
+            break;
+        }
+        double d = value->getNumber();
+        // 整数值的double按整数算, 范围是[-2^63, 2^64)
+        if (d == std::floor(d) && d >= -9223372036854775808.0 && d < 18446744073709551616.0)
+        {
+            if (d < 0)
+                return hashWords(HASH_NEGATIVE, static_cast<uint64_t>(static_cast<int64_t>(d)));
+            return hashWords(HASH_NONNEGATIVE, static_cast<uint64_t>(d));
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return hashWords(HASH_DOUBLE, bits);
+    }
+
+    uint64_t computeHash(const JsonValue *value)
+    {
+        switch (value->type())
+        {
+        case JsonValueType::NUL:
+            return hashWords(HASH_NULL, 0);
+        case JsonValueType::BOOL:
+            return hashWords(value->getBool() ? HASH_TRUE : HASH_FALSE, 0);
+        case JsonValueType::NUMBER:
+        case JsonValueType::INT64:
+        case JsonValueType::UINT64:
+            return hashNumber(value);
+        case JsonValueType::STRING:
+        {
+            const jsonstring &str = value->getString();
+            return xxh64(str.data(), str.size(), HASH_STRING);
+        }
+        case JsonValueType::ARRAY:
+        {
+            // 按顺序把子节点的hash串起来
+            const array &items = value->getArray();
+            uint64_t h = hashWords(HASH_ARRAY, items.size());
+            for (const auto &item : items)
+                h = hashWords(h, item.hash());
+            return h;
+        }
+        case JsonValueType::OBJECT:
+        {
+            // map是按key排好序的, 顺序是确定的
+            const object &members = value->getObject();
+            uint64_t h = hashWords(HASH_OBJECT, members.size());
+            for (const auto &member : members)
+                h = hashWords(h, xxh64(member.first.data(), member.first.size(), HASH_STRING), member.second.hash());
+            return h;
+        }
+        }
+        return 0;
+    }
+
+    std::pmr::memory_resource *defaultResource()
+    {
+        return std::pmr::get_default_resource();
+    }
+
+    ///////////////stats//////////////////////
+#ifdef MYJSON_ENABLE_STATS
+    // 当前线程上的统计, 没有StatsScope时是nullptr
+    thread_local JsonStats *t_stats = nullptr;
+
+    StatsScope::StatsScope(JsonStats &stats)
+        : m_previous(t_stats)
+    {
+        t_stats = &stats;
+    }
+
+    StatsScope::~StatsScope()
+    {
+        t_stats = m_previous;
+    }
+
+#define MYJSON_STAT(expr) \
+    do                    \
+    {                     \
+        if (t_stats)      \
+        {                 \
+            t_stats->expr;  \
+        }                 \
+    } while (0)
+#define MYJSON_STAGE_TIMER(field) StageTimer stageTimer_(t_stats ? &t_stats->field : nullptr)
+
+    // 作用域结束时把耗时加到slot上
+    class StageTimer
+    {
+    public:
+        explicit StageTimer(uint64_t *slot)
+            : m_slot(slot)
+        {
+            if (m_slot)
+                m_begin = std::chrono::steady_clock::now();
+        }
+        ~StageTimer()
+        {
+            if (m_slot)
+                *m_slot += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_begin).count();
+        }
+
+    private:
+        uint64_t *m_slot;
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+    // 转发给new_delete_resource, 当前线程有统计时计数
+    // 和new_delete_resource比较相等, 解析出的节点可以直接移给用默认resource的Json
+    class StatsResource : public std::pmr::memory_resource
+    {
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            MYJSON_STAT(allocations++);
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other || &other == std::pmr::new_delete_resource();
+        }
+    };
+
+    std::pmr::memory_resource *statsResource()
+    {
+        static StatsResource resource;
+        return &resource;
+    }
+
+#else
+#define MYJSON_STAT(expr) ((void)0)
+#define MYJSON_STAGE_TIMER(field) ((void)0)
+#endif
+
+    ///////////////json//////////////////////
+    Json::Json() noexcept
+        : m_ptr(makeValue<JsonNull>(defaultResource())) {}
+    Json::Json(const allocator_type &alloc)
+        : m_ptr(makeValue<JsonNull>(alloc.resource())) {}
+    Json::Json(std::nullptr_t) noexcept
+        : m_ptr(makeValue<JsonNull>(defaultResource())) {}
+    Json::Json(double value)
+        : m_ptr(makeValue<JsonNumber>(defaultResource(), value)) {}
+    Json::Json(bool value)
+        : m_ptr(makeValue<JsonBool>(defaultResource(), value)) {}
+    Json::Json(const std::string &value)
+        : m_ptr(makeValue<JsonString>(defaultResource(), value, defaultResource())) {}
+    Json::Json(std::string &&value)
+        : m_ptr(makeValue<JsonString>(defaultResource(), value, defaultResource())) {}
+    Json::Json(const jsonstring &value)
+        : m_ptr(makeValue<JsonString>(defaultResource(), value, defaultResource())) {}
+    Json::Json(jsonstring &&value) // 节点和value放在同一个resource上, 直接move
+        : m_ptr(makeValue<JsonString>(value.get_allocator().resource(), std::move(value))) {}
+    Json::Json(const char *value)
+        : m_ptr(makeValue<JsonString>(defaultResource(), value, defaultResource())) {}
+    Json::Json(const array &value)
+        : m_ptr(makeValue<JsonArray>(defaultResource(), value, defaultResource())) {}
+    Json::Json(array &&value)
+        : m_ptr(makeValue<JsonArray>(value.get_allocator().resource(), std::move(value))) {}
+    Json::Json(const object &value)
+        : m_ptr(makeValue<JsonObject>(defaultResource(), value, defaultResource())) {}
+    Json::Json(object &&value)
+        : m_ptr(makeValue<JsonObject>(value.get_allocator().resource(), std::move(value))) {}
+
+    Json::Json(JsonValuePtr value) noexcept
+        : m_ptr(std::move(value)) {}
+
+    Json::Json(const Json &other)
+        : m_ptr(other.m_ptr ? other.m_ptr->clone(defaultResource()) : makeValue<JsonNull>(defaultResource())) {}
+    Json::Json(Json &&other) noexcept
+        : m_ptr(std::move(other.m_ptr)) {}
+
+    Json::Json(const Json &other, const allocator_type &alloc)
+        : m_ptr(other.m_ptr ? other.m_ptr->clone(alloc.resource()) : makeValue<JsonNull>(alloc.resource())) {}
+    Json::Json(Json &&other, const allocator_type &alloc)
+    {
+        if (other.m_ptr && *other.resource() == *alloc.resource())
+        {
+            m_ptr = std::move(other.m_ptr);
+        }
+        else
+        {
+            m_ptr = other.m_ptr ? other.m_ptr->clone(alloc.resource()) : makeValue<JsonNull>(alloc.resource());
+        }
+    }
+
+    Json::~Json() noexcept {}
+
+    JsonValuePtr Json::makeInt64(int64_t value)
+    {
+        return makeValue<JsonInt64>(defaultResource(), value);
+    }
+
+    JsonValuePtr Json::makeUint64(uint64_t value)
+    {
+        return makeValue<JsonUint64>(defaultResource(), value);
+    }
+
+    Json::allocator_type Json::get_allocator() const
+    {
+        return allocator_type(resource());
+    }
+
+    std::pmr::memory_resource *Json::resource() const
+    {
+        // move走之后删除器还留着原来的resource
+        std::pmr::memory_resource *own = m_ptr.get_deleter().resource;
+        return own ? own : defaultResource();
+    }
+
+    JsonValueType Json::type() const
+    {
+        check();
+        return m_ptr->type();
+    }
+
+    bool Json::is_null() const
+    {
+        check();
+        return m_ptr->type() == JsonValueType::NUL;
+    }
+
+    bool Json::is_number() const
+    {
+        check();
+        return isNumberType(m_ptr->type());
+    }
+
+    bool Json::is_integer() const
+    {
+        check();
+        JsonValueType type = m_ptr->type();
+        return type == JsonValueType::INT64 || type == JsonValueType::UINT64;
+    }
+
+    bool Json::is_bool() const
+    {
+        check();
+        return m_ptr->type() == JsonValueType::BOOL;
+    }
+
+    bool Json::is_string() const
+    {
+        check();
+        return m_ptr->type() == JsonValueType::STRING;
+    }
+
+    bool Json::is_array() const
+    {
+        check();
+        return m_ptr->type() == JsonValueType::ARRAY;
+    }
+
+    bool Json::is_object() const
+    {
+        check();
+        return m_ptr->type() == JsonValueType::OBJECT;
+    }
+
+    double Json::getNumber() const
+    {
+        check();
+        return m_ptr->getNumber();
+    }
+
+    int64_t Json::getInt64() const
+    {
+        check();
+        return m_ptr->getInt64();
+    }
+
+    uint64_t Json::getUint64() const
+    {
+        check();
+        return m_ptr->getUint64();
+    }
+
+    std::string Json::getNumberText() const
+    {
+        check();
+        if (!is_number())
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        std::string str;
+        m_ptr->dump(str, 0);
+        return str;
+    }
+
+    bool Json::getBool() const
+    {
+        check();
+        return m_ptr->getBool();
+    }
+
+    const jsonstring &Json::getString() const
+    {
+        check();
+        return m_ptr->getString();
+    };
+
+    const array &Json::getArray() const
+    {
+        check();
+        return m_ptr->getArray();
+    };
+
+    const object &Json::getObject() const
+    {
+        check();
+        return m_ptr->getObject();
+    };
+
+    void Json::setNumber(double value)
+    {
+        check();
+        JsonValueType type = m_ptr->type();
+        if ((type == JsonValueType::INT64 || type == JsonValueType::UINT64) && !dynamic_cast<JsonRawNumber *>(m_ptr.get()))
+        {
+            // 整数直接换成double, 保留原文的数字自己处理
+            m_ptr = makeValue<JsonNumber>(resource(), value);
+            return;
+        }
+        m_ptr->setNumber(value);
+    }
+
+    void Json::setBool(double value)
+    {
+        check();
+        m_ptr->setBool(value);
+    }
+
+    void Json::setString(std::string_view value)
+    {
+        check();
+        m_ptr->setString(value);
+    }
+
+    void Json::setArray(const array &value)
+    {
+        check();
+        m_ptr->setArray(value);
+    }
+
+    void Json::setObject(const object &value)
+    {
+        check();
+        m_ptr->setObject(value);
+    }
+
+    void Json::addToArray(const Json &value)
+    {
+        check();
+        m_ptr->addToArray(value);
+    }
+
+    void Json::insertToArray(size_t index, const Json &value)
+    {
+        check();
+        m_ptr->insertToArray(index, value);
+    }
+
+    void Json::addToObject(std::string_view key, const Json &value)
+    {
+        check();
+        m_ptr->addToObject(key, value);
+    }
+
+    void Json::removeFromArray(size_t index)
+    {
+        check();
+        m_ptr->removeFromArray(index);
+    }
+
+    void Json::removeFromObject(std::string_view key)
+    {
+        check();
+        m_ptr->removeFromObject(key);
+    }
+
+    Json &Json::operator[](size_t index)
+    {
+        return (*m_ptr)[index];
+    }
+
+    Json &Json::operator[](std::string_view key)
+    {
+        return (*m_ptr)[key];
+    }
+
+    const Json &Json::operator[](size_t index) const
+    {
+        return (*m_ptr)[index];
+    }
+
+    const Json &Json::operator[](std::string_view key) const
+    {
+        return (*m_ptr)[key];
+    }
+
+    Json &Json::operator=(const Json &other)
+    {
+        if (this != &other) // 防止自赋值
+        {
+            std::pmr::memory_resource *own = resource();
+            m_ptr = other.m_ptr ? other.m_ptr->clone(own) : makeValue<JsonNull>(own);
+        }
+        return *this;
+    }
+
+    Json &Json::operator=(Json &&other)
+    {
+        if (this != &other) // 防止自赋值
+        {
+            std::pmr::memory_resource *own = resource();
+            if (!other.m_ptr || *other.resource() == *own)
+            {
+                m_ptr = std::move(other.m_ptr);
+            }
+            else
+            {
+                // 不同resource之间不能直接接管节点, 拷贝到自己的resource上
+                m_ptr = other.m_ptr->clone(own);
+            }
+        }
+        return *this;
+    }
+
+    uint64_t Json::hash() const
+    {
+        check();
+        return m_ptr->hash();
+    }
+
+    bool Json::operator==(const Json &other) const
+    {
+        check();
+        if (m_ptr == other.m_ptr)
+            return true;
+        // 两边都缓存了hash时, 不一样就不用往下比了
+        uint64_t hash = m_ptr->cachedHash();
+        uint64_t otherHash = hash ? other.m_ptr->cachedHash() : 0;
+        if (hash && otherHash && hash != otherHash)
+            return false;
+        else if (is_number() && other.is_number())
+            return compareNumbers(m_ptr.get(), other.m_ptr.get()) == 0;
+        else if (type() != other.type())
+            return false;
+        else
+            return m_ptr->equals(other.m_ptr.get());
+    }
+
+    bool Json::operator<(const Json &other) const
+    {
+        check();
+        if (m_ptr == other.m_ptr)
+            return false;
+        else if (is_number() && other.is_number())
+            return compareNumbers(m_ptr.get(), other.m_ptr.get()) < 0;
+        else if (orderType(m_ptr->type()) != orderType(other.m_ptr->type()))
+            return orderType(m_ptr->type()) < orderType(other.m_ptr->type());
+        else
+            return m_ptr->less(other.m_ptr.get());
+    }
+
+    const std::string Json::dump() const
+    {
+        std::string str;
+#ifdef MYJSON_ENABLE_STATS
+        if (t_stats)
+        {
+            MYJSON_STAGE_TIMER(dumpNanos);
+            dump(str, 0);
+            t_stats->dumps++;
+            t_stats->dumpBytes += str.size();
+            return str;
+        }
+#endif
+        dump(str, 0);
+        return str;
+    }
+
+    void Json::dump(std::string &str, size_t depth) const
+    {
+        check();
+        m_ptr->dump(str, depth);
+    }
+
+    MemoryUsage Json::memoryUsage() const
+    {
+        MemoryUsage usage;
+        // 用显式的栈, 很深的树也不会爆栈
+        std::vector<const Json *> stack{this};
+        while (!stack.empty())
+        {
+            const Json *json = stack.back();
+            stack.pop_back();
+            if (!json->m_ptr)
+                continue;
+            json->m_ptr->measure(usage);
+            if (json->m_ptr->type() == JsonValueType::ARRAY)
+            {
+                for (const Json &item : json->m_ptr->getArray())
+                    stack.push_back(&item);
+            }
+            else if (json->m_ptr->type() == JsonValueType::OBJECT)
+            {
+                for (const auto &member : json->m_ptr->getObject())
+                    stack.push_back(&member.second);
+            }
+        }
+        return usage;
+    }
+
+    void Json::shrink_to_fit()
+    {
+        check();
+        m_ptr->shrinkToFit();
+    }
+
+    void Json::compact()
+    {
+        compact(resource());
+    }
+
+    void Json::compact(std::pmr::memory_resource *resource)
+    {
+        check();
+        m_ptr = m_ptr->clone(resource);
+    }
+
+    arrayiter Json::arrayBegin()
+    {
+        check();
+        return m_ptr->arrayBegin();
+    }
+
+    const_arrayiter Json::const_arrayBegin() const
+    {
+        check();
+        return m_ptr->const_arrayBegin();
+    }
+
+    arrayiter Json::arrayEnd()
+    {
+        check();
+        return m_ptr->arrayEnd();
+    }
+
+    const_arrayiter Json::const_arrayEnd() const
+    {
+        check();
+        return m_ptr->const_arrayEnd();
+    }
+
+    objectiter Json::objectBegin()
+    {
+        check();
+        return m_ptr->objectBegin();
+    }
+
+    const_objectiter Json::const_objectBegin() const
+    {
+        check();
+        return m_ptr->const_objectBegin();
+    }
+
+    objectiter Json::objectEnd()
+    {
+        check();
+        return m_ptr->objectEnd();
+    }
+
+    const_objectiter Json::const_objectEnd() const
+    {
+        check();
+        return m_ptr->const_objectEnd();
+    }
+
+    const char *ParseError::message() const
+    {
+        switch (code)
+        {
+        case ParseErrorCode::NONE:
+            return "no error";
+        case ParseErrorCode::UNEXPECTED_END:
+            return "unexpected end of input";
+        case ParseErrorCode::INVALID_LITERAL:
+            return "invalid literal, expected null/true/false";
+        case ParseErrorCode::INVALID_ESCAPE:
+            return "invalid escape sequence in string";
+        case ParseErrorCode::INVALID_NUMBER:
+            return "invalid number format";
+        case ParseErrorCode::NUMBER_OUT_OF_RANGE:
+            return "number out of range";
+        case ParseErrorCode::EXPECTED_KEY:
+            return "expected string key in object";
+        case ParseErrorCode::EXPECTED_COLON:
+            return "expected ':' after object key";
+        case ParseErrorCode::EXPECTED_ARRAY_END:
+            return "expected ',' or ']' in array";
+        case ParseErrorCode::EXPECTED_OBJECT_END:
+            return "expected ',' or '}' in object";
+        case ParseErrorCode::DEPTH_EXCEEDED:
+            return "exceeded maximum nesting depth";
+        case ParseErrorCode::INPUT_TOO_LARGE:
+            return "input exceeds maxInputBytes";
+        case ParseErrorCode::TOO_MANY_NODES:
+            return "document exceeds maxNodes";
+        case ParseErrorCode::STRING_TOO_LONG:
+            return "string exceeds maxStringLength";
+        case ParseErrorCode::TOO_MANY_MEMBERS:
+            return "object exceeds maxObjectMembers";
+        case ParseErrorCode::MEMORY_BUDGET_EXCEEDED:
+            return "document exceeds memoryBudget";
+        case ParseErrorCode::HANDLER_ABORTED:
+            return "stopped by handler";
+        case ParseErrorCode::INVALID_CHARACTER:
+            return "unescaped control character in string";
+        case ParseErrorCode::TRAILING_CONTENT:
+            return "unexpected content after the root value";
+        case ParseErrorCode::DUPLICATE_KEY:
+            return "duplicate key in object";
+        case ParseErrorCode::INVALID_COMMENT:
+            return "invalid comment, expected // or /*";
+        }
+        return "unknown error";
+    }
+
+    // 解析栈上的一层: 还没结束的数组或对象
+    // 出错时从栈底往上拼出路径
+    struct ParseFrame
+    {
+        bool isObject;
+        bool hasKey;  // 对象: key和冒号都解析完了, 正在解析value
+        size_t index; // 数组: 正在解析的下标
+    };
+
+    // 还没结束的对象正在解析的成员的key
+    struct PendingObject
+    {
+        explicit PendingObject(std::pmr::memory_resource *resource) : key(resource) {}
+
+        jsonstring key;
+    };
+
+    // 对象的成员先按出现的顺序收集, 对象结束时一次建成map, 不再每个成员做一次树的插入
+    // - 所有还没结束的对象共用一个vector, 每个对象占末尾的一段, 结束时截掉
+    // - 收集时顺便看key是不是严格升序(很多序列化器就是排好序写的), 是的话直接用emplace_hint接在map最后, 每个O(1)
+    // - 否则stable_sort一次, 相同的key挨在一起并保持原来的先后, 按DuplicateKeys留一个
+    class MemberCollector
+    {
+    public:
+        void open() { m_frames.push_back({m_members.size(), true}); }
 
-                if (!first)
+        void add(jsonstring &&key, Json &&value)
+        {
+            Frame &frame = m_frames.back();
+            if (frame.sorted && m_members.size() > frame.begin && !KeyLess()(m_members.back().first, key))
+                frame.sorted = false;
+            m_members.emplace_back(std::move(key), std::move(value));
+        }
+
+        // 栈顶对象已经有的成员数(重复的也算)
+        size_t count() const { return m_members.size() - m_frames.back().begin; }
+
+        // 栈顶对象结束, 成员移进out; REJECT遇到重复的key时返回false, key放在duplicate里
+        bool close(object &out, DuplicateKeys policy, jsonstring &duplicate)
+        {
+            Frame frame = m_frames.back();
+            m_frames.pop_back();
+            auto first = m_members.begin() + frame.begin;
+            auto last = m_members.end();
+            if (!frame.sorted)
+            {
+                std::stable_sort(first, last, [](const Member &lhs, const Member &rhs)
+                                 { return KeyLess()(lhs.first, rhs.first); });
+            }
+            bool ok = true;
+            for (auto iter = first; iter != last;)
+            {
+                auto next = iter + 1;
+                while (!frame.sorted && next != last && next->first == iter->first)
+                    next++;
+                if (next - iter > 1)
                 {
-                    str += ",\n";
-                    for (size_t i = 0; i < depth; i++)
+                    if (policy == DuplicateKeys::REJECT)
                     {
-                        str += '\t';
+                        duplicate = std::move(iter->first);
+                        ok = false;
+                        break;
                     }
+                    if (policy == DuplicateKeys::LAST)
+                        iter = next - 1;
+                }
+                out.emplace_hint(out.end(), std::move(iter->first), std::move(iter->second));
+                iter = next;
+            }
+            m_members.erase(first, last);
+            return ok;
+        }
+
+        void clear()
+        {
+            m_members.clear();
+            m_frames.clear();
+        }
+
+    private:
+        using Member = std::pair<jsonstring, Json>;
+
+        struct Frame
+        {
+            size_t begin;
+            bool sorted; // 目前为止key严格升序
+        };
+
+        std::vector<Member> m_members;
+        std::vector<Frame> m_frames;
+    };
+
+    // 数组和对象分开放, 每层只构造用得到的那个容器
+    struct ParseStack
+    {
+        std::vector<ParseFrame> frames;
+        std::vector<array> arrays;
+        std::vector<PendingObject> objects;
+        MemberCollector members; // 只有建树的parse用, SAX和流式只需要key
+
+        size_t size() const { return frames.size(); }
+        bool empty() const { return frames.empty(); }
+        void clear()
+        {
+            frames.clear();
+            arrays.clear();
+            objects.clear();
+            members.clear();
+        }
+    };
+
+    // 解析时的上下文
+    struct ParseContext
+    {
+        const ParseOptions &options;
+        std::pmr::memory_resource *resource;
+        ParseError &error;
+        ParseStack &stack;
+        size_t nodes = 0; // 已经解析出的节点数
+        size_t bytes = 0; // 估算的内存
+    };
+
+    // 往定长buffer里写, 写不下就截断成...
+    class PathWriter
+    {
+    public:
+        explicit PathWriter(char (&buffer)[ParseError::PATH_CAPACITY])
+            : m_pos(buffer), m_end(buffer + ParseError::PATH_CAPACITY - 1) {}
+        ~PathWriter() { *m_pos = '\0'; }
+
+        void put(const char *text, size_t length)
+        {
+            if (m_truncated)
+                return;
+            size_t room = static_cast<size_t>(m_end - m_pos);
+            if (length > room)
+            {
+                // 能放多少放多少, 最后留3个字节给...
+                if (room >= 3)
+                {
+                    std::memcpy(m_pos, text, room - 3);
+                    m_pos += room - 3;
                 }
                 else
                 {
-                    str += "{\n";
+                    m_pos = m_end - 3;
                 }
-                first = false;
-                str += item.first + " : ";
-                item.second.dump(str, depth + 1);
+                std::memcpy(m_pos, "...", 3);
+                m_pos += 3;
+                m_truncated = true;
+                return;
+            }
+            std::memcpy(m_pos, text, length);
+            m_pos += length;
+        }
+
+        void put(const char *text) { put(text, std::strlen(text)); }
+
+        void putIndex(size_t index)
+        {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), index);
+            put(digits, static_cast<size_t>(result.ptr - digits));
+        }
+
+    private:
+        char *m_pos;
+        char *m_end;
+        bool m_truncated = false;
+    };
+
+    // 从栈底往上写
+    void writePath(PathWriter &writer, const ParseStack &stack)
+    {
+        writer.put("$", 1);
+        size_t objects = 0;
+        for (const ParseFrame &frame : stack.frames)
+        {
+            if (frame.isObject)
+            {
+                if (!frame.hasKey) // 出错时key还没解析完, 路径停在对象上
+                    break;
+                const jsonstring &key = stack.objects[objects++].key;
+                writer.put(".", 1);
+                writer.put(key.data(), key.size());
+            }
+            else
+            {
+                writer.put("[", 1);
+                writer.putIndex(frame.index);
+                writer.put("]", 1);
+            }
+        }
+    }
+
+    // 记下错误的位置, 行列号只在出错时从头数一遍
+    // 返回false, 调用的地方可以直接return fail(...)
+    bool fail(const std::string &str, size_t index, ParseErrorCode code, ParseContext &ctx)
+    {
+        MYJSON_STAGE_TIMER(errorNanos);
+        ParseError &error = ctx.error;
+        error.code = code;
+        error.offset = std::min(index, str.size());
+        error.line = 1;
+        size_t lineStart = 0;
+        for (size_t i = 0; i < error.offset; i++)
+        {
+            if (str[i] == '\n')
+            {
+                error.line++;
+                lineStart = i + 1;
+            }
+        }
+        error.column = error.offset - lineStart + 1;
+        PathWriter writer(error.path);
+        writePath(writer, ctx.stack);
+        return false;
+    }
+
+    // 按ParseOptions里的限制记账, 每加一个节点或元素就检查一次, 超了马上失败
+    // bytes是估算的内存: 节点 + 字符串内容 + 容器里的元素
+    bool charge(const std::string &str, size_t index, ParseContext &ctx, size_t nodes, size_t bytes)
+    {
+        ctx.nodes += nodes;
+        ctx.bytes += bytes;
+        if (ctx.nodes > ctx.options.maxNodes)
+            return fail(str, index, ParseErrorCode::TOO_MANY_NODES, ctx);
+        if (ctx.bytes > ctx.options.memoryBudget)
+            return fail(str, index, ParseErrorCode::MEMORY_BUDGET_EXCEEDED, ctx);
+        return true;
+    }
+
+    bool checkIndex(const std::string &str, size_t index, ParseContext &ctx)
+    {
+        return index < str.size() || fail(str, index, ParseErrorCode::UNEXPECTED_END, ctx);
+    }
+
+    // index在'/'上
+    bool skipComment(const std::string &str, size_t &index, ParseContext &ctx)
+    {
+        if (index + 1 == str.size())
+            return fail(str, str.size(), ParseErrorCode::UNEXPECTED_END, ctx);
+        if (str[index + 1] == '/')
+        {
+            index = std::min(str.find('\n', index), str.size());
+            return true;
+        }
+        if (str[index + 1] != '*')
+            return fail(str, index, ParseErrorCode::INVALID_COMMENT, ctx);
+        size_t end = str.find("*/", index + 2);
+        if (end == std::string::npos)
+            return fail(str, str.size(), ParseErrorCode::UNEXPECTED_END, ctx);
+        index = end + 2;
+        return true;
+    }
+
+    //  去空格
+    // Relaxed的解析器才会认扩展语法, 严格模式用的是Relaxed=false的那一份, 编译出来没有这些判断
+    template <bool Relaxed>
+    bool parseWhiteSpace(const std::string &str, size_t &index, ParseContext &ctx)
+    {
+        while (1)
+        {
+            while (index < str.size() && (str[index] == ' ' || str[index] == '\r' || str[index] == '\n' || str[index] == '\t'))
+            {
+                index++;
+            }
+            if constexpr (Relaxed)
+            {
+                if (index < str.size() && str[index] == '/' && ctx.options.allowComments)
+                {
+                    if (!skipComment(str, index, ctx))
+                        return false;
+                    continue;
+                }
+            }
+            return true;
+        }
+    }
+
+    // 跳过空白, 后面必须还有东西
+    template <bool Relaxed>
+    bool nextToken(const std::string &str, size_t &index, ParseContext &ctx)
+    {
+        return parseWhiteSpace<Relaxed>(str, index, ctx) && checkIndex(str, index, ctx);
+    }
+
+    template <bool Relaxed>
+    bool isQuote(char c, const ParseContext &ctx)
+    {
+        if constexpr (Relaxed)
+            return c == '\"' || (c == '\'' && ctx.options.allowSingleQuotes);
+        else
+            return c == '\"';
+    }
+
+    bool parseLiteral(std::string_view literal, const std::string &str, size_t &index, ParseContext &ctx)
+    {
+        MYJSON_STAGE_TIMER(literalNanos);
+        if (str.compare(index, literal.length(), literal) == 0)
+        {
+            index += literal.length();
+            return true;
+        }
+        return fail(str, index, ParseErrorCode::INVALID_LITERAL, ctx);
+    }
+
+    // parse string, index在开头的引号上, 单引号的字符串以单引号结束
+    template <bool Relaxed>
+    bool parseString(const std::string &str, size_t &index, jsonstring &out, ParseContext &ctx)
+    {
+        MYJSON_STAGE_TIMER(stringNanos);
+        const char quote = Relaxed ? str[index] : '\"';
+        index++; // 跳过起点
+        const size_t maxLength = ctx.options.maxStringLength;
+        while (1)
+        {
+            if (index == str.size())
+                return fail(str, index, ParseErrorCode::UNEXPECTED_END, ctx);
+            if (out.size() > maxLength)
+                return fail(str, index, ParseErrorCode::STRING_TOO_LONG, ctx);
+
+            if (str[index] == quote) //  字符串终点
+            {
+                break;
+            }
+            else if (str[index] == '\\') // 转义字符
+            {
+                index++;
+                if (index == str.size())
+                    return fail(str, index, ParseErrorCode::UNEXPECTED_END, ctx);
+                switch (str[index])
+                {
+                case '\"':
+                    out += '\"';
+                    break;
+                case '\'':
+                    if (!Relaxed || quote != '\'')
+                        return fail(str, index - 1, ParseErrorCode::INVALID_ESCAPE, ctx);
+                    out += '\'';
+                    break;
+                case '\\':
+                    out += '\\';
+                    break;
+                case '/':
+                    out += '/';
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    char utf8[4];
+                    size_t bytes = decodeUnicodeEscape(str, index, utf8);
+                    if (bytes == 0)
+                        return fail(str, index - 1, ParseErrorCode::INVALID_ESCAPE, ctx);
+                    out.append(utf8, bytes);
+                    break;
+                }
+                default:
+                    return fail(str, index - 1, ParseErrorCode::INVALID_ESCAPE, ctx);
+                }
+            }
+            else if (static_cast<unsigned char>(str[index]) < 0x20) // RFC 8259: 控制字符必须转义
+            {
+                return fail(str, index, ParseErrorCode::INVALID_CHARACTER, ctx);
             }
-            str += "\n}";
-        };
-
-        objectiter objectBegin() override { return m_value.begin(); }
-        const_objectiter const_objectBegin() const override { return m_value.cbegin(); }
-        objectiter objectEnd() override { return m_value.end(); }
-        const_objectiter const_objectEnd() const override { return m_value.cend(); }
-    };
-
-    ///////////////json//////////////////////
-    Json::Json() noexcept
-        : m_ptr(std::make_unique<JsonNull>()) {}
-    Json::Json(std::nullptr_t) noexcept
-        : m_ptr(std::make_unique<JsonNull>()) {}
-    Json::Json(int value)
-        : m_ptr(std::make_unique<JsonNumber>(double(value))) {}
-    Json::Json(double value)
-        : m_ptr(std::make_unique<JsonNumber>(value)) {}
-    Json::Json(bool value)
-        : m_ptr(std::make_unique<JsonBool>(value)) {}
-    Json::Json(const std::string &value)
-        : m_ptr(std::make_unique<JsonString>(value)) {}
-    Json::Json(std::string &&value)
-        : m_ptr(std::make_unique<JsonString>(std::move(value))) {}
-    Json::Json(const char *value)//这个std::string(value)是个临时对象 是右值
-        : m_ptr(std::make_unique<JsonString>(std::string(value))) {}
-    Json::Json(const array &value)
-        : m_ptr(std::make_unique<JsonArray>(value)) {}
-    Json::Json(array &&value)
-        : m_ptr(std::make_unique<JsonArray>(std::move(value))) {}
-    Json::Json(const object &value)
-        : m_ptr(std::make_unique<JsonObject>(value)) {}
-    Json::Json(object &&value)
-        : m_ptr(std::make_unique<JsonObject>(std::move(value))) {}
+            else
+            {
+                out += (str[index]);
+            }
+            index++;
+        }
+        index++;
+        return true;
+    }
 
-    Json::Json(const Json &other)
-        : m_ptr(other.m_ptr ? other.m_ptr->clone() : std::make_unique<JsonNull>()) {}
-    Json::Json(Json &&other) noexcept
-        : m_ptr(std::move(other.m_ptr)) {}
+    JsonValuePtr makeRawNumber(const std::string &str, size_t begin, size_t end, JsonValueType kind, int64_t i, uint64_t u, double d, const ParseContext &ctx)
+    {
+        RawNumber raw(ctx.resource);
+        raw.text.assign(str, begin, end - begin);
+        raw.kind = kind;
+        if (kind == JsonValueType::INT64)
+            raw.i = i;
+        else if (kind == JsonValueType::UINT64)
+            raw.u = u;
+        else
+            raw.d = d;
+        return makeValue<JsonRawNumber>(ctx.resource, std::move(raw));
+    }
 
-    Json::~Json() noexcept {}
+    // 扫描出来的数字, kind是INT64/UINT64/NUMBER之一
+    struct ScannedNumber
+    {
+        JsonValueType kind;
+        int64_t i;
+        uint64_t u;
+        double d;
+    };
 
-    JsonValueType Json::type() const
+    // 语法已经认过的数字的十进制量级m: 值在[10^(m-1), 10^m)里
+    // from_chars说超出范围时, 溢出的m至少309, 下溢的m最多-323, 看正负就能分开
+    int64_t decimalMagnitude(std::string_view text)
     {
-        check();
-        return m_ptr->type();
+        size_t i = text[0] == '-' ? 1 : 0;
+        int64_t magnitude = 0;
+        bool found = false; // 遇到第一个非0数字了
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+        {
+            if (found)
+                magnitude++;
+            else if (text[i] != '0')
+                found = true, magnitude = 1;
+        }
+        if (i < text.size() && text[i] == '.')
+        {
+            for (i++; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+            {
+                if (found)
+                    continue;
+                if (text[i] == '0')
+                    magnitude--;
+                else
+                    found = true;
+            }
+        }
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+        {
+            i++;
+            bool negative = text[i] == '-';
+            if (text[i] == '-' || text[i] == '+')
+                i++;
+            int64_t exponent = 0;
+            for (; i < text.size(); i++)
+                exponent = std::min<int64_t>(exponent * 10 + (text[i] - '0'), INT32_MAX); // 再大也只是更溢出/更下溢
+            magnitude += negative ? -exponent : exponent;
+        }
+        return magnitude;
     }
 
-    bool Json::is_null() const
+    // NaN Infinity -Infinity
+    bool scanNonFinite(const std::string &str, size_t &index, ScannedNumber &out)
     {
-        check();
-        return m_ptr->type() == JsonValueType::NUL;
+        static const std::string_view words[] = {"NaN", "Infinity", "-Infinity"};
+        static const double values[] = {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (str.compare(index, words[i].size(), words[i]) == 0)
+            {
+                index += words[i].size();
+                out.kind = JsonValueType::NUMBER;
+                out.d = values[i];
+                return true;
+            }
+        }
+        return false;
     }
 
-    bool Json::is_number() const
+    // 按RFC 8259的语法扫描: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    // 先认完语法再转换, from_chars认的inf/nan/01/1./.5都在这里挡掉
+    template <bool Relaxed>
+    bool scanNumber(const std::string &str, size_t &index, ParseContext &ctx, ScannedNumber &out)
     {
-        check();
-        return m_ptr->type() == JsonValueType::NUMBER;
+        MYJSON_STAGE_TIMER(numberNanos);
+        if constexpr (Relaxed)
+        {
+            if (ctx.options.allowNanInf && scanNonFinite(str, index, out))
+                return true;
+        }
+        auto isDigit = [&str](size_t pos)
+        { return pos < str.size() && str[pos] >= '0' && str[pos] <= '9'; };
+        size_t pos = index;
+        bool negative = str[pos] == '-';
+        if (negative)
+            pos++;
+        if (!isDigit(pos))
+            return fail(str, index, ParseErrorCode::INVALID_NUMBER, ctx);
+        // 整数部分顺便累加, 后面没有小数点和指数时直接用
+        uint64_t value = 0;
+        bool overflow = false;
+        if (str[pos] == '0')
+        {
+            pos++;
+            if (isDigit(pos)) // 前导0
+                return fail(str, index, ParseErrorCode::INVALID_NUMBER, ctx);
+        }
+        while (isDigit(pos))
+        {
+            unsigned digit = static_cast<unsigned>(str[pos] - '0');
+            if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                overflow = true;
+            value = value * 10 + digit;
+            pos++;
+        }
+        bool integer = true;
+        if (pos < str.size() && str[pos] == '.')
+        {
+            integer = false;
+            if (!isDigit(++pos))
+                return fail(str, pos, ParseErrorCode::INVALID_NUMBER, ctx);
+            while (isDigit(pos))
+                pos++;
+        }
+        if (pos < str.size() && (str[pos] == 'e' || str[pos] == 'E'))
+        {
+            integer = false;
+            pos++;
+            if (pos < str.size() && (str[pos] == '+' || str[pos] == '-'))
+                pos++;
+            if (!isDigit(pos))
+                return fail(str, pos, ParseErrorCode::INVALID_NUMBER, ctx);
+            while (isDigit(pos))
+                pos++;
+        }
+        if (pos - index > ctx.options.maxStringLength)
+            return fail(str, index, ParseErrorCode::STRING_TOO_LONG, ctx);
+
+        // 整数快速路径
+        if (integer && !overflow)
+        {
+            const uint64_t int64Limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1; // |INT64_MIN|
+            if (!negative || value <= int64Limit)
+            {
+                index = pos;
+                if (negative)
+                {
+                    out.kind = JsonValueType::INT64;
+                    out.i = value == int64Limit ? std::numeric_limits<int64_t>::min() : -static_cast<int64_t>(value);
+                }
+                else if (value < int64Limit)
+                {
+                    out.kind = JsonValueType::INT64;
+                    out.i = static_cast<int64_t>(value);
+                }
+                else
+                {
+                    out.kind = JsonValueType::UINT64;
+                    out.u = value;
+                }
+                return true;
+            }
+        }
+
+        // 其余的交给from_chars, 直接在原串上解析, 不受locale影响
+        // 非规格化数是合法的double; 太小的下溢成0, RFC 8259不算错, 只有溢出成无穷大才算超出范围
+        double d = 0;
+        auto result = std::from_chars(str.data() + index, str.data() + pos, d);
+        if (result.ec == std::errc::result_out_of_range)
+        {
+            // 溢出和下溢都报这个, d没动
+            if (decimalMagnitude(std::string_view(str).substr(index, pos - index)) > 0)
+                return fail(str, index, ParseErrorCode::NUMBER_OUT_OF_RANGE, ctx);
+            d = negative ? -0.0 : 0.0;
+        }
+        else if (result.ec != std::errc() || result.ptr != str.data() + pos)
+        {
+            return fail(str, index, ParseErrorCode::INVALID_NUMBER, ctx);
+        }
+        index = pos;
+        out.kind = JsonValueType::NUMBER;
+        out.d = d;
+        return true;
     }
 
-    bool Json::is_bool() const
+    template <bool Relaxed>
+    bool parseNumber(const std::string &str, size_t &index, ParseContext &ctx, JsonValuePtr &out)
     {
-        check();
-        return m_ptr->type() == JsonValueType::BOOL;
+        size_t begin = index;
+        ScannedNumber number;
+        if (!scanNumber<Relaxed>(str, index, ctx, number))
+            return false;
+        if (ctx.options.keepNumberText)
+            out = makeRawNumber(str, begin, index, number.kind, number.i, number.u, number.d, ctx);
+        else if (number.kind == JsonValueType::INT64)
+            out = makeValue<JsonInt64>(ctx.resource, number.i);
+        else if (number.kind == JsonValueType::UINT64)
+            out = makeValue<JsonUint64>(ctx.resource, number.u);
+        else
+            out = makeValue<JsonNumber>(ctx.resource, number.d);
+        return true;
     }
 
-    bool Json::is_string() const
+    // 标量: null/true/false/字符串/数字
+    template <bool Relaxed>
+    bool parseScalar(const std::string &in, size_t &index, ParseContext &ctx, JsonValuePtr &out)
     {
-        check();
-        return m_ptr->type() == JsonValueType::STRING;
+        size_t start = index;
+        size_t extraBytes = 0; // 节点之外的堆内存
+        if (in[index] == 'n') // null
+        {
+            if (!parseLiteral("null", in, index, ctx))
+                return false;
+            out = makeValue<JsonNull>(ctx.resource);
+        }
+        else if (in[index] == 't') // true
+        {
+            if (!parseLiteral("true", in, index, ctx))
+                return false;
+            out = makeValue<JsonBool>(ctx.resource, true);
+        }
+        else if (in[index] == 'f') // false
+        {
+            if (!parseLiteral("false", in, index, ctx))
+                return false;
+            out = makeValue<JsonBool>(ctx.resource, false);
+        }
+        else if (isQuote<Relaxed>(in[index], ctx)) // start of string
+        {
+            jsonstring value(ctx.resource);
+            if (!parseString<Relaxed>(in, index, value, ctx))
+                return false;
+            extraBytes = value.size();
+            out = makeValue<JsonString>(ctx.resource, std::move(value));
+        }
+        else if (!parseNumber<Relaxed>(in, index, ctx, out))
+        {
+            return false;
+        }
+        return charge(in, start, ctx, 1, out->allocSize() + extraBytes);
     }
 
-    bool Json::is_array() const
+    // 对象成员的 "key" :  members是这个对象已经有的成员数, index已经在key的引号上
+    template <bool Relaxed>
+    bool parseKey(const std::string &in, size_t &index, ParseContext &ctx, size_t members)
     {
-        check();
-        return m_ptr->type() == JsonValueType::ARRAY;
+        ParseFrame &frame = ctx.stack.frames.back();
+        jsonstring &key = ctx.stack.objects.back().key;
+        frame.hasKey = false;
+        key.clear();
+        if (members >= ctx.options.maxObjectMembers)
+            return fail(in, index, ParseErrorCode::TOO_MANY_MEMBERS, ctx);
+        if (!isQuote<Relaxed>(in[index], ctx))
+            return fail(in, index, ParseErrorCode::EXPECTED_KEY, ctx);
+        if (!parseString<Relaxed>(in, index, key, ctx))
+            return false;
+
+        if (!nextToken<Relaxed>(in, index, ctx))
+            return false;
+        if (in[index] != ':') // 必须是冒号 后面跟value
+            return fail(in, index, ParseErrorCode::EXPECTED_COLON, ctx);
+        index++;
+        frame.hasKey = true;
+        return true;
     }
 
-    bool Json::is_object() const
+    // 栈顶的容器结束了, 做成节点弹出去; index在结束符上
+    // 重复的key是在对象结束时才发现的, REJECT报错的位置是结束符, 路径指向那个key
+    bool closeFrame(const std::string &in, size_t index, ParseContext &ctx, JsonValuePtr &value)
     {
-        check();
-        return m_ptr->type() == JsonValueType::OBJECT;
+        ParseStack &stack = ctx.stack;
+        if (stack.frames.back().isObject)
+        {
+            object members(ctx.resource);
+            jsonstring &key = stack.objects.back().key;
+            if (!stack.members.close(members, ctx.options.duplicateKeys, key))
+            {
+                stack.frames.back().hasKey = true;
+                return fail(in, index, ParseErrorCode::DUPLICATE_KEY, ctx);
+            }
+            value = makeValue<JsonObject>(ctx.resource, std::move(members));
+            stack.objects.pop_back();
+        }
+        else
+        {
+            value = makeValue<JsonArray>(ctx.resource, std::move(stack.arrays.back()));
+            stack.arrays.pop_back();
+        }
+        stack.frames.pop_back();
+        return true;
     }
 
-    double Json::getNumber() const
+    // 逗号之后: 容器里的下一个元素, 或者(allowTrailingCommas时)容器结束
+    // 返回false是出错; closed为true表示逗号后面直接是容器结束, index停在结束符上
+    template <bool Relaxed>
+    bool afterComma(const std::string &in, size_t &index, ParseContext &ctx, bool isObject, bool &closed)
     {
-        check();
-        return m_ptr->getNumber();
+        if (!nextToken<Relaxed>(in, index, ctx))
+            return false;
+        closed = false;
+        if constexpr (Relaxed)
+            closed = ctx.options.allowTrailingCommas && in[index] == (isObject ? '}' : ']');
+        return true;
     }
 
-    bool Json::getBool() const
+    // 根值之后只能有空白(和注释), 除非allowTrailingContent
+    template <bool Relaxed>
+    bool parseEnd(const std::string &in, size_t &index, ParseContext &ctx)
     {
-        check();
-        return m_ptr->getBool();
+        if (ctx.options.allowTrailingContent)
+            return true;
+        if (!parseWhiteSpace<Relaxed>(in, index, ctx))
+            return false;
+        return index == in.size() || fail(in, index, ParseErrorCode::TRAILING_CONTENT, ctx);
     }
 
-    const std::string &Json::getString() const
+    bool isRelaxed(const ParseOptions &options)
     {
-        check();
-        return m_ptr->getString();
-    };
+        return options.allowComments || options.allowTrailingCommas || options.allowNanInf || options.allowSingleQuotes;
+    }
 
-    const array &Json::getArray() const
+    // 不递归, 嵌套的容器都放在ctx.stack上, 深度只受options.maxDepth限制
+    // 每轮先解析一个值(遇到容器开头就压栈, 接着解析它的第一个元素),
+    // 拿到完整的值后交给栈顶的容器, 容器结束了就弹栈继续往上交
+    template <bool Relaxed>
+    bool parseJson(const std::string &in, size_t &index, ParseContext &ctx, JsonValuePtr &out)
     {
-        check();
-        return m_ptr->getArray();
-    };
+        ParseStack &stack = ctx.stack;
+        JsonValuePtr value;
+        while (1)
+        {
+            if (!nextToken<Relaxed>(in, index, ctx))
+                return false;
+            if (in[index] == '[' || in[index] == '{') // start of array/object
+            {
+                if (stack.size() >= ctx.options.maxDepth)
+                    return fail(in, index, ParseErrorCode::DEPTH_EXCEEDED, ctx);
+                bool isObject = in[index] == '{';
+                if (!charge(in, index, ctx, 1, isObject ? sizeof(JsonObject) : sizeof(JsonArray)))
+                    return false;
+                stack.frames.push_back({isObject, false, 0});
+                if (isObject)
+                {
+                    stack.objects.emplace_back(ctx.resource);
+                    stack.members.open();
+                }
+                else
+                {
+                    stack.arrays.emplace_back(ctx.resource);
+                }
+                MYJSON_STAT(maxDepth = std::max(t_stats->maxDepth, stack.size()));
+                index++;
+                if (!nextToken<Relaxed>(in, index, ctx))
+                    return false;
+                if (in[index] != (isObject ? '}' : ']'))
+                {
+                    if (isObject && !parseKey<Relaxed>(in, index, ctx, 0))
+                        return false;
+                    continue; // 解析第一个元素
+                }
+                if (!closeFrame(in, index++, ctx, value))
+                    return false;
+            }
+            else if (!parseScalar<Relaxed>(in, index, ctx, value))
+            {
+                return false;
+            }
 
-    const object &Json::getObject() const
-    {
-        check();
-        return m_ptr->getObject();
-    };
+            // 把值交给外层容器, 外层也结束了就一直往上
+            while (1)
+            {
+                MYJSON_STAT(nodes[static_cast<size_t>(value->type())]++);
+                if (stack.empty())
+                {
+                    out = std::move(value);
+                    return true;
+                }
+                ParseFrame &frame = stack.frames.back();
+                if (frame.isObject)
+                {
+                    // map的节点: key/value加上红黑树的指针和颜色
+                    PendingObject &pending = stack.objects.back();
+                    if (!charge(in, index, ctx, 0, sizeof(object::value_type) + 4 * sizeof(void *) + pending.key.size()))
+                        return false;
+                    stack.members.add(std::move(pending.key), Json(std::move(value)));
+                }
+                else
+                {
+                    if (!charge(in, index, ctx, 0, sizeof(Json)))
+                        return false;
+                    stack.arrays.back().emplace_back(Json(std::move(value)));
+                }
 
-    void Json::setNumber(double value)
-    {
-        check();
-        m_ptr->setNumber(value);
+                if (!nextToken<Relaxed>(in, index, ctx))
+                    return false;
+                if (in[index] == ',')
+                {
+                    index++;
+                    bool closed;
+                    if (!afterComma<Relaxed>(in, index, ctx, frame.isObject, closed))
+                        return false;
+                    if (!closed)
+                    {
+                        if (frame.isObject && !parseKey<Relaxed>(in, index, ctx, stack.members.count()))
+                            return false;
+                        frame.index++;
+                        break; // 解析下一个元素
+                    }
+                }
+                else if (in[index] != (frame.isObject ? '}' : ']'))
+                {
+                    return fail(in, index, frame.isObject ? ParseErrorCode::EXPECTED_OBJECT_END : ParseErrorCode::EXPECTED_ARRAY_END, ctx);
+                }
+                if (!closeFrame(in, index++, ctx, value))
+                    return false;
+            }
+        }
     }
 
-    void Json::setBool(double value)
+    // json parse
+    Json parse(const std::string &in)
     {
-        check();
-        m_ptr->setBool(value);
+        return parse(in, ParseOptions());
     }
 
-    void Json::setString(const std::string &value)
+    Json parse(const std::string &in, const ParseOptions &options)
     {
-        check();
-        m_ptr->setString(value);
+        return parse(in, options, defaultResource());
     }
 
-    void Json::setArray(const array &value)
+    Json parse(const std::string &in, std::pmr::memory_resource *resource)
     {
-        check();
-        m_ptr->setArray(value);
+        return parse(in, ParseOptions(), resource);
     }
 
-    void Json::setObject(const object &value)
+    // 出错时才拼消息, 正常路径上不分配
+    [[noreturn]] void throwParseError(const ParseError &error)
     {
-        check();
-        m_ptr->setObject(value);
+        throw myJsonException(std::string(error.message()) + " at line " + std::to_string(error.line) + " column " + std::to_string(error.column) + " (" + error.path + ")", error.offset);
     }
 
-    void Json::addToArray(const Json &value)
+    Json parse(const std::string &in, const ParseOptions &options, std::pmr::memory_resource *resource)
     {
-        check();
-        m_ptr->addToArray(value);
+        ParseError error;
+        Json out = parse(in, options, resource, error);
+        if (error)
+            throwParseError(error);
+        return out;
     }
 
-    void Json::addToObject(const std::string &key, const Json &value)
+    Json parse(const std::string &in, ParseError &error)
     {
-        check();
-        m_ptr->addToObject(key, value);
+        return parse(in, ParseOptions(), defaultResource(), error);
     }
 
-    void Json::removeFromArray(size_t index)
+    Json parse(const std::string &in, const ParseOptions &options, ParseError &error)
     {
-        check();
-        m_ptr->removeFromArray(index);
+        return parse(in, options, defaultResource(), error);
     }
 
-    void Json::removeFromObject(const std::string &key)
+    // stack由调用方提供, Parser里复用同一个, 不用每次重新分配
+    Json parse(const std::string &in, const ParseOptions &options, std::pmr::memory_resource *resource, ParseError &error, ParseStack &stack)
     {
-        check();
-        m_ptr->removeFromObject(key);
+        size_t index = 0;
+        error = ParseError();
+#ifdef MYJSON_ENABLE_STATS
+        // 默认的堆换成会计数的, 其他resource(比如Parser的池子)由调用方自己统计
+        if (t_stats && resource == std::pmr::new_delete_resource())
+            resource = statsResource();
+        MYJSON_STAT(parses++);
+        MYJSON_STAGE_TIMER(parseNanos);
+#endif
+        ParseContext ctx{options, resource, error, stack};
+        JsonValuePtr out;
+        // 太大的输入一个字节都不看
+        if (in.size() > options.maxInputBytes)
+        {
+            fail(in, options.maxInputBytes, ParseErrorCode::INPUT_TOO_LARGE, ctx);
+            MYJSON_STAT(errors++);
+            return Json(makeValue<JsonNull>(resource));
+        }
+        // 按有没有用到扩展语法选一份实例, 严格模式的那一份没有任何扩展的判断
+        bool ok = isRelaxed(options) ? parseJson<true>(in, index, ctx, out) && parseEnd<true>(in, index, ctx)
+                                     : parseJson<false>(in, index, ctx, out) && parseEnd<false>(in, index, ctx);
+        if (!ok)
+        {
+            stack.clear();
+            MYJSON_STAT(errors++);
+            return Json(makeValue<JsonNull>(resource));
+        }
+        MYJSON_STAT(parseBytes += index);
+        return Json(std::move(out));
     }
 
-    Json &Json::operator[](size_t index)
+    Json parse(const std::string &in, const ParseOptions &options, std::pmr::memory_resource *resource, ParseError &error)
     {
-        return (*m_ptr)[index];
+        ParseStack stack;
+        return parse(in, options, resource, error, stack);
     }
 
-    Json &Json::operator[](const std::string &key)
+    ///////////////SAX//////////////////////
+    // 回调返回false时记成HANDLER_ABORTED
+    bool notify(bool ok, const std::string &in, size_t index, ParseContext &ctx)
     {
-        return (*m_ptr)[key];
+        return ok || fail(in, index, ParseErrorCode::HANDLER_ABORTED, ctx);
     }
 
-    const Json &Json::operator[](size_t index) const
+    template <bool Relaxed>
+    bool emitScalar(const std::string &in, size_t &index, ParseContext &ctx, JsonHandler &handler, jsonstring &scratch)
     {
-        return (*m_ptr)[index];
+        size_t start = index;
+        if (!charge(in, start, ctx, 1, 0))
+            return false;
+        bool ok;
+        if (in[index] == 'n')
+        {
+            if (!parseLiteral("null", in, index, ctx))
+                return false;
+            ok = handler.null();
+        }
+        else if (in[index] == 't' || in[index] == 'f')
+        {
+            bool value = in[index] == 't';
+            if (!parseLiteral(value ? "true" : "false", in, index, ctx))
+                return false;
+            ok = handler.boolean(value);
+        }
+        else if (isQuote<Relaxed>(in[index], ctx))
+        {
+            scratch.clear();
+            if (!parseString<Relaxed>(in, index, scratch, ctx))
+                return false;
+            ok = handler.string(std::string_view(scratch.data(), scratch.size()));
+        }
+        else
+        {
+            ScannedNumber number;
+            if (!scanNumber<Relaxed>(in, index, ctx, number))
+                return false;
+            if (number.kind == JsonValueType::INT64)
+                ok = handler.integer(number.i);
+            else if (number.kind == JsonValueType::UINT64)
+                ok = handler.unsignedInteger(number.u);
+            else
+                ok = handler.number(number.d);
+        }
+        return notify(ok, in, start, ctx);
     }
 
-    const Json &Json::operator[](const std::string &key) const
+    template <bool Relaxed>
+    bool emitKey(const std::string &in, size_t &index, ParseContext &ctx, JsonHandler &handler, size_t members)
     {
-        return (*m_ptr)[key];
+        size_t start = index;
+        if (!parseKey<Relaxed>(in, index, ctx, members))
+            return false;
+        const jsonstring &key = ctx.stack.objects.back().key;
+        return notify(handler.key(std::string_view(key.data(), key.size())), in, start, ctx);
     }
 
-    Json &Json::operator=(const Json &other)
+    // 和parseJson一样的循环, 只是不建节点, 栈上只留key和下标给出错时拼路径
+    template <bool Relaxed>
+    bool parseSax(const std::string &in, size_t &index, ParseContext &ctx, JsonHandler &handler)
     {
-        if (this != &other) // 防止自赋值
+        ParseStack &stack = ctx.stack;
+        jsonstring scratch(ctx.resource);
+        while (1)
         {
-            m_ptr = other.m_ptr ? other.m_ptr->clone() : std::make_unique<JsonNull>();
-        }
-        return *this;
-    }
+            if (!nextToken<Relaxed>(in, index, ctx))
+                return false;
+            if (in[index] == '[' || in[index] == '{')
+            {
+                if (stack.size() >= ctx.options.maxDepth)
+                    return fail(in, index, ParseErrorCode::DEPTH_EXCEEDED, ctx);
+                bool isObject = in[index] == '{';
+                if (!charge(in, index, ctx, 1, 0) || !notify(isObject ? handler.startObject() : handler.startArray(), in, index, ctx))
+                    return false;
+                stack.frames.push_back({isObject, false, 0});
+                if (isObject)
+                    stack.objects.emplace_back(ctx.resource);
+                index++;
+                if (!nextToken<Relaxed>(in, index, ctx))
+                    return false;
+                if (in[index] != (isObject ? '}' : ']'))
+                {
+                    if (isObject && !emitKey<Relaxed>(in, index, ctx, handler, 0))
+                        return false;
+                    continue;
+                }
+                stack.frames.pop_back();
+                if (isObject)
+                    stack.objects.pop_back();
+                if (!notify(isObject ? handler.endObject() : handler.endArray(), in, index++, ctx))
+                    return false;
+            }
+            else if (!emitScalar<Relaxed>(in, index, ctx, handler, scratch))
+            {
+                return false;
+            }
 
-    Json &Json::operator=(Json &&other) noexcept
-    {
-        if (this != &other) // 防止自赋值
-        {
-            m_ptr = std::move(other.m_ptr);
+            // 一个值结束了, 看外层容器是继续还是结束
+            while (1)
+            {
+                if (stack.empty())
+                    return true;
+                ParseFrame &frame = stack.frames.back();
+                if (!nextToken<Relaxed>(in, index, ctx))
+                    return false;
+                bool isObject = frame.isObject;
+                if (in[index] == ',')
+                {
+                    index++;
+                    bool closed;
+                    if (!afterComma<Relaxed>(in, index, ctx, isObject, closed))
+                        return false;
+                    if (!closed)
+                    {
+                        frame.index++;
+                        if (isObject && !emitKey<Relaxed>(in, index, ctx, handler, frame.index))
+                            return false;
+                        break;
+                    }
+                }
+                else if (in[index] != (isObject ? '}' : ']'))
+                {
+                    return fail(in, index, isObject ? ParseErrorCode::EXPECTED_OBJECT_END : ParseErrorCode::EXPECTED_ARRAY_END, ctx);
+                }
+                stack.frames.pop_back();
+                if (isObject)
+                    stack.objects.pop_back();
+                if (!notify(isObject ? handler.endObject() : handler.endArray(), in, index++, ctx))
+                    return false;
+            }
         }
-        return *this;
     }
 
-    bool Json::operator==(const Json &other) const
+    bool parse(const std::string &in, JsonHandler &handler, ParseError &error)
     {
-        check();
-        if (m_ptr == other.m_ptr)
-            return true;
-        else if (type() != other.type())
-            return false;
-        else
-            return m_ptr->equals(other.m_ptr.get());
+        return parse(in, ParseOptions(), handler, error);
     }
 
-    bool Json::operator<(const Json &other) const
+    bool parse(const std::string &in, const ParseOptions &options, JsonHandler &handler, ParseError &error)
     {
-        check();
-        if (m_ptr == other.m_ptr)
+        size_t index = 0;
+        error = ParseError();
+        MYJSON_STAT(parses++);
+        MYJSON_STAGE_TIMER(parseNanos);
+        ParseStack stack;
+        ParseContext ctx{options, defaultResource(), error, stack};
+        if (in.size() > options.maxInputBytes)
+        {
+            fail(in, options.maxInputBytes, ParseErrorCode::INPUT_TOO_LARGE, ctx);
+            MYJSON_STAT(errors++);
             return false;
-        else if (m_ptr->type() != other.m_ptr->type())
-            return m_ptr->type() < other.m_ptr->type();
-        else
-            return m_ptr->less(other.m_ptr.get());
-    }
-
-    const std::string Json::dump() const
-    {
-        std::string str;
-        dump(str, 0);
-        return str;
+        }
+        bool ok = isRelaxed(options) ? parseSax<true>(in, index, ctx, handler) && parseEnd<true>(in, index, ctx)
+                                     : parseSax<false>(in, index, ctx, handler) && parseEnd<false>(in, index, ctx);
+        if (!ok)
+        {
+            MYJSON_STAT(errors++);
+            return false;
+        }
+        MYJSON_STAT(parseBytes += index);
+        return true;
     }
 
-    void Json::dump(std::string &str, size_t depth) const
+    ///////////////Parser//////////////////////
+    // 转发给upstream, 顺便计数
+    class CountingResource : public std::pmr::memory_resource
     {
-        check();
-        m_ptr->dump(str, depth);
-    }
+    public:
+        CountingResource(std::pmr::memory_resource *upstream, size_t &allocations, size_t &bytesInUse)
+            : m_upstream(upstream), m_allocations(allocations), m_bytesInUse(bytesInUse) {}
 
-    arrayiter Json::arrayBegin()
-    {
-        check();
-        return m_ptr->arrayBegin();
-    }
+    private:
+        std::pmr::memory_resource *m_upstream;
+        size_t &m_allocations;
+        size_t &m_bytesInUse;
 
-    const_arrayiter Json::const_arrayBegin() const
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            void *p = m_upstream->allocate(bytes, alignment);
+            m_allocations++;
+            m_bytesInUse += bytes;
+            return p;
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override
+        {
+            m_bytesInUse -= bytes;
+            m_upstream->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // 池子的参数: 容器的buffer(数组扩容, 长字符串)也要能进空闲链表, 所以最大块开大一些
+    std::pmr::pool_options parserPoolOptions()
     {
-        check();
-        return m_ptr->const_arrayBegin();
+        std::pmr::pool_options options;
+        options.max_blocks_per_chunk = 1024;
+        options.largest_required_pool_block = 1 << 20;
+        return options;
     }
 
-    arrayiter Json::arrayEnd()
+    class Parser::Impl
     {
-        check();
-        return m_ptr->arrayEnd();
-    }
+    public:
+        explicit Impl(const ParseOptions &options)
+            : m_options(options),
+              m_upstream(std::pmr::new_delete_resource(), m_counters.upstreamAllocations, m_counters.upstreamBytes),
+              m_pool(parserPoolOptions(), &m_upstream),
+              m_front(&m_pool, m_counters.allocations, m_counters.bytesInUse) {}
+
+        ParseOptions m_options;
+        Counters m_counters;
+        CountingResource m_upstream; // 池子 -> 堆
+        std::pmr::unsynchronized_pool_resource m_pool;
+        CountingResource m_front; // Json -> 池子
+        ParseStack m_stack;
+    };
 
-    const_arrayiter Json::const_arrayEnd() const
+    Parser::Parser(const ParseOptions &options)
+        : m_impl(std::make_unique<Impl>(options)) {}
+
+    Parser::~Parser() {}
+
+    Json Parser::parse(const std::string &in)
     {
-        check();
-        return m_ptr->const_arrayEnd();
+        ParseError error;
+        Json out = parse(in, error);
+        if (error)
+            throwParseError(error);
+        return out;
     }
 
-    objectiter Json::objectBegin()
+    Json Parser::parse(const std::string &in, ParseError &error)
     {
-        check();
-        return m_ptr->objectBegin();
+        m_impl->m_counters.parses++;
+#ifdef MYJSON_ENABLE_STATS
+        if (t_stats)
+        {
+            size_t before = m_impl->m_counters.allocations;
+            Json out = myJson::parse(in, m_impl->m_options, &m_impl->m_front, error, m_impl->m_stack);
+            t_stats->allocations += m_impl->m_counters.allocations - before;
+            return out;
+        }
+#endif
+        return myJson::parse(in, m_impl->m_options, &m_impl->m_front, error, m_impl->m_stack);
     }
 
-    const_objectiter Json::const_objectBegin() const
+    const Parser::Counters &Parser::counters() const
     {
-        check();
-        return m_ptr->const_objectBegin();
+        return m_impl->m_counters;
     }
 
-    objectiter Json::objectEnd()
+    void Parser::resetCounters()
     {
-        check();
-        return m_ptr->objectEnd();
+        Counters &counters = m_impl->m_counters;
+        counters.parses = 0;
+        counters.allocations = 0;
+        counters.upstreamAllocations = 0;
     }
 
-    const_objectiter Json::const_objectEnd() const
+    void Parser::release()
     {
-        check();
-        return m_ptr->const_objectEnd();
+        m_impl->m_pool.release();
     }
 
-    void checkIndex(const std::string &str, size_t index)
+    ///////////////StreamParser//////////////////////
+    // 把SAX事件建成树, 容器的栈和parseJson一样数组和对象分开放
+    class TreeBuilder : public JsonHandler
     {
-        if (index >= str.size())
+    public:
+        TreeBuilder(std::pmr::memory_resource *resource, DuplicateKeys duplicateKeys)
+            : m_resource(resource), m_duplicateKeys(duplicateKeys) {}
+
+        bool null() override { return add(makeValue<JsonNull>(m_resource)); }
+        bool boolean(bool value) override { return add(makeValue<JsonBool>(m_resource, value)); }
+        bool integer(int64_t value) override { return add(makeValue<JsonInt64>(m_resource, value)); }
+        bool unsignedInteger(uint64_t value) override { return add(makeValue<JsonUint64>(m_resource, value)); }
+        bool number(double value) override { return add(makeValue<JsonNumber>(m_resource, value)); }
+        bool string(std::string_view value) override { return add(makeValue<JsonString>(m_resource, jsonstring(value, m_resource))); }
+
+        bool startObject() override
         {
-            throw myJsonException("Unexpected end", index);
+            m_isObject.push_back(true);
+            m_objects.emplace_back(m_resource);
+            m_members.open();
+            return true;
         }
-    };
 
-    //  去空格
-    void parseWhiteSpace(const std::string &str, size_t &index)
-    {
-        while (index < str.size() && (str[index] == ' ' || str[index] == '\r' || str[index] == '\n' || str[index] == '\t'))
+        bool key(std::string_view key) override
         {
-            index++;
+            m_objects.back().key.assign(key.data(), key.size());
+            return true;
         }
-    }
 
-    Json parseLiteral(const std::string &literal, Json target, const std::string &str, size_t &index)
-    {
-        if (str.compare(index, literal.length(), literal) == 0)
+        bool endObject() override
         {
-            index += literal.length();
-            return target;
+            object members(m_resource);
+            if (!m_members.close(members, m_duplicateKeys, m_objects.back().key))
+                return !(m_duplicate = true);
+            JsonValuePtr value = makeValue<JsonObject>(m_resource, std::move(members));
+            m_objects.pop_back();
+            m_isObject.pop_back();
+            return add(std::move(value));
         }
-        else
+
+        bool startArray() override
         {
-            throw myJsonException("[ERROR]: expected (" + literal + ") got (" + str.substr(index, literal.length()) + ")", index);
+            m_isObject.push_back(false);
+            m_arrays.emplace_back(m_resource);
+            return true;
         }
-    };
 
-    // parse string
-    Json parseString(const std::string &str, size_t &index)
-    {
-        std::string out;
-        index++; // 跳过起点
-        while (1)
+        bool endArray() override
         {
-            if (index == str.size())
-                throw myJsonException("Unexpected end", index);
+            JsonValuePtr value = makeValue<JsonArray>(m_resource, std::move(m_arrays.back()));
+            m_arrays.pop_back();
+            m_isObject.pop_back();
+            return add(std::move(value));
+        }
 
-            if (str[index] == '\"') //  字符串终点
+        Json release()
+        {
+            if (!m_root)
+                return Json(makeValue<JsonNull>(m_resource));
+            return Json(std::move(m_root));
+        }
+
+        // 回调返回false是因为DuplicateKeys::REJECT遇到了重复的key
+        bool duplicate() const { return m_duplicate; }
+
+    private:
+        std::pmr::memory_resource *m_resource;
+        DuplicateKeys m_duplicateKeys;
+        bool m_duplicate = false;
+        std::vector<bool> m_isObject;
+        std::vector<array> m_arrays;
+        std::vector<PendingObject> m_objects;
+        MemberCollector m_members;
+        JsonValuePtr m_root;
+
+        bool add(JsonValuePtr value)
+        {
+            if (m_isObject.empty())
             {
-                break;
+                m_root = std::move(value);
             }
-            else if (str[index] == '\\') // 转义字符
+            else if (m_isObject.back())
             {
-                index++;
-                switch (str[index])
-                {
-                case '\"':
-                    out += '\"';
-                    break;
-                case '\\':
-                    out += '\\';
-                    break;
-                case '/':
-                    out += '/';
-                    break;
-                case 'b':
-                    out += '\b';
-                    break;
-                case 'f':
-                    out += '\f';
-                    break;
-                case 'n':
-                    out += '\n';
-                    break;
-                case 'r':
-                    out += '\r';
-                    break;
-                case 't':
-                    out += '\t';
-                    break;
-                default:
-                    throw myJsonException("unkown sequence:" + std::string(1, str[index - 1]) + std::string(1, str[index]), index);
-                    break;
-                }
+                m_members.add(std::move(m_objects.back().key), Json(std::move(value)));
             }
             else
             {
-                out += (str[index]);
+                m_arrays.back().emplace_back(Json(std::move(value)));
             }
-            index++;
+            return true;
         }
-        index++;
-        return Json(out);
-    }
+    };
 
-    Json parseNumber(const std::string &str, size_t &index)
+    // 状态机: m_state是下一个字符应该是什么, m_token是跨块没结束的字符串/数字/字面量
+    // 完整的token交给parseString/scanNumber, 它们报的位置是相对token的, 出错时再换算回整个输入
+    class StreamParser::Impl
     {
-        size_t processed = 0;
-        double value = 0;
-        try
-        {
-            // 尝试转成double
-            value = std::stod(str.substr(index), &processed);
+    public:
+        Impl(JsonHandler *handler, const ParseOptions &options)
+            : m_options(options),
+              m_ctx{m_options, defaultResource(), m_error, m_stack},
+              m_builder(defaultResource(), options.duplicateKeys),
+              m_handler(handler ? handler : &m_builder),
+              m_scratch(defaultResource()) {}
+
+        // stopAtRoot时根值一结束就停下, consumed是用掉的字节数, 后面的留给调用方
+        bool feed(std::string_view chunk, bool stopAtRoot, size_t &consumed)
+        {
+            consumed = 0;
+            if (m_error)
+                return false;
+            const size_t allowed = m_options.maxInputBytes - m_offset;
+            // 超出的部分可能属于下一条消息, 只有根值在限制之内结束不了才算超限
+            bool overflow = chunk.size() > allowed;
+            if (overflow && stopAtRoot)
+                chunk = chunk.substr(0, allowed);
+            m_chunk = chunk;
+            m_locatePos = 0;
+            m_locateLine = m_line;
+            m_locateLineStart = m_lineStart;
+            if (overflow && !stopAtRoot)
+                return failAt(ParseErrorCode::INPUT_TOO_LARGE, allowed);
+            size_t i = 0;
+            while (i < chunk.size())
+            {
+                if (stopAtRoot && m_state == State::DONE)
+                {
+                    m_chunk = chunk.substr(0, i);
+                    overflow = false;
+                    break;
+                }
+                if (m_token != Token::NONE)
+                {
+                    if (!continueToken(i))
+                        return false;
+                    continue;
+                }
+                char c = chunk[i];
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                {
+                    i++;
+                    continue;
+                }
+                if (c == '/' && m_options.allowComments)
+                {
+                    m_token = Token::SLASH;
+                    m_tokenOffset = m_offset + i;
+                    locate(i, m_tokenLine, m_tokenColumn);
+                    i++;
+                    continue;
+                }
+                if (!step(c, i))
+                    return false;
+            }
+            // 块正好在根值结束的地方用完
+            if (stopAtRoot && m_state == State::DONE)
+                overflow = false;
+            if (overflow)
+                return failAt(ParseErrorCode::INPUT_TOO_LARGE, allowed);
+            consumed = m_chunk.size();
+            advance();
+            return true;
         }
-        catch (const std::invalid_argument &)
+
+        bool finish()
         {
-            throw myJsonException("Invalid number format!", index);
+            if (m_error)
+                return false;
+            MYJSON_STAT(parses++);
+            // 数字和字面量没有结束符, 输入结束就是结束; 行注释也是
+            if ((m_token == Token::NUMBER || m_token == Token::LITERAL) && !completeToken())
+                return false;
+            if (m_token != Token::NONE && m_token != Token::LINE_COMMENT)
+                return failAt(ParseErrorCode::UNEXPECTED_END, 0);
+            if (m_state != State::DONE)
+                return failAt(ParseErrorCode::UNEXPECTED_END, 0);
+            MYJSON_STAT(parseBytes += m_offset);
+            return true;
         }
-        catch (const std::out_of_range &)
+
+        bool done() const { return m_state == State::DONE; }
+
+        Json release()
         {
-            throw myJsonException("Number out of range!", index);
+            if (m_handler != &m_builder || m_error || m_state != State::DONE)
+                return Json(makeValue<JsonNull>(m_ctx.resource));
+            return m_builder.release();
         }
-        // if we get here ,processed must be more than 0
-        index += processed;
-        return Json(value);
-    }
 
-    // 声明一下
-    Json parseJson(const std::string &in, size_t &index, size_t depth);
+        ParseOptions m_options;
+        ParseError m_error;
 
-    Json parseArray(const std::string &str, size_t &index, size_t depth)
-    {
-        array out;
-        parseWhiteSpace(str, index);
-        checkIndex(str, index);
-        if (str[index] == ']')
-            return Json(out);
-        while (1)
+    private:
+        enum class State
+        {
+            VALUE,
+            FIRST_VALUE, // '['之后: 值或者']'
+            FIRST_KEY,   // '{'之后: key或者'}'
+            KEY,
+            COLON,
+            AFTER_VALUE, // ','或者容器结束
+            DONE
+        };
+
+        enum class Token
         {
-            try
+            NONE,
+            STRING,
+            KEY,
+            NUMBER,
+            LITERAL,
+            SLASH,        // 注释开头的'/', 还不知道是哪种
+            LINE_COMMENT,
+            BLOCK_COMMENT // m_escape记上一个字符是不是'*'
+        };
+
+        ParseStack m_stack;
+        ParseContext m_ctx;
+        TreeBuilder m_builder;
+        JsonHandler *m_handler;
+
+        State m_state = State::VALUE;
+        std::string_view m_chunk;
+        size_t m_offset = 0;    // m_chunk之前已经处理的字节数
+        size_t m_line = 1;      // m_chunk开头所在的行
+        size_t m_lineStart = 0; // 这一行开头的偏移
+        // locate上次数到m_chunk的哪里, 和那里所在的行
+        size_t m_locatePos = 0;
+        size_t m_locateLine = 1;
+        size_t m_locateLineStart = 0;
+
+        Token m_token = Token::NONE;
+        std::string m_text; // 没结束的token, 字符串包括引号
+        bool m_escape = false;
+        size_t m_hexDigits = 0;    // 字符串里\u后面还剩几位十六进制
+        size_t m_stringLength = 0; // 字符串解码后长度的下界
+        size_t m_tokenOffset = 0;
+        size_t m_tokenLine = 0;
+        size_t m_tokenColumn = 0;
+        jsonstring m_scratch;
+
+        bool step(char c, size_t &i)
+        {
+            switch (m_state)
             {
-                Json test = parseJson(str, index, depth); // 值直接作为json解析
-                out.emplace_back(test);
+            case State::DONE:
+                if (!m_options.allowTrailingContent)
+                    return failAt(ParseErrorCode::TRAILING_CONTENT, i);
+                i = m_chunk.size();
+                return true;
+            case State::FIRST_VALUE:
+                if (c == ']')
+                    return closeContainer(i);
+                return beginValue(c, i);
+            case State::VALUE:
+                // 只有数组里逗号之后才会在VALUE状态遇到']'
+                if (c == ']' && m_options.allowTrailingCommas && !m_stack.empty() && !m_stack.frames.back().isObject)
+                    return closeContainer(i);
+                return beginValue(c, i);
+            case State::FIRST_KEY:
+                if (c == '}')
+                    return closeContainer(i);
+                return beginKey(c, i);
+            case State::KEY:
+                if (c == '}' && m_options.allowTrailingCommas)
+                    return closeContainer(i);
+                return beginKey(c, i);
+            case State::COLON:
+                if (c != ':')
+                    return failAt(ParseErrorCode::EXPECTED_COLON, i);
+                m_stack.frames.back().hasKey = true;
+                m_state = State::VALUE;
+                i++;
+                return true;
+            case State::AFTER_VALUE:
+            {
+                ParseFrame &frame = m_stack.frames.back();
+                if (c == ',')
+                {
+                    frame.index++;
+                    frame.hasKey = false;
+                    m_state = frame.isObject ? State::KEY : State::VALUE;
+                    i++;
+                    return true;
+                }
+                if (c != (frame.isObject ? '}' : ']'))
+                    return failAt(frame.isObject ? ParseErrorCode::EXPECTED_OBJECT_END : ParseErrorCode::EXPECTED_ARRAY_END, i);
+                return closeContainer(i);
+            }
             }
-            catch (const myJsonException &e)
+            return true;
+        }
+
+        bool beginValue(char c, size_t &i)
+        {
+            if (c == '{' || c == '[')
             {
-                throw myJsonException("[ERROR] array parse wrong, " + std::string(e.what()), index);
+                if (m_stack.size() >= m_options.maxDepth)
+                    return failAt(ParseErrorCode::DEPTH_EXCEEDED, i);
+                bool isObject = c == '{';
+                if (++m_ctx.nodes > m_options.maxNodes)
+                    return failAt(ParseErrorCode::TOO_MANY_NODES, i);
+                if (!(isObject ? m_handler->startObject() : m_handler->startArray()))
+                    return failAt(abortCode(), i);
+                m_stack.frames.push_back({isObject, false, 0});
+                if (isObject)
+                    m_stack.objects.emplace_back(m_ctx.resource);
+                MYJSON_STAT(maxDepth = std::max(t_stats->maxDepth, m_stack.size()));
+                m_state = isObject ? State::FIRST_KEY : State::FIRST_VALUE;
+                i++;
+                return true;
             }
-            parseWhiteSpace(str, index);
-            checkIndex(str, index);
+            if (isQuote(c))
+                startToken(Token::STRING, i);
+            else if (c == '-' || (c >= '0' && c <= '9') || (m_options.allowNanInf && (c == 'N' || c == 'I')))
+                startToken(Token::NUMBER, i);
+            else if (c >= 'a' && c <= 'z')
+                startToken(Token::LITERAL, i);
+            else
+                return failAt(ParseErrorCode::INVALID_NUMBER, i); // 和parse一样, 不认识的开头当成数字
+            return true;
+        }
 
-            if (str[index] == ']')
-                break;
-            if (str[index] != ',')
-                throw myJsonException("[ERROR] array format wrong", index);
-            index++;
+        bool beginKey(char c, size_t &i)
+        {
+            if (m_stack.frames.back().index >= m_options.maxObjectMembers)
+                return failAt(ParseErrorCode::TOO_MANY_MEMBERS, i);
+            if (!isQuote(c))
+                return failAt(ParseErrorCode::EXPECTED_KEY, i);
+            startToken(Token::KEY, i);
+            return true;
         }
-        index++;
-        return Json(out);
-    }
 
-    Json parseObject(const std::string &str, size_t &index, size_t depth)
-    {
-        object out;
-        parseWhiteSpace(str, index);
-        checkIndex(str, index);
-        if (str[index] == '}')
-            return Json(out);
-        while (1)
+        bool closeContainer(size_t &i)
         {
-            try
-            {
-                parseWhiteSpace(str, index);
-                checkIndex(str, index);
+            bool isObject = m_stack.frames.back().isObject;
+            m_stack.frames.pop_back();
+            if (isObject)
+                m_stack.objects.pop_back();
+            if (!(isObject ? m_handler->endObject() : m_handler->endArray()))
+                return failAt(abortCode(), i);
+            i++;
+            return valueDone();
+        }
 
-                std::string key = parseString(str, index).getString(); // 先解析key
+        // 建树时回调返回false只会是因为重复的key
+        ParseErrorCode abortCode() const
+        {
+            return m_handler == &m_builder && m_builder.duplicate() ? ParseErrorCode::DUPLICATE_KEY : ParseErrorCode::HANDLER_ABORTED;
+        }
 
-                parseWhiteSpace(str, index);
-                checkIndex(str, index);
+        bool isQuote(char c) const
+        {
+            return c == '\"' || (c == '\'' && m_options.allowSingleQuotes);
+        }
 
-                if (str[index] != ':') // 必须是冒号 后面跟value
-                {
-                    char _str[1] = {0};
-                    snprintf(_str, 1, "%c", str[index]);
-                    throw myJsonException("[ERROR]: object parsing, expect ':', got " + std::string(_str), index);
-                }
-                index++;
+        bool valueDone()
+        {
+            m_state = m_stack.empty() ? State::DONE : State::AFTER_VALUE;
+            return true;
+        }
 
-                parseWhiteSpace(str, index);
-                checkIndex(str, index);
+        void startToken(Token token, size_t &i)
+        {
+            m_token = token;
+            m_text.clear();
+            m_escape = false;
+            m_hexDigits = 0;
+            m_stringLength = 0;
+            m_tokenOffset = m_offset + i;
+            locate(i, m_tokenLine, m_tokenColumn);
+            if (token == Token::STRING || token == Token::KEY)
+                m_text += m_chunk[i++];
+        }
 
-                Json value = parseJson(str, index, depth); // value作为json解析
-                out.emplace(key, value);
+        bool continueToken(size_t &i)
+        {
+            const char *data = m_chunk.data();
+            size_t size = m_chunk.size();
+            size_t start = i;
+            if (m_token == Token::SLASH || m_token == Token::LINE_COMMENT || m_token == Token::BLOCK_COMMENT)
+                return continueComment(i);
+            if (m_token == Token::STRING || m_token == Token::KEY)
+            {
+                const char quote = m_text[0];
+                const size_t maxLength = m_options.maxStringLength;
+                while (i < size)
+                {
+                    char c = data[i++];
+                    if (m_escape)
+                    {
+                        m_escape = false;
+                        m_hexDigits = c == 'u' ? 4 : 0;
+                        continue;
+                    }
+                    if (c == quote)
+                    {
+                        m_text.append(data + start, i - start);
+                        return completeString();
+                    }
+                    if (m_hexDigits > 0)
+                    {
+                        m_hexDigits--;
+                        continue;
+                    }
+                    if (c == '\\')
+                        m_escape = true;
+                    // 每个字符或转义解码后至少一个字节, 不用等结束的引号就知道超长了
+                    if (++m_stringLength > maxLength)
+                        return failAt(ParseErrorCode::STRING_TOO_LONG, i - 1);
+                }
+                m_text.append(data + start, size - start);
+                return true;
             }
-            catch (const myJsonException &e)
+            if (m_token == Token::NUMBER)
             {
-                throw myJsonException("[ERROR] object parse wrong, " + std::string(e.what()), index);
+                // NaN/Infinity的字母也算进来, 交给scanNumber判断
+                const bool letters = m_options.allowNanInf;
+                while (i < size && ((data[i] >= '0' && data[i] <= '9') || data[i] == '-' || data[i] == '+' || data[i] == '.' || data[i] == 'e' || data[i] == 'E' || (letters && ((data[i] >= 'a' && data[i] <= 'z') || (data[i] >= 'A' && data[i] <= 'Z')))))
+                    i++;
             }
-
-            parseWhiteSpace(str, index);
-            checkIndex(str, index);
-
-            if (str[index] == '}')
-                break;
-            if (str[index] != ',')
-                throw myJsonException("[ERROR] object format wrong", index);
-            index++;
+            else
+            {
+                while (i < size && data[i] >= 'a' && data[i] <= 'z')
+                    i++;
+            }
+            m_text.append(data + start, i - start);
+            // 跨块的数字和字面量也不能无限长
+            if (m_token == Token::NUMBER && m_text.size() > m_options.maxStringLength)
+                return failInToken(ParseErrorCode::STRING_TOO_LONG, 0);
+            if (m_token == Token::LITERAL && m_text.size() > std::string_view("false").size())
+                return failInToken(ParseErrorCode::INVALID_LITERAL, 0);
+            return i == size || completeToken(); // 到块尾了还可能有下文
         }
-        index++;
-        return Json(out);
-    }
 
-    // index解析开始的位置 depth深度
-    Json parseJson(const std::string &in, size_t &index, size_t depth)
-    {
-        if (depth > MAXDEPTH)
+        // 注释当空白跳过, 块注释的"*/"可能跨块
+        bool continueComment(size_t &i)
         {
-            throw myJsonException("exceeded maxinum nesting depth", 0);
+            const char *data = m_chunk.data();
+            size_t size = m_chunk.size();
+            if (m_token == Token::SLASH)
+            {
+                if (data[i] != '/' && data[i] != '*')
+                    return failInToken(ParseErrorCode::INVALID_COMMENT, 0);
+                m_token = data[i] == '/' ? Token::LINE_COMMENT : Token::BLOCK_COMMENT;
+                m_escape = false;
+                i++;
+                return true;
+            }
+            if (m_token == Token::LINE_COMMENT)
+            {
+                while (i < size && data[i] != '\n')
+                    i++;
+                if (i < size)
+                    m_token = Token::NONE;
+                return true;
+            }
+            while (i < size)
+            {
+                char c = data[i++];
+                if (m_escape && c == '/')
+                {
+                    m_token = Token::NONE;
+                    return true;
+                }
+                m_escape = c == '*';
+            }
+            return true;
         }
-        parseWhiteSpace(in, index);
-        checkIndex(in, index);
-        if (in[index] == 'n') // null
+
+        bool completeString()
         {
-            return parseLiteral("null", Json(nullptr), in, index);
+            Token token = m_token;
+            m_token = Token::NONE;
+            size_t index = 0;
+            m_scratch.clear();
+            if (!parseString<true>(m_text, index, m_scratch, m_ctx))
+                return failInToken(m_error.code, m_error.offset);
+            std::string_view value(m_scratch.data(), m_scratch.size());
+            if (token == Token::KEY)
+            {
+                m_stack.objects.back().key = m_scratch;
+                m_state = State::COLON;
+                return m_handler->key(value) || failInToken(abortCode(), 0);
+            }
+            if (++m_ctx.nodes > m_options.maxNodes)
+                return failInToken(ParseErrorCode::TOO_MANY_NODES, 0);
+            if (!m_handler->string(value))
+                return failInToken(abortCode(), 0);
+            return valueDone();
         }
-        else if (in[index] == 't') // true
+
+        bool completeToken()
         {
-            return parseLiteral("true", Json(true), in, index);
+            Token token = m_token;
+            m_token = Token::NONE;
+            if (++m_ctx.nodes > m_options.maxNodes)
+                return failInToken(ParseErrorCode::TOO_MANY_NODES, 0);
+            bool ok;
+            if (token == Token::LITERAL)
+            {
+                if (m_text == "null")
+                    ok = m_handler->null();
+                else if (m_text == "true")
+                    ok = m_handler->boolean(true);
+                else if (m_text == "false")
+                    ok = m_handler->boolean(false);
+                else
+                    return failInToken(ParseErrorCode::INVALID_LITERAL, 0);
+            }
+            else
+            {
+                size_t index = 0;
+                ScannedNumber number;
+                if (!scanNumber<true>(m_text, index, m_ctx, number))
+                    return failInToken(m_error.code, m_error.offset);
+                if (index != m_text.size())
+                    return failInToken(ParseErrorCode::INVALID_NUMBER, index);
+                if (number.kind == JsonValueType::INT64)
+                    ok = m_handler->integer(number.i);
+                else if (number.kind == JsonValueType::UINT64)
+                    ok = m_handler->unsignedInteger(number.u);
+                else
+                    ok = m_handler->number(number.d);
+            }
+            if (!ok)
+                return failInToken(abortCode(), 0);
+            return valueDone();
         }
-        else if (in[index] == 'f') // false
+
+        // 当前块里第i个字节的行列号
+        // 每个token开头都要定位, 从上次数到的地方接着数, 一块只扫一遍(大块里从头数是平方的)
+        void locate(size_t i, size_t &line, size_t &column)
         {
-            return parseLiteral("false", Json(false), in, index);
+            if (i < m_locatePos)
+            {
+                m_locatePos = 0;
+                m_locateLine = m_line;
+                m_locateLineStart = m_lineStart;
+            }
+            for (; m_locatePos < i && m_locatePos < m_chunk.size(); m_locatePos++)
+            {
+                if (m_chunk[m_locatePos] == '\n')
+                {
+                    m_locateLine++;
+                    m_locateLineStart = m_offset + m_locatePos + 1;
+                }
+            }
+            line = m_locateLine;
+            column = m_offset + i - m_locateLineStart + 1;
         }
-        else if (in[index] == '\"') // start of string
+
+        // 这一块处理完了, 块之后就不再访问
+        void advance()
         {
-            return parseString(in, index);
+            size_t column;
+            locate(m_chunk.size(), m_line, column);
+            m_offset += m_chunk.size();
+            m_lineStart = m_offset + 1 - column;
+            m_chunk = std::string_view();
         }
-        else if (in[index] == '[') // start of array
+
+        bool failWith(ParseErrorCode code, size_t offset, size_t line, size_t column)
         {
-            return parseArray(in, ++index, ++depth);
+            m_error.code = code;
+            m_error.offset = offset;
+            m_error.line = line;
+            m_error.column = column;
+            PathWriter writer(m_error.path);
+            writePath(writer, m_stack);
+            MYJSON_STAT(errors++);
+            return false;
         }
-        else if (in[index] == '{') // start of object
+
+        bool failAt(ParseErrorCode code, size_t i)
         {
-            return parseObject(in, ++index, ++depth);
+            size_t line, column;
+            locate(i, line, column);
+            return failWith(code, m_offset + i, line, column);
         }
-        else
+
+        // token里第k个字节
+        bool failInToken(ParseErrorCode code, size_t k)
         {
-            return parseNumber(in, index);
+            size_t line = m_tokenLine;
+            size_t column = m_tokenColumn + k;
+            for (size_t j = 0; j < k && j < m_text.size(); j++)
+            {
+                if (m_text[j] == '\n')
+                {
+                    line++;
+                    column = k - j;
+                }
+            }
+            return failWith(code, m_tokenOffset + k, line, column);
         }
+    };
+
+    StreamParser::StreamParser(const ParseOptions &options)
+        : m_impl(std::make_unique<Impl>(nullptr, options)) {}
+
+    StreamParser::StreamParser(JsonHandler &handler, const ParseOptions &options)
+        : m_impl(std::make_unique<Impl>(&handler, options)) {}
+
+    StreamParser::~StreamParser() {}
+
+    bool StreamParser::feed(std::string_view chunk)
+    {
+        size_t consumed;
+        return m_impl->feed(chunk, false, consumed);
     }
 
-    // json parse
-    Json parse(const std::string &in)
+    bool StreamParser::feed(std::string_view chunk, size_t &consumed)
     {
-        size_t index = 0;
-        size_t depth = 0;
-        return parseJson(in, index, depth);
+        return m_impl->feed(chunk, true, consumed);
+    }
+
+    bool StreamParser::finish()
+    {
+        return m_impl->finish();
+    }
+
+    bool StreamParser::done() const
+    {
+        return m_impl->done();
+    }
+
+    const ParseError &StreamParser::error() const
+    {
+        return m_impl->m_error;
+    }
+
+    Json StreamParser::release()
+    {
+        return m_impl->release();
     }
 }
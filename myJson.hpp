@@ -6,9 +6,17 @@
 //
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
-#define MAXDEPTH 10 // object最大嵌套深度
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <ostream>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#define MAXDEPTH 512 // 默认的最大嵌套深度, 可以用ParseOptions::maxDepth改
 
 #define THROW_INVALID_TYPE_EXCEPTION(type)         \
     const char *str_type = myJson::toString(type); \
@@ -17,8 +25,19 @@
 namespace myJson
 {
     class Json;
-    using array = std::vector<Json>;
-    using object = std::map<std::string, Json>;
+    class JsonValue;
+
+    // 对象的key按字节序比较, 支持直接用std::string/string_view/const char*查找
+    struct KeyLess
+    {
+        using is_transparent = void;
+        bool operator()(std::string_view lhs, std::string_view rhs) const noexcept { return lhs < rhs; }
+    };
+
+    // 容器和字符串都用pmr, 内存来自节点所属的memory_resource
+    using jsonstring = std::pmr::string;
+    using array = std::pmr::vector<Json>;
+    using object = std::pmr::map<jsonstring, Json, KeyLess>;
     using arrayiter = array::iterator;
     using const_arrayiter = array::const_iterator;
     using objectiter = object::iterator;
@@ -43,7 +62,140 @@ namespace myJson
         BOOL,   // bool true/false
         STRING, // 字符串
         ARRAY,  // 数组
-        OBJECT  // 对象
+        OBJECT, // 对象
+        INT64,  // 有符号整数, 不经过double所以不会丢精度
+        UINT64  // 超过int64范围的无符号整数
+    };
+    const size_t JSON_VALUE_TYPE_COUNT = 8;
+    inline const char *toString(JsonValueType type);
+
+    // 对象里重复的key怎么处理
+    enum class DuplicateKeys
+    {
+        FIRST, // 保留第一个
+        LAST,  // 后面的覆盖前面的, 和addToObject一样(默认)
+        REJECT // 报DUPLICATE_KEY(不叫ERROR, windows.h里有这个宏)
+    };
+
+    // 解析选项
+    // 默认严格按RFC 8259, 下面的扩展语法要显式打开; 全部关着时走的是不带任何扩展判断的那一份解析代码
+    struct ParseOptions
+    {
+        // 数字保留原始文本, dump时原样输出(比uint64还大的数或者高精度小数也不会丢位)
+        bool keepNumberText = false;
+        // 最大嵌套深度, 解析用的是堆上的显式栈, 开到几千也不会爆栈
+        // 不过析构/dump/拷贝还是递归的, 不要开到几万以上
+        size_t maxDepth = MAXDEPTH;
+
+        // 面对不可信的输入时的限制, 解析过程中边解析边检查, 超了马上失败, 默认不限制
+        size_t maxInputBytes = SIZE_MAX;    // 输入的总字节数
+        size_t maxNodes = SIZE_MAX;         // 节点总数(每个null/数字/字符串/数组/对象都算一个)
+        size_t maxStringLength = SIZE_MAX;  // 单个字符串(包括key)解码后的长度, 数字的文本也算
+        size_t maxObjectMembers = SIZE_MAX; // 单个对象的成员数
+        size_t memoryBudget = SIZE_MAX;     // 估算的内存: 节点 + 字符串内容 + 容器元素, 不含分配器自己的开销
+
+        // 扩展语法
+        bool allowComments = false;        // // 行注释和 /* */ 块注释, 出现在空白可以出现的地方
+        bool allowTrailingCommas = false;  // [1, 2,] {"a": 1,}
+        bool allowNanInf = false;          // NaN Infinity -Infinity
+        bool allowSingleQuotes = false;    // 'string', 里面的\'是单引号
+        bool allowTrailingContent = false; // 根值后面的内容忽略, 不报TRAILING_CONTENT
+        DuplicateKeys duplicateKeys = DuplicateKeys::LAST; // SAX不建对象, 每个key都会回调, 不受这个影响
+
+        // 上面的扩展全部打开
+        static ParseOptions relaxed()
+        {
+            ParseOptions options;
+            options.allowComments = options.allowTrailingCommas = options.allowNanInf = true;
+            options.allowSingleQuotes = options.allowTrailingContent = true;
+            return options;
+        }
+    };
+
+    // 解析错误码
+    enum class ParseErrorCode
+    {
+        NONE,
+        UNEXPECTED_END,        // 输入提前结束
+        INVALID_LITERAL,       // null/true/false拼错
+        INVALID_ESCAPE,        // 字符串里不认识的转义, 包括\u后面不是4位十六进制和落单的代理
+        INVALID_NUMBER,        // 数字格式不对
+        NUMBER_OUT_OF_RANGE,   // 超出double范围
+        EXPECTED_KEY,          // 对象成员必须以字符串key开头
+        EXPECTED_COLON,        // key后面必须是冒号
+        EXPECTED_ARRAY_END,    // 数组元素后面必须是','或']'
+        EXPECTED_OBJECT_END,   // 对象成员后面必须是','或'}'
+        DEPTH_EXCEEDED,        // 嵌套太深
+        INPUT_TOO_LARGE,       // 超过maxInputBytes
+        TOO_MANY_NODES,        // 超过maxNodes
+        STRING_TOO_LONG,       // 超过maxStringLength
+        TOO_MANY_MEMBERS,      // 超过maxObjectMembers
+        MEMORY_BUDGET_EXCEEDED, // 超过memoryBudget
+        HANDLER_ABORTED,       // JsonHandler的回调返回了false
+        INVALID_CHARACTER,     // 字符串里没有转义的控制字符(0x00-0x1F)
+        TRAILING_CONTENT,      // 根值后面还有别的内容
+        DUPLICATE_KEY,         // DuplicateKeys::REJECT时遇到重复的key
+        INVALID_COMMENT        // '/'后面不是'/'或'*'
+    };
+
+    // 解析失败的位置和原因, 全部是定长的, 出错时不分配内存
+    struct ParseError
+    {
+        static const size_t PATH_CAPACITY = 128;
+
+        ParseErrorCode code = ParseErrorCode::NONE;
+        size_t offset = 0; // 出错的字节偏移
+        size_t line = 0;   // 从1开始
+        size_t column = 0; // 从1开始, 按字节算
+        // 出错时所在的位置, 比如 $.users[3].name, 太长会截断成 ...
+        char path[PATH_CAPACITY] = {};
+
+        explicit operator bool() const { return code != ParseErrorCode::NONE; }
+        const char *message() const;
+    };
+
+    // Json占用的内存, 按std的实现估算, 不含分配器自己的开销(malloc的块头, 池子里空闲的内存)
+    struct MemoryUsage
+    {
+        struct Entry
+        {
+            size_t count = 0;
+            size_t bytes = 0; // 节点本身 + 它持有的字符串/数组缓冲区/map节点, 子节点算在子节点的类型上
+        };
+        Entry types[JSON_VALUE_TYPE_COUNT]; // 按JsonValueType做下标
+
+        size_t nodeBytes = 0;      // 所有节点本身
+        size_t stringBytes = 0;    // 字符串和key在堆上的部分, 短字符串在节点里不算
+        size_t containerBytes = 0; // 数组的元素缓冲区和map的节点
+        size_t slackBytes = 0;     // 上面两项里预留了没用上的, shrink_to_fit能还回去
+
+        size_t total() const { return nodeBytes + stringBytes + containerBytes; }
+        const Entry &operator[](JsonValueType type) const { return types[static_cast<size_t>(type)]; }
+    };
+
+    // 节点的删除器, 记住节点是从哪个memory_resource分配的
+    struct JsonValueDeleter
+    {
+        std::pmr::memory_resource *resource = nullptr;
+        void operator()(JsonValue *value) const noexcept;
+    };
+    using JsonValuePtr = std::unique_ptr<JsonValue, JsonValueDeleter>;
+
+    // 节点的类型和内容, 一次虚调用拿到, visit/transform用
+    // type是INT64/UINT64/NUMBER时分别看int64/uint64/number, 容器和字符串是指向节点里的指针
+    struct JsonView
+    {
+        JsonValueType type;
+        union
+        {
+            bool boolean;
+            int64_t int64;
+            uint64_t uint64;
+            double number;
+            const jsonstring *string;
+            const array *items;
+            const object *members;
+        };
     };
 
     // JsonValue基础类类 定义接口函数
@@ -53,44 +205,63 @@ namespace myJson
         // get the type
         virtual JsonValueType type() const = 0;
 
+        // 按内容算的hash, 容器会缓存
+        virtual uint64_t hash() const = 0;
+        // 已经缓存的hash, 没有缓存返回0
+        virtual uint64_t cachedHash() const = 0;
+
         // compare
         virtual bool equals(const JsonValue *other) const = 0;
         virtual bool less(const JsonValue *other) const = 0;
 
         // get
         virtual double getNumber() const = 0;
+        virtual int64_t getInt64() const = 0;
+        virtual uint64_t getUint64() const = 0;
         virtual bool getBool() const = 0;
-        virtual const std::string &getString() const = 0;
+        virtual const jsonstring &getString() const = 0;
         virtual const array &getArray() const = 0;
         virtual const object &getObject() const = 0;
 
         // operatot []
         virtual Json &operator[](size_t index) = 0;
-        virtual Json &operator[](const std::string &key) = 0;
+        virtual Json &operator[](std::string_view key) = 0;
         virtual const Json &operator[](size_t index) const = 0;
-        virtual const Json &operator[](const std::string &key) const = 0;
+        virtual const Json &operator[](std::string_view key) const = 0;
 
         // set
         virtual void setNumber(double value) = 0;
         virtual void setBool(bool value) = 0;
-        virtual void setString(const std::string &value) = 0;
+        virtual void setString(std::string_view value) = 0;
         virtual void setArray(const array &value) = 0;
         virtual void setObject(const object &value) = 0;
 
         // add
         virtual void addToArray(const Json &value) = 0;
-        virtual void addToObject(const std::string &key, const Json &value) = 0;
+        virtual void insertToArray(size_t index, const Json &value) = 0;
+        virtual void addToObject(std::string_view key, const Json &value) = 0;
 
         // remove
         virtual void removeFromArray(size_t index) = 0;
-        virtual void removeFromObject(const std::string &key) = 0;
+        virtual void removeFromObject(std::string_view key) = 0;
 
-        // clone
-        virtual std::unique_ptr<JsonValue> clone() const = 0;
+        // clone, 新节点从resource分配
+        virtual JsonValuePtr clone(std::pmr::memory_resource *resource) const = 0;
+        // 节点本身占用的字节数, 释放时要用
+        virtual size_t allocSize() const = 0;
+        // 把节点本身和它直接持有的堆内存记到usage上, 不含子节点
+        virtual void measure(MemoryUsage &usage) const = 0;
+        // 还回字符串和数组的预留空间, 容器递归到子节点
+        virtual void shrinkToFit() = 0;
 
         // dump
         virtual void dump(std::string &str, size_t depth) const = 0;
 
+        // 类型和内容一起拿
+        virtual JsonView view() const = 0;
+        // 要改内容时用, 和operator[]一样算交出了子节点, 容器以后不再缓存hash
+        virtual JsonView mutableView() = 0;
+
         // iter
         virtual arrayiter arrayBegin() = 0;
         virtual const_arrayiter const_arrayBegin() const = 0;
@@ -108,62 +279,121 @@ namespace myJson
     class Json
     {
     private:
-        std::unique_ptr<JsonValue> m_ptr;
+        JsonValuePtr m_ptr;
+
+        static JsonValuePtr makeInt64(int64_t value);
+        static JsonValuePtr makeUint64(uint64_t value);
 
     public:
+        // 有allocator_type, pmr容器构造元素时会把自己的resource传进来, 整棵树用同一个resource
+        using allocator_type = std::pmr::polymorphic_allocator<Json>;
+
         // constructor
         Json() noexcept;
+        explicit Json(const allocator_type &alloc);
         Json(std::nullptr_t) noexcept;
-        Json(int value);
+        // 所有整数类型(bool除外)都走这里, 按有无符号存成INT64/UINT64
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+        Json(T value)
+        {
+            if (std::is_signed<T>::value)
+                m_ptr = makeInt64(static_cast<int64_t>(value));
+            else
+                m_ptr = makeUint64(static_cast<uint64_t>(value));
+        }
         Json(double value);
         Json(bool value);
         Json(const std::string &value);
         Json(std::string &&value);
+        Json(const jsonstring &value);
+        Json(jsonstring &&value);
         Json(const char *value);
         Json(const array &value);
         Json(array &&value);
         Json(const object &value);
         Json(object &&value);
 
+        // 直接接管一个节点, 内部构造特殊节点时用
+        explicit Json(JsonValuePtr value) noexcept;
+
+        // 拷贝构造和pmr容器一样, 新值用默认resource
         Json(const Json &other);
         Json(Json &&other) noexcept;
 
+        // 在alloc上构造, 和pmr容器的uses-allocator约定一致
+        Json(const Json &other, const allocator_type &alloc);
+        Json(Json &&other, const allocator_type &alloc);
+        template <typename T, typename std::enable_if<!std::is_same<typename std::decay<T>::type, Json>::value &&
+                                                          !std::is_same<typename std::decay<T>::type, std::allocator_arg_t>::value,
+                                                      int>::type = 0>
+        Json(T &&value, const allocator_type &alloc)
+            : Json(Json(std::forward<T>(value)), alloc) {}
+
+        allocator_type get_allocator() const;
+        std::pmr::memory_resource *resource() const;
+
         ~Json() noexcept;
 
+        // 一次虚调用拿到类型和内容, 见myJsonVisit.hpp
+        JsonView view() const
+        {
+            check();
+            return m_ptr->view();
+        }
+        JsonView mutableView()
+        {
+            check();
+            return m_ptr->mutableView();
+        }
+
         // 判断类型
         JsonValueType type() const;
         bool is_null() const;
-        bool is_number() const;
+        bool is_number() const; // NUMBER/INT64/UINT64都算
+        bool is_integer() const;
         bool is_bool() const;
         bool is_string() const;
         bool is_array() const;
         bool is_object() const;
 
         double getNumber() const;
+        int64_t getInt64() const;   // 超出范围或者不是整数会抛异常
+        uint64_t getUint64() const; // 同上
+        std::string getNumberText() const;
         bool getBool() const;
-        const std::string &getString() const;
+        const jsonstring &getString() const;
         const array &getArray() const;
         const object &getObject() const;
 
         void setNumber(double value);
         void setBool(double value);
-        void setString(const std::string &value);
+        void setString(std::string_view value);
         void setArray(const array &value);
         void setObject(const object &value);
 
         void addToArray(const Json &value);
-        void addToObject(const std::string &key, const Json &value);
+        void insertToArray(size_t index, const Json &value); // 插到index前面, index可以等于size
+        void addToObject(std::string_view key, const Json &value);
         void removeFromArray(size_t index);
-        void removeFromObject(const std::string &key);
+        void removeFromObject(std::string_view key);
 
         // compare
         Json &operator[](size_t index);
-        Json &operator[](const std::string &key);
+        Json &operator[](std::string_view key);
         const Json &operator[](size_t index) const;
-        const Json &operator[](const std::string &key) const;
+        const Json &operator[](std::string_view key) const;
+        // 赋值保留自己的resource, resource不同时会拷贝到自己的resource上
         Json &operator=(const Json &other);
-        Json &operator=(Json &&other) noexcept;
+        Json &operator=(Json &&other);
+
+        // 按内容算的64位hash(XXH64), 不同进程/机器上结果一样
+        // 和operator==一致: 相等的值hash一样, 包括1和1.0这种跨类型相等的数字
+        // 数组和对象的hash缓存在节点上, 修改只清被改的容器自己的缓存
+        // 交出过子节点非const引用的容器(operator[], 迭代器, mutableView, transform走过的)以后每次都重新合并子节点的hash,
+        // 所以拿着子节点的引用跨过hash()再改也不会过期; 要整棵树都缓存, 拷贝一份
+        uint64_t hash() const;
 
+        // 两边都缓存了hash时先比hash
         bool operator==(const Json &other) const;
         bool operator<(const Json &other) const;
         // 下面的都是用上面的2个重载
@@ -175,6 +405,17 @@ namespace myJson
         const std::string dump() const;
         void dump(std::string &str, size_t depth) const;
 
+        // 整棵树占的内存, 带按类型的明细, 缓存按字节数做预算时用
+        MemoryUsage memoryUsage() const;
+        // 还回字符串和数组的预留空间(parse时逐步增长留下的, remove之后空出来的), 不换resource
+        // 不改内容, 缓存的hash保留
+        void shrink_to_fit();
+        // 按深度优先的顺序把整棵树重新拷贝到resource上(默认是自己的resource)再换掉旧的, 拷贝没有预留空间
+        // 传monotonic_buffer_resource进来整棵树就在一块连续的内存里, resource要比树活得久
+        // 拷贝期间新旧两份同时存在
+        void compact();
+        void compact(std::pmr::memory_resource *resource);
+
         arrayiter arrayBegin();
         const_arrayiter const_arrayBegin() const;
         arrayiter arrayEnd();
@@ -193,7 +434,277 @@ namespace myJson
         }
     };
 
+    // dump()里容器的格式, 并行dump分段拼接时也用这一份, 保证和dump()逐字节一样
+    struct DumpFormat
+    {
+        static void beginArray(std::string &str, size_t depth);
+        // 第index个元素前面的分隔
+        static void arrayItem(std::string &str, size_t index, size_t depth);
+        static void endArray(std::string &str, size_t count, size_t depth);
+        static void beginObject(std::string &str, size_t depth);
+        // 第index个成员value前面的部分, 包括key
+        static void objectMember(std::string &str, size_t index, const jsonstring &key, size_t depth);
+        static void endObject(std::string &str, size_t count, size_t depth);
+    };
+
     Json parse(const std::string &in);
+    Json parse(const std::string &in, const ParseOptions &options);
+    // 所有节点, 字符串和容器都从resource分配, 返回的Json不能比resource活得久
+    Json parse(const std::string &in, std::pmr::memory_resource *resource);
+    Json parse(const std::string &in, const ParseOptions &options, std::pmr::memory_resource *resource);
+    // 不抛异常的版本, 失败时返回null并填好error, 成功时error.code是NONE
+    // 上面抛异常的版本都是在这之上包了一层
+    Json parse(const std::string &in, ParseError &error);
+    Json parse(const std::string &in, const ParseOptions &options, ParseError &error);
+    Json parse(const std::string &in, const ParseOptions &options, std::pmr::memory_resource *resource, ParseError &error);
+
+    // SAX回调: 解析时不建树, 每个值或者容器的开头结尾调一次
+    // 回调返回false就停止解析, 错误码是HANDLER_ABORTED
+    // string和key的参数只在回调期间有效
+    class JsonHandler
+    {
+    public:
+        virtual ~JsonHandler() = default;
+
+        virtual bool null() { return true; }
+        virtual bool boolean(bool) { return true; }
+        virtual bool integer(int64_t) { return true; }
+        virtual bool unsignedInteger(uint64_t) { return true; } // 超过int64范围的
+        virtual bool number(double) { return true; }
+        virtual bool string(std::string_view) { return true; }
+        virtual bool startObject() { return true; }
+        virtual bool key(std::string_view) { return true; }
+        virtual bool endObject() { return true; }
+        virtual bool startArray() { return true; }
+        virtual bool endArray() { return true; }
+    };
+
+    // 按SAX方式解析, options里除了keepNumberText和memoryBudget都生效, 成功返回true
+    bool parse(const std::string &in, JsonHandler &handler, ParseError &error);
+    bool parse(const std::string &in, const ParseOptions &options, JsonHandler &handler, ParseError &error);
+
+    // 抛出和parse一样格式的myJsonException: 消息 at line L column C (path)
+    [[noreturn]] void throwParseError(const ParseError &error);
+
+    // parse/dump的统计, 编译时定义MYJSON_ENABLE_STATS才会收集, 否则StatsScope是空的, 没有任何开销
+    // 用法: JsonStats stats; { StatsScope scope(stats); parse(...); json.dump(); } 然后导出stats
+    // 统计挂在当前线程上, scope可以嵌套, 内层的结束后恢复外层的
+    struct JsonStats
+    {
+        // parse
+        size_t parses = 0;
+        size_t parseBytes = 0;
+        size_t nodes[JSON_VALUE_TYPE_COUNT] = {}; // 下标是JsonValueType
+        size_t allocations = 0;                   // 节点/字符串/容器的分配次数
+        size_t maxDepth = 0;
+        size_t errors = 0;
+        uint64_t parseNanos = 0;
+        uint64_t stringNanos = 0;  // parseString, 包括key
+        uint64_t numberNanos = 0;  // parseNumber
+        uint64_t literalNanos = 0; // null/true/false
+        uint64_t errorNanos = 0;   // 出错之后算行列号和路径
+        // dump
+        size_t dumps = 0;
+        size_t dumpBytes = 0;
+        uint64_t dumpNanos = 0;
+
+        // 剩下的时间花在容器上(结构字符, 扩容, 插入)
+        uint64_t containerNanos() const
+        {
+            uint64_t leaves = stringNanos + numberNanos + literalNanos + errorNanos;
+            return parseNanos > leaves ? parseNanos - leaves : 0;
+        }
+
+        size_t nodeCount(JsonValueType type) const { return nodes[static_cast<size_t>(type)]; }
+
+        // 按(名字, 值)逐个导出, 方便接到监控系统
+        template <typename F>
+        void forEach(F &&f) const
+        {
+            f("parses", uint64_t(parses));
+            f("parse_bytes", uint64_t(parseBytes));
+            for (size_t i = 0; i < JSON_VALUE_TYPE_COUNT; i++)
+            {
+                f((std::string("nodes_") + toString(static_cast<JsonValueType>(i))).c_str(), uint64_t(nodes[i]));
+            }
+            f("allocations", uint64_t(allocations));
+            f("max_depth", uint64_t(maxDepth));
+            f("errors", uint64_t(errors));
+            f("parse_nanos", parseNanos);
+            f("string_nanos", stringNanos);
+            f("number_nanos", numberNanos);
+            f("literal_nanos", literalNanos);
+            f("error_nanos", errorNanos);
+            f("container_nanos", containerNanos());
+            f("dumps", uint64_t(dumps));
+            f("dump_bytes", uint64_t(dumpBytes));
+            f("dump_nanos", dumpNanos);
+        }
+    };
+
+#ifdef MYJSON_ENABLE_STATS
+    class StatsScope
+    {
+    public:
+        explicit StatsScope(JsonStats &stats);
+        ~StatsScope();
+        StatsScope(const StatsScope &) = delete;
+        StatsScope &operator=(const StatsScope &) = delete;
+
+    private:
+        JsonStats *m_previous;
+    };
+#else
+    class StatsScope
+    {
+    public:
+        explicit StatsScope(JsonStats &) {}
+        StatsScope(const StatsScope &) = delete;
+        StatsScope &operator=(const StatsScope &) = delete;
+    };
+#endif
+
+    // 可以复用的解析器, 适合反复解析形状差不多的文档
+    // 节点和容器都从内部的池子分配, 释放后按大小放回各自的空闲链表, 下次parse直接复用
+    // 预热之后再解析同样形状的文档基本不会向堆要内存
+    // 注意: parse出来的Json必须在Parser之前销毁, Parser不是线程安全的
+    class Parser
+    {
+    public:
+        struct Counters
+        {
+            size_t parses = 0;              // parse次数
+            size_t allocations = 0;         // 节点/字符串/容器向池子要内存的次数
+            size_t upstreamAllocations = 0; // 池子向堆要内存的次数, 预热后应该不再增长
+            size_t upstreamBytes = 0;       // 当前从堆上持有的字节数(包括空闲链表里缓存的)
+            size_t bytesInUse = 0;          // 当前还被Json占用的字节数
+        };
+
+        explicit Parser(const ParseOptions &options = ParseOptions());
+        ~Parser();
+        Parser(const Parser &) = delete;
+        Parser &operator=(const Parser &) = delete;
+
+        Json parse(const std::string &in);
+        Json parse(const std::string &in, ParseError &error);
+
+        const Counters &counters() const;
+        // 清零累计的计数(upstreamBytes/bytesInUse是当前值, 不清)
+        void resetCounters();
+        // 把缓存的内存都还给堆, 调用时不能还有活着的Json
+        void release();
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    // 增量解析: 输入分块到达时每块feed一次, 已经到的部分马上解析, 不用等全部到齐再从头来
+    // 不带handler时建树, 最后用release取结果; 带handler时只发SAX事件
+    // 跨块的字符串/数字先攒在内部的小buffer里, 其余的直接在块上解析, 块在feed返回后就可以释放
+    // options里除了keepNumberText和memoryBudget都生效
+    class StreamParser
+    {
+    public:
+        explicit StreamParser(const ParseOptions &options = ParseOptions());
+        explicit StreamParser(JsonHandler &handler, const ParseOptions &options = ParseOptions());
+        ~StreamParser();
+        StreamParser(const StreamParser &) = delete;
+        StreamParser &operator=(const StreamParser &) = delete;
+
+        // 出错返回false, 之后的feed都直接返回false
+        bool feed(std::string_view chunk);
+        // 同上, 但根值一结束就停下, consumed返回用掉的字节数; 同一个流上的下一条消息从chunk[consumed]开始
+        // 根是数字时要看到后面的分隔符才知道结束, 这时consumed可能是0
+        bool feed(std::string_view chunk, size_t &consumed);
+        // 输入结束了, 根值完整才返回true
+        bool finish();
+        // 根值已经解析完
+        bool done() const;
+        const ParseError &error() const;
+        // 建树模式下取走结果, 出错时是null
+        Json release();
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    inline bool isNumberType(JsonValueType type)
+    {
+        return type == JsonValueType::NUMBER || type == JsonValueType::INT64 || type == JsonValueType::UINT64;
+    }
+
+    // 解码字符串里的\uXXXX, pos指向'u', 高代理后面必须紧跟\u低代理, 合起来是一个码点
+    // 成功时按UTF-8写进utf8, 返回字节数(1-4), pos移到最后一个十六进制数字上; 格式不对返回0, pos不动
+    // parse/SAX/StreamParser/BindReader/_json字面量/JsonEditor都用这一个, 保证解出来的字节一样
+    constexpr int hexDigit(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    constexpr long readHex4(std::string_view text, size_t pos)
+    {
+        if (pos > text.size() || text.size() - pos < 4)
+            return -1;
+        long value = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            int digit = hexDigit(text[pos + i]);
+            if (digit < 0)
+                return -1;
+            value = value * 16 + digit;
+        }
+        return value;
+    }
+
+    constexpr size_t decodeUnicodeEscape(std::string_view text, size_t &pos, char (&utf8)[4])
+    {
+        long code = readHex4(text, pos + 1);
+        size_t last = pos + 4;
+        if (code < 0 || (code >= 0xDC00 && code <= 0xDFFF))
+            return 0;
+        if (code >= 0xD800 && code <= 0xDBFF)
+        {
+            if (last + 2 >= text.size() || text[last + 1] != '\\' || text[last + 2] != 'u')
+                return 0;
+            long low = readHex4(text, last + 3);
+            if (low < 0xDC00 || low > 0xDFFF)
+                return 0;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            last += 6;
+        }
+        pos = last;
+        if (code < 0x80)
+        {
+            utf8[0] = static_cast<char>(code);
+            return 1;
+        }
+        if (code < 0x800)
+        {
+            utf8[0] = static_cast<char>(0xC0 | (code >> 6));
+            utf8[1] = static_cast<char>(0x80 | (code & 0x3F));
+            return 2;
+        }
+        if (code < 0x10000)
+        {
+            utf8[0] = static_cast<char>(0xE0 | (code >> 12));
+            utf8[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            utf8[2] = static_cast<char>(0x80 | (code & 0x3F));
+            return 3;
+        }
+        utf8[0] = static_cast<char>(0xF0 | (code >> 18));
+        utf8[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        utf8[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        utf8[3] = static_cast<char>(0x80 | (code & 0x3F));
+        return 4;
+    }
 
     inline const char *toString(JsonValueType type)
     {
@@ -211,6 +722,10 @@ namespace myJson
             return "array";
         case myJson::JsonValueType::OBJECT:
             return "object";
+        case myJson::JsonValueType::INT64:
+            return "int64";
+        case myJson::JsonValueType::UINT64:
+            return "uint64";
         default:
             return "unkown";
         }
@@ -221,3 +736,13 @@ namespace myJson
         return os << std::string(toString(type));
     }
 };
+
+namespace std
+{
+    // 可以直接放进unordered_map/unordered_set
+    template <>
+    struct hash<myJson::Json>
+    {
+        size_t operator()(const myJson::Json &json) const { return static_cast<size_t>(json.hash()); }
+    };
+}
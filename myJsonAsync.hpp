@@ -0,0 +1,210 @@
+//
+//  myJsonAsync.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  C++20协程上的异步parse: 数据一块块到达, 每块到了就交给StreamParser, 没数据时协程挂起, 不占线程
+//
+//      Task<Json> handle(Connection &conn)
+//      {
+//          Json body = co_await myJson::parseAsync(conn);
+//          ...
+//      }
+//
+//  source只要求 co_await source.read() 返回 std::optional<块>, 块能转成std::string_view,
+//  nullopt表示输入结束. 块在下一次read之前必须有效
+//  source还有 unread(std::string) 的话, 块里根值之后的字节放回去, 同一个连接上可以一条接一条地parse;
+//  没有的话一块不能跨两条消息, 根值后面的内容和parse一样报错(或者按allowTrailingContent丢掉)
+//  AsyncPipe是内存里的source, 测试和单线程的事件循环里用
+//
+#pragma once
+#if __cplusplus < 202002L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#error "myJsonAsync.hpp requires C++20"
+#endif
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    // 最小的lazy协程: 被co_await时才开始执行, 结束时直接切回等它的协程(对称转移, 栈不会越来越深)
+    // 不在协程里时用start()启动, 挂起之后由source负责恢复
+    template <typename T>
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            std::optional<T> value;
+            std::exception_ptr exception;
+            std::coroutine_handle<> continuation;
+
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            template <typename U>
+            void return_value(U &&result) { value.emplace(std::forward<U>(result)); }
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        ~Task()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            m_handle.promise().continuation = awaiting;
+            return m_handle;
+        }
+        T await_resume() { return result(); }
+
+        void start()
+        {
+            if (!m_handle.done())
+                m_handle.resume();
+        }
+        bool done() const { return m_handle.done(); }
+        // 协程里抛出的异常在这里重新抛出
+        T result()
+        {
+            if (m_handle.promise().exception)
+                std::rethrow_exception(m_handle.promise().exception);
+            return std::move(*m_handle.promise().value);
+        }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    // 单生产者单消费者, 不加锁, 生产和消费在同一个线程(事件循环)里
+    class AsyncPipe
+    {
+    public:
+        // 有协程在等就在这里直接恢复它
+        void write(std::string chunk)
+        {
+            m_chunks.push_back(std::move(chunk));
+            wake();
+        }
+
+        void close()
+        {
+            m_closed = true;
+            wake();
+        }
+
+        struct ReadAwaiter
+        {
+            AsyncPipe &pipe;
+
+            bool await_ready() const noexcept { return !pipe.m_chunks.empty() || pipe.m_closed; }
+            void await_suspend(std::coroutine_handle<> handle) noexcept { pipe.m_waiting = handle; }
+            std::optional<std::string> await_resume()
+            {
+                if (pipe.m_chunks.empty())
+                    return std::nullopt;
+                std::string chunk = std::move(pipe.m_chunks.front());
+                pipe.m_chunks.pop_front();
+                return chunk;
+            }
+        };
+
+        // 关闭并且读完之后返回nullopt
+        ReadAwaiter read() { return ReadAwaiter{*this}; }
+
+        // 放回队头, 下一次read先读到它
+        void unread(std::string chunk) { m_chunks.push_front(std::move(chunk)); }
+
+    private:
+        std::deque<std::string> m_chunks;
+        bool m_closed = false;
+        std::coroutine_handle<> m_waiting;
+
+        void wake()
+        {
+            if (m_waiting)
+                std::exchange(m_waiting, {}).resume();
+        }
+    };
+
+    namespace async
+    {
+        // 喂一块, 根值之后的字节能放回source就放回去
+        template <typename Source>
+        bool feedChunk(StreamParser &parser, Source &source, std::string_view chunk)
+        {
+            if constexpr (requires { source.unread(std::string()); })
+            {
+                size_t consumed;
+                if (!parser.feed(chunk, consumed))
+                    return false;
+                if (consumed < chunk.size())
+                    source.unread(std::string(chunk.substr(consumed)));
+                return true;
+            }
+            else
+            {
+                return parser.feed(chunk);
+            }
+        }
+    }
+
+    // 根值完整之后就不再读了, source支持unread时同一块里后面的数据留给下一次parse
+    // 格式错误抛myJsonException, 和parse一样
+    template <typename Source>
+    Task<Json> parseAsync(Source &source, ParseOptions options = ParseOptions())
+    {
+        StreamParser parser(options);
+        while (!parser.done())
+        {
+            auto chunk = co_await source.read();
+            if (!chunk || !async::feedChunk(parser, source, std::string_view(*chunk)))
+                break;
+        }
+        if (!parser.finish())
+            throwParseError(parser.error());
+        co_return parser.release();
+    }
+
+    // 只发SAX事件, 不建树. 出错时返回false并填好error
+    template <typename Source>
+    Task<bool> parseAsync(Source &source, JsonHandler &handler, ParseError &error, ParseOptions options = ParseOptions())
+    {
+        StreamParser parser(handler, options);
+        while (!parser.done())
+        {
+            auto chunk = co_await source.read();
+            if (!chunk || !async::feedChunk(parser, source, std::string_view(*chunk)))
+                break;
+        }
+        bool ok = parser.finish();
+        error = parser.error();
+        co_return ok;
+    }
+}
@@ -0,0 +1,449 @@
+//
+//  myJsonBind.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonBind.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace myJson
+{
+    // 数字的十进制量级, 定义在myJson.cpp, 和parse()用同一个判断分开溢出和下溢
+    int64_t decimalMagnitude(std::string_view text);
+
+    namespace bind
+    {
+        ///////////////BindReader//////////////////////
+        void BindReader::skipWhiteSpace()
+        {
+            while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+                m_pos++;
+        }
+
+        void BindReader::error(const char *message) const
+        {
+            throw myJsonException(std::string("[ERROR] bind: ") + message + " at offset " + std::to_string(position()), position());
+        }
+
+        char BindReader::peek()
+        {
+            skipWhiteSpace();
+            if (m_pos == m_end)
+                error("unexpected end");
+            return *m_pos;
+        }
+
+        void BindReader::expect(char c)
+        {
+            if (peek() != c)
+            {
+                char message[] = "expected ' '";
+                message[10] = c;
+                error(message);
+            }
+            m_pos++;
+        }
+
+        bool BindReader::consume(char c)
+        {
+            skipWhiteSpace();
+            if (m_pos == m_end || *m_pos != c)
+                return false;
+            m_pos++;
+            return true;
+        }
+
+        void BindReader::finish()
+        {
+            skipWhiteSpace();
+            if (m_pos != m_end)
+                error("trailing characters");
+        }
+
+        bool BindReader::readNull()
+        {
+            if (peek() != 'n')
+                return false;
+            if (m_end - m_pos < 4 || std::string_view(m_pos, 4) != "null")
+                error("invalid literal");
+            m_pos += 4;
+            return true;
+        }
+
+        bool BindReader::readBool()
+        {
+            char c = peek();
+            if (c == 't' && m_end - m_pos >= 4 && std::string_view(m_pos, 4) == "true")
+            {
+                m_pos += 4;
+                return true;
+            }
+            if (c == 'f' && m_end - m_pos >= 5 && std::string_view(m_pos, 5) == "false")
+            {
+                m_pos += 5;
+                return false;
+            }
+            error("expected bool");
+        }
+
+        // 转义和parser支持的一样
+        void BindReader::readString(std::string &out)
+        {
+            expect('\"');
+            while (1)
+            {
+                // 一段没有转义的字符一次拷过去
+                const char *begin = m_pos;
+                while (m_pos != m_end && *m_pos != '\"' && *m_pos != '\\' && static_cast<unsigned char>(*m_pos) >= 0x20)
+                    m_pos++;
+                out.append(begin, m_pos);
+                if (m_pos == m_end)
+                    error("unexpected end");
+                if (static_cast<unsigned char>(*m_pos) < 0x20)
+                    error("unescaped control character");
+                if (*m_pos++ == '\"')
+                    return;
+                if (m_pos == m_end)
+                    error("unexpected end");
+                switch (*m_pos)
+                {
+                case '\"':
+                case '\\':
+                case '/':
+                    out += *m_pos;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    char utf8[4];
+                    size_t pos = 0;
+                    size_t bytes = decodeUnicodeEscape(std::string_view(m_pos, static_cast<size_t>(m_end - m_pos)), pos, utf8);
+                    if (bytes == 0)
+                    {
+                        m_pos--;
+                        error("invalid escape");
+                    }
+                    out.append(utf8, bytes);
+                    m_pos += pos;
+                    break;
+                }
+                default:
+                    m_pos--;
+                    error("invalid escape");
+                }
+                m_pos++;
+            }
+        }
+
+        std::string_view BindReader::readKey(std::string &buffer)
+        {
+            expect('\"');
+            const char *begin = m_pos;
+            while (m_pos != m_end && *m_pos != '\"' && *m_pos != '\\' && static_cast<unsigned char>(*m_pos) >= 0x20)
+                m_pos++;
+            if (m_pos != m_end && *m_pos == '\"')
+                return std::string_view(begin, static_cast<size_t>(m_pos++ - begin));
+            // 有转义, 回到开头走完整的解码
+            m_pos = begin - 1;
+            buffer.clear();
+            readString(buffer);
+            return buffer;
+        }
+
+        std::string_view BindReader::readNumberToken()
+        {
+            skipWhiteSpace();
+            const char *begin = m_pos;
+            // 和parse()一样按RFC 8259的语法认, from_chars会收下的01/1./.5在这里挡掉
+            auto digits = [this]()
+            {
+                const char *start = m_pos;
+                while (m_pos != m_end && *m_pos >= '0' && *m_pos <= '9')
+                    m_pos++;
+                return static_cast<size_t>(m_pos - start);
+            };
+            if (m_pos != m_end && *m_pos == '-')
+                m_pos++;
+            const char *integer = m_pos;
+            size_t count = digits();
+            if (count == 0)
+                error("expected number");
+            if (count > 1 && *integer == '0')
+                error("invalid number");
+            if (m_pos != m_end && *m_pos == '.')
+            {
+                m_pos++;
+                if (digits() == 0)
+                    error("invalid number");
+            }
+            if (m_pos != m_end && (*m_pos == 'e' || *m_pos == 'E'))
+            {
+                m_pos++;
+                if (m_pos != m_end && (*m_pos == '+' || *m_pos == '-'))
+                    m_pos++;
+                if (digits() == 0)
+                    error("invalid number");
+            }
+            return std::string_view(begin, static_cast<size_t>(m_pos - begin));
+        }
+
+        std::string_view BindReader::skipValue()
+        {
+            const char *begin = (skipWhiteSpace(), m_pos);
+            // 只数括号, 字符串里的括号不算
+            size_t depth = 0;
+            do
+            {
+                char c = peek();
+                switch (c)
+                {
+                case '{':
+                case '[':
+                    if (++depth > MAXDEPTH)
+                        error("depth exceeded");
+                    m_pos++;
+                    continue;
+                case '}':
+                case ']':
+                    if (depth == 0)
+                        error("unexpected bracket");
+                    depth--;
+                    m_pos++;
+                    break;
+                case ',':
+                case ':':
+                    if (depth == 0)
+                        error("unexpected separator");
+                    m_pos++;
+                    continue;
+                case '\"':
+                {
+                    std::string ignored;
+                    readKey(ignored);
+                    break;
+                }
+                case 't':
+                case 'f':
+                    readBool();
+                    break;
+                case 'n':
+                    readNull();
+                    break;
+                default:
+                    readNumberToken();
+                    break;
+                }
+            } while (depth > 0);
+            return std::string_view(begin, static_cast<size_t>(m_pos - begin));
+        }
+
+        ///////////////数字//////////////////////
+        void readNumber(BindReader &reader, double &out)
+        {
+            std::string_view token = reader.readNumberToken();
+            auto result = std::from_chars(token.data(), token.data() + token.size(), out);
+            if (result.ec == std::errc::result_out_of_range)
+            {
+                // 下溢成0不算错, 只有溢出算
+                if (decimalMagnitude(token) > 0)
+                    reader.error("number out of range");
+                out = token[0] == '-' ? -0.0 : 0.0;
+                return;
+            }
+            if (result.ec != std::errc() || result.ptr != token.data() + token.size())
+                reader.error("invalid number");
+        }
+
+        void readNumber(BindReader &reader, float &out)
+        {
+            double value;
+            readNumber(reader, value);
+            out = static_cast<float>(value);
+        }
+
+        template <typename T>
+        static void readIntegerToken(BindReader &reader, T &out)
+        {
+            std::string_view token = reader.readNumberToken();
+            auto result = std::from_chars(token.data(), token.data() + token.size(), out);
+            if (result.ec == std::errc::result_out_of_range)
+                reader.error("integer out of range");
+            if (result.ec != std::errc() || result.ptr != token.data() + token.size())
+                reader.error("expected integer");
+        }
+
+        void readInteger(BindReader &reader, int64_t &out)
+        {
+            readIntegerToken(reader, out);
+        }
+
+        void readInteger(BindReader &reader, uint64_t &out)
+        {
+            readIntegerToken(reader, out);
+        }
+
+        // 任意值: 先跳过确定范围, 再交给parser
+        Json readAny(BindReader &reader)
+        {
+            std::string_view raw = reader.skipValue();
+            size_t offset = reader.position() - raw.size();
+            ParseError error;
+            Json value = parse(std::string(raw), error);
+            if (error)
+                throw myJsonException(std::string("[ERROR] bind: ") + error.message() + " at offset " + std::to_string(offset + error.offset), offset + error.offset);
+            return value;
+        }
+
+        ///////////////写//////////////////////
+        void writeString(std::string &out, std::string_view value)
+        {
+            static const char hex[] = "0123456789abcdef";
+            out += '\"';
+            const char *begin = value.data();
+            const char *end = begin + value.size();
+            for (const char *p = begin; p != end; p++)
+            {
+                unsigned char c = static_cast<unsigned char>(*p);
+                if (c >= 0x20 && c != '\"' && c != '\\')
+                    continue;
+                out.append(begin, p);
+                begin = p + 1;
+                switch (c)
+                {
+                case '\"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\b':
+                    out += "\\b";
+                    break;
+                case '\f':
+                    out += "\\f";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xf];
+                    break;
+                }
+            }
+            out.append(begin, end);
+            out += '\"';
+        }
+
+        // json没有NaN/Inf, 写成null
+        void writeNumber(std::string &out, double value)
+        {
+            if (!std::isfinite(value))
+            {
+                out += "null";
+                return;
+            }
+            // -0写成"-0"会被重新parse成整数0, 丢了符号
+            if (value == 0 && std::signbit(value))
+            {
+                out += "-0.0";
+                return;
+            }
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        void writeInteger(std::string &out, int64_t value)
+        {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        void writeInteger(std::string &out, uint64_t value)
+        {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        void writeAny(std::string &out, const Json &value)
+        {
+            switch (value.type())
+            {
+            case JsonValueType::NUL:
+                out += "null";
+                break;
+            case JsonValueType::BOOL:
+                out += value.getBool() ? "true" : "false";
+                break;
+            case JsonValueType::INT64:
+                writeInteger(out, value.getInt64());
+                break;
+            case JsonValueType::UINT64:
+                writeInteger(out, value.getUint64());
+                break;
+            case JsonValueType::NUMBER:
+                writeNumber(out, value.getNumber());
+                break;
+            case JsonValueType::STRING:
+                writeString(out, std::string_view(value.getString().data(), value.getString().size()));
+                break;
+            case JsonValueType::ARRAY:
+            {
+                out += '[';
+                bool first = true;
+                for (const Json &item : value.getArray())
+                {
+                    if (!first)
+                        out += ',';
+                    first = false;
+                    writeAny(out, item);
+                }
+                out += ']';
+                break;
+            }
+            case JsonValueType::OBJECT:
+            {
+                out += '{';
+                bool first = true;
+                for (const auto &member : value.getObject())
+                {
+                    if (!first)
+                        out += ',';
+                    first = false;
+                    writeString(out, std::string_view(member.first.data(), member.first.size()));
+                    out += ':';
+                    writeAny(out, member.second);
+                }
+                out += '}';
+                break;
+            }
+            }
+        }
+    }
+}
@@ -0,0 +1,489 @@
+//
+//  myJsonBind.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  结构体和json文本直接互转, 中间不构造Json树
+//
+//      struct User { int64_t id; std::string name; std::vector<std::string> tags; };
+//      MYJSON_DEFINE(User, id, name, tags) // 写在User所在的namespace里
+//
+//      User user = myJson::readJson<User>(text);
+//      std::string text = myJson::writeJson(user);
+//
+//  - 字段名在编译期生成完美hash表, 解析时每个key一次hash加一次比较就找到字段, 没有map查找和虚函数
+//  - 不认识的key跳过, 缺少的字段保持原来的值
+//  - 支持的字段类型: bool, 整数, 浮点, std::string, std::vector, std::optional,
+//    std::map<std::string, T>, 其他MYJSON_DEFINE过的类型, Json(任意值)
+//
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    namespace bind
+    {
+        ///////////////编译期的完美hash//////////////////////
+        constexpr uint64_t keyHash(std::string_view key, uint64_t seed)
+        {
+            uint64_t h = 0xcbf29ce484222325ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+            for (char c : key)
+            {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ULL;
+            }
+            h ^= h >> 32;
+            return h;
+        }
+
+        // 槽位数取>=2N的2的幂, 空槽多, 找种子很快
+        constexpr size_t tableSize(size_t n)
+        {
+            size_t size = 1;
+            while (size < 2 * n)
+                size <<= 1;
+            return size;
+        }
+
+        // N个key到[0, N)的完美hash, 在编译期试种子, 直到没有冲突
+        template <size_t N>
+        class PerfectHash
+        {
+        public:
+            static constexpr size_t SIZE = tableSize(N);
+
+            constexpr explicit PerfectHash(const std::string_view (&keys)[N])
+            {
+                for (size_t i = 0; i < N; i++)
+                    m_keys[i] = keys[i];
+                for (uint64_t seed = 0; seed < 100000; seed++)
+                {
+                    if (tryBuild(seed))
+                        return;
+                }
+                // 常量求值时走到这里就编译失败, 一般是字段名重复了
+                throw "MYJSON_DEFINE: duplicate field names";
+            }
+
+            // 不是这N个key之一就返回-1
+            constexpr int find(std::string_view key) const
+            {
+                int index = m_slots[keyHash(key, m_seed) & (SIZE - 1)];
+                return index >= 0 && m_keys[index] == key ? index : -1;
+            }
+
+        private:
+            uint64_t m_seed = 0;
+            int m_slots[SIZE] = {};
+            std::string_view m_keys[N] = {};
+
+            constexpr bool tryBuild(uint64_t seed)
+            {
+                for (size_t i = 0; i < SIZE; i++)
+                    m_slots[i] = -1;
+                for (size_t i = 0; i < N; i++)
+                {
+                    size_t slot = keyHash(m_keys[i], seed) & (SIZE - 1);
+                    if (m_slots[slot] >= 0)
+                        return false;
+                    m_slots[slot] = static_cast<int>(i);
+                }
+                m_seed = seed;
+                return true;
+            }
+        };
+
+        ///////////////读//////////////////////
+        // 直接在输入上扫描, 出错抛myJsonException, position是字节偏移
+        class BindReader
+        {
+        public:
+            explicit BindReader(std::string_view in)
+                : m_begin(in.data()), m_pos(in.data()), m_end(in.data() + in.size()) {}
+
+            // 跳过空白后看下一个字符, 到结尾了就报错
+            char peek();
+            void expect(char c);
+            // 跳过空白后是c就吃掉
+            bool consume(char c);
+            // 后面只能有空白
+            void finish();
+
+            bool readNull();
+            bool readBool();
+            void readString(std::string &out);
+            // 没有转义时直接返回输入里的一段, 否则解码到buffer里
+            std::string_view readKey(std::string &buffer);
+            // 数字的原文, 交给from_chars
+            std::string_view readNumberToken();
+            // 跳过一个完整的值, 返回它在输入里的范围
+            std::string_view skipValue();
+
+            size_t position() const { return static_cast<size_t>(m_pos - m_begin); }
+            [[noreturn]] void error(const char *message) const;
+
+        private:
+            const char *m_begin;
+            const char *m_pos;
+            const char *m_end;
+
+            void skipWhiteSpace();
+        };
+
+        void readNumber(BindReader &reader, double &out);
+        void readNumber(BindReader &reader, float &out);
+        void readInteger(BindReader &reader, int64_t &out);
+        void readInteger(BindReader &reader, uint64_t &out);
+        Json readAny(BindReader &reader);
+
+        ///////////////写//////////////////////
+        void writeString(std::string &out, std::string_view value);
+        void writeNumber(std::string &out, double value);
+        void writeInteger(std::string &out, int64_t value);
+        void writeInteger(std::string &out, uint64_t value);
+        void writeAny(std::string &out, const Json &value);
+
+        ///////////////类型判断//////////////////////
+        template <typename T>
+        struct IsVector : std::false_type
+        {
+        };
+        template <typename T, typename A>
+        struct IsVector<std::vector<T, A>> : std::true_type
+        {
+        };
+
+        template <typename T>
+        struct IsOptional : std::false_type
+        {
+        };
+        template <typename T>
+        struct IsOptional<std::optional<T>> : std::true_type
+        {
+        };
+
+        template <typename T>
+        struct IsStringMap : std::false_type
+        {
+        };
+        template <typename T, typename C, typename A>
+        struct IsStringMap<std::map<std::string, T, C, A>> : std::true_type
+        {
+        };
+
+        // MYJSON_DEFINE生成的myJsonFields能通过ADL找到
+        template <typename T, typename = void>
+        struct IsBound : std::false_type
+        {
+        };
+        template <typename T>
+        struct IsBound<T, std::void_t<decltype(myJsonFields(static_cast<const T *>(nullptr)))>> : std::true_type
+        {
+        };
+
+        template <typename T>
+        using FieldsOf = decltype(myJsonFields(static_cast<const T *>(nullptr)));
+
+        template <typename T>
+        struct DependentFalse : std::false_type
+        {
+        };
+
+        template <typename T>
+        void readValue(BindReader &reader, T &out);
+        template <typename T>
+        void writeValue(std::string &out, const T &value);
+
+        // 运行时的字段下标分派到对应的成员指针
+        template <typename T, typename Members, size_t... I>
+        void readField(BindReader &reader, T &out, const Members &members, int index, std::index_sequence<I...>)
+        {
+            ((static_cast<int>(I) == index ? (readValue(reader, out.*std::get<I>(members)), true) : false) || ...);
+        }
+
+        template <typename T>
+        void readObject(BindReader &reader, T &out)
+        {
+            using Fields = FieldsOf<T>;
+            constexpr size_t count = std::tuple_size<decltype(Fields::members)>::value;
+            reader.expect('{');
+            if (reader.consume('}'))
+                return;
+            std::string buffer;
+            do
+            {
+                std::string_view key = reader.readKey(buffer);
+                reader.expect(':');
+                int index = Fields::table.find(key);
+                if (index < 0)
+                    reader.skipValue();
+                else
+                    readField(reader, out, Fields::members, index, std::make_index_sequence<count>());
+            } while (reader.consume(','));
+            reader.expect('}');
+        }
+
+        template <typename T>
+        void readValue(BindReader &reader, T &out)
+        {
+            if constexpr (std::is_same<T, bool>::value)
+            {
+                out = reader.readBool();
+            }
+            else if constexpr (std::is_integral<T>::value)
+            {
+                // 先按64位读, 再检查目标类型的范围
+                using Wide = typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type;
+                Wide value;
+                readInteger(reader, value);
+                if (value < static_cast<Wide>(std::numeric_limits<T>::min()) || value > static_cast<Wide>(std::numeric_limits<T>::max()))
+                    reader.error("integer out of range");
+                out = static_cast<T>(value);
+            }
+            else if constexpr (std::is_floating_point<T>::value)
+            {
+                double value;
+                readNumber(reader, value);
+                out = static_cast<T>(value);
+            }
+            else if constexpr (std::is_same<T, std::string>::value)
+            {
+                out.clear();
+                reader.readString(out);
+            }
+            else if constexpr (std::is_same<T, Json>::value)
+            {
+                out = readAny(reader);
+            }
+            else if constexpr (IsOptional<T>::value)
+            {
+                if (reader.readNull())
+                {
+                    out.reset();
+                    return;
+                }
+                readValue(reader, out.emplace());
+            }
+            else if constexpr (IsVector<T>::value)
+            {
+                out.clear();
+                reader.expect('[');
+                if (reader.consume(']'))
+                    return;
+                do
+                {
+                    readValue(reader, out.emplace_back());
+                } while (reader.consume(','));
+                reader.expect(']');
+            }
+            else if constexpr (IsStringMap<T>::value)
+            {
+                out.clear();
+                reader.expect('{');
+                if (reader.consume('}'))
+                    return;
+                std::string key;
+                do
+                {
+                    key.clear();
+                    reader.readString(key);
+                    reader.expect(':');
+                    readValue(reader, out[key]);
+                } while (reader.consume(','));
+                reader.expect('}');
+            }
+            else if constexpr (IsBound<T>::value)
+            {
+                readObject(reader, out);
+            }
+            else
+            {
+                static_assert(DependentFalse<T>::value, "type is not bindable, declare it with MYJSON_DEFINE");
+            }
+        }
+
+        template <typename T, typename Members, size_t... I>
+        void writeFields(std::string &out, const T &value, const Members &members, const std::string_view *names, std::index_sequence<I...>)
+        {
+            ((out += (I ? "," : ""), writeString(out, names[I]), out += ':', writeValue(out, value.*std::get<I>(members))), ...);
+        }
+
+        template <typename T>
+        void writeValue(std::string &out, const T &value)
+        {
+            if constexpr (std::is_same<T, bool>::value)
+            {
+                out += value ? "true" : "false";
+            }
+            else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value)
+            {
+                writeInteger(out, static_cast<int64_t>(value));
+            }
+            else if constexpr (std::is_integral<T>::value)
+            {
+                writeInteger(out, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_floating_point<T>::value)
+            {
+                writeNumber(out, static_cast<double>(value));
+            }
+            else if constexpr (std::is_same<T, std::string>::value)
+            {
+                writeString(out, value);
+            }
+            else if constexpr (std::is_same<T, Json>::value)
+            {
+                writeAny(out, value);
+            }
+            else if constexpr (IsOptional<T>::value)
+            {
+                if (value)
+                    writeValue(out, *value);
+                else
+                    out += "null";
+            }
+            else if constexpr (IsVector<T>::value)
+            {
+                out += '[';
+                bool first = true;
+                for (const auto &item : value)
+                {
+                    if (!first)
+                        out += ',';
+                    first = false;
+                    writeValue(out, item);
+                }
+                out += ']';
+            }
+            else if constexpr (IsStringMap<T>::value)
+            {
+                out += '{';
+                bool first = true;
+                for (const auto &item : value)
+                {
+                    if (!first)
+                        out += ',';
+                    first = false;
+                    writeString(out, item.first);
+                    out += ':';
+                    writeValue(out, item.second);
+                }
+                out += '}';
+            }
+            else if constexpr (IsBound<T>::value)
+            {
+                using Fields = FieldsOf<T>;
+                constexpr size_t count = std::tuple_size<decltype(Fields::members)>::value;
+                out += '{';
+                writeFields(out, value, Fields::members, Fields::names, std::make_index_sequence<count>());
+                out += '}';
+            }
+            else
+            {
+                static_assert(DependentFalse<T>::value, "type is not bindable, declare it with MYJSON_DEFINE");
+            }
+        }
+    }
+
+    // 解析到已有的对象上, 没出现的字段保持原值
+    template <typename T>
+    void readJson(std::string_view in, T &out)
+    {
+        bind::BindReader reader(in);
+        bind::readValue(reader, out);
+        reader.finish();
+    }
+
+    template <typename T>
+    T readJson(std::string_view in)
+    {
+        T out{};
+        readJson(in, out);
+        return out;
+    }
+
+    // 紧凑格式, 字符串按json转义
+    template <typename T>
+    void writeJson(const T &value, std::string &out)
+    {
+        bind::writeValue(out, value);
+    }
+
+    template <typename T>
+    std::string writeJson(const T &value)
+    {
+        std::string out;
+        writeJson(value, out);
+        return out;
+    }
+}
+
+// 对每个参数展开一次, 最多32个字段
+#define MYJSON_EXPAND(x) x
+#define MYJSON_FE_1(m, x) m(x)
+#define MYJSON_FE_2(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_1(m, __VA_ARGS__))
+#define MYJSON_FE_3(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_2(m, __VA_ARGS__))
+#define MYJSON_FE_4(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_3(m, __VA_ARGS__))
+#define MYJSON_FE_5(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_4(m, __VA_ARGS__))
+#define MYJSON_FE_6(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_5(m, __VA_ARGS__))
+#define MYJSON_FE_7(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_6(m, __VA_ARGS__))
+#define MYJSON_FE_8(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_7(m, __VA_ARGS__))
+#define MYJSON_FE_9(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_8(m, __VA_ARGS__))
+#define MYJSON_FE_10(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_9(m, __VA_ARGS__))
+#define MYJSON_FE_11(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_10(m, __VA_ARGS__))
+#define MYJSON_FE_12(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_11(m, __VA_ARGS__))
+#define MYJSON_FE_13(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_12(m, __VA_ARGS__))
+#define MYJSON_FE_14(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_13(m, __VA_ARGS__))
+#define MYJSON_FE_15(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_14(m, __VA_ARGS__))
+#define MYJSON_FE_16(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_15(m, __VA_ARGS__))
+#define MYJSON_FE_17(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_16(m, __VA_ARGS__))
+#define MYJSON_FE_18(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_17(m, __VA_ARGS__))
+#define MYJSON_FE_19(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_18(m, __VA_ARGS__))
+#define MYJSON_FE_20(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_19(m, __VA_ARGS__))
+#define MYJSON_FE_21(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_20(m, __VA_ARGS__))
+#define MYJSON_FE_22(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_21(m, __VA_ARGS__))
+#define MYJSON_FE_23(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_22(m, __VA_ARGS__))
+#define MYJSON_FE_24(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_23(m, __VA_ARGS__))
+#define MYJSON_FE_25(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_24(m, __VA_ARGS__))
+#define MYJSON_FE_26(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_25(m, __VA_ARGS__))
+#define MYJSON_FE_27(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_26(m, __VA_ARGS__))
+#define MYJSON_FE_28(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_27(m, __VA_ARGS__))
+#define MYJSON_FE_29(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_28(m, __VA_ARGS__))
+#define MYJSON_FE_30(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_29(m, __VA_ARGS__))
+#define MYJSON_FE_31(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_30(m, __VA_ARGS__))
+#define MYJSON_FE_32(m, x, ...) m(x), MYJSON_EXPAND(MYJSON_FE_31(m, __VA_ARGS__))
+#define MYJSON_FE_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, \
+                       _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, name, ...) name
+#define MYJSON_FOR_EACH(m, ...)                                                                                \
+    MYJSON_EXPAND(MYJSON_FE_PICK(__VA_ARGS__, MYJSON_FE_32, MYJSON_FE_31, MYJSON_FE_30, MYJSON_FE_29, MYJSON_FE_28, \
+                                 MYJSON_FE_27, MYJSON_FE_26, MYJSON_FE_25, MYJSON_FE_24, MYJSON_FE_23, MYJSON_FE_22, \
+                                 MYJSON_FE_21, MYJSON_FE_20, MYJSON_FE_19, MYJSON_FE_18, MYJSON_FE_17, MYJSON_FE_16, \
+                                 MYJSON_FE_15, MYJSON_FE_14, MYJSON_FE_13, MYJSON_FE_12, MYJSON_FE_11, MYJSON_FE_10, \
+                                 MYJSON_FE_9, MYJSON_FE_8, MYJSON_FE_7, MYJSON_FE_6, MYJSON_FE_5, MYJSON_FE_4,       \
+                                 MYJSON_FE_3, MYJSON_FE_2, MYJSON_FE_1)(m, __VA_ARGS__))
+
+#define MYJSON_FIELD_NAME(field) #field
+#define MYJSON_FIELD_MEMBER(field) &type::field
+
+// 给Type生成字段表, 要写在Type所在的namespace里(靠ADL找到)
+// 字段名就是json里的key, 重复的字段名会编译失败
+#define MYJSON_DEFINE(Type, ...)                                                                               \
+    struct Type##_myJsonFields                                                                                 \
+    {                                                                                                          \
+        using type = Type;                                                                                     \
+        static constexpr std::string_view names[] = {MYJSON_FOR_EACH(MYJSON_FIELD_NAME, __VA_ARGS__)};         \
+        static constexpr auto members = std::make_tuple(MYJSON_FOR_EACH(MYJSON_FIELD_MEMBER, __VA_ARGS__));    \
+        static constexpr myJson::bind::PerfectHash<sizeof(names) / sizeof(names[0])> table{names};             \
+    };                                                                                                         \
+    inline Type##_myJsonFields myJsonFields(const Type *) { return {}; }
@@ -0,0 +1,515 @@
+//
+//  myJsonCanonical.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonCanonical.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "myJsonBind.hpp"
+
+namespace myJson
+{
+    namespace
+    {
+        ///////////////SHA-256//////////////////////
+        const uint32_t SHA_K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        inline uint32_t rotr32(uint32_t x, int r)
+        {
+            return (x >> r) | (x << (32 - r));
+        }
+
+        void sha256Block(uint32_t (&state)[8], const unsigned char *block)
+        {
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++)
+                w[i] = uint32_t(block[i * 4]) << 24 | uint32_t(block[i * 4 + 1]) << 16 | uint32_t(block[i * 4 + 2]) << 8 | uint32_t(block[i * 4 + 3]);
+            for (int i = 16; i < 64; i++)
+            {
+                uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; i++)
+            {
+                uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + SHA_K[i] + w[i];
+                uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+
+        ///////////////XXH64//////////////////////
+        // 和myJson.cpp里一次性算的xxh64是同一个算法, 这里按32字节一块流式地喂
+        const uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ULL;
+        const uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+        const uint64_t XXH_PRIME3 = 0x165667B19E3779F9ULL;
+        const uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+        const uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+        inline uint64_t rotl64(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline uint64_t readLE64(const unsigned char *p)
+        {
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        inline uint32_t readLE32(const unsigned char *p)
+        {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        }
+
+        inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+        {
+            acc += input * XXH_PRIME2;
+            acc = rotl64(acc, 31);
+            return acc * XXH_PRIME1;
+        }
+
+        inline uint64_t xxhMerge(uint64_t acc, uint64_t val)
+        {
+            acc ^= xxhRound(0, val);
+            return acc * XXH_PRIME1 + XXH_PRIME4;
+        }
+
+        inline void xxhStripe(uint64_t (&acc)[4], const unsigned char *p)
+        {
+            acc[0] = xxhRound(acc[0], readLE64(p));
+            acc[1] = xxhRound(acc[1], readLE64(p + 8));
+            acc[2] = xxhRound(acc[2], readLE64(p + 16));
+            acc[3] = xxhRound(acc[3], readLE64(p + 24));
+        }
+
+        ///////////////数字//////////////////////
+        // ECMAScript Number::toString(x): x = 0.d1d2...dk × 10^n, 按n决定要不要用指数
+        void writeCanonicalNumber(std::string &out, double value)
+        {
+            if (!std::isfinite(value))
+                throw myJsonException("[ERROR] canonical: NaN and Infinity have no canonical form", 0);
+            if (value == 0) // 包括-0
+            {
+                out += '0';
+                return;
+            }
+            if (value < 0)
+            {
+                out += '-';
+                value = -value;
+            }
+            // 最短能还原的科学计数法: d.ddde±xx
+            char buffer[32];
+            char *end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+            char *e = std::find(buffer, end, 'e');
+            char digits[20];
+            int k = 0;
+            for (char *p = buffer; p != e; p++)
+            {
+                if (*p != '.')
+                    digits[k++] = *p;
+            }
+            int exponent = 0;
+            std::from_chars(e + 1 + (e[1] == '+'), end, exponent);
+            int n = exponent + 1;
+
+            if (k <= n && n <= 21) // 整数: 数字后面补0
+            {
+                out.append(digits, k);
+                out.append(n - k, '0');
+            }
+            else if (0 < n && n <= 21) // 小数点在数字中间
+            {
+                out.append(digits, n);
+                out += '.';
+                out.append(digits + n, k - n);
+            }
+            else if (-6 < n && n <= 0) // 0.000ddd
+            {
+                out += "0.";
+                out.append(-n, '0');
+                out.append(digits, k);
+            }
+            else
+            {
+                out += digits[0];
+                if (k > 1)
+                {
+                    out += '.';
+                    out.append(digits + 1, k - 1);
+                }
+                out += 'e';
+                out += n - 1 < 0 ? '-' : '+';
+                char exp[8];
+                out.append(exp, std::to_chars(exp, exp + sizeof(exp), std::abs(n - 1)).ptr);
+            }
+        }
+
+        ///////////////key的顺序//////////////////////
+        // 从UTF-8里按UTF-16码元一个个取, 辅助平面的字符拆成两个代理
+        // 不是合法UTF-8的字节按字节值当一个码元
+        class Utf16Units
+        {
+        public:
+            explicit Utf16Units(std::string_view text) : m_text(text) {}
+
+            // 没有了返回-1
+            int32_t next()
+            {
+                if (m_low)
+                {
+                    int32_t low = m_low;
+                    m_low = 0;
+                    return low;
+                }
+                if (m_pos == m_text.size())
+                    return -1;
+                unsigned char c = static_cast<unsigned char>(m_text[m_pos]);
+                size_t length = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+                if (length <= 1 || m_pos + length > m_text.size())
+                {
+                    m_pos++;
+                    return c;
+                }
+                uint32_t cp = c & (0xFF >> (length + 1));
+                for (size_t i = 1; i < length; i++)
+                    cp = (cp << 6) | (static_cast<unsigned char>(m_text[m_pos + i]) & 0x3F);
+                m_pos += length;
+                if (cp < 0x10000)
+                    return static_cast<int32_t>(cp);
+                cp -= 0x10000;
+                m_low = static_cast<int32_t>(0xDC00 + (cp & 0x3FF));
+                return static_cast<int32_t>(0xD800 + (cp >> 10));
+            }
+
+        private:
+            std::string_view m_text;
+            size_t m_pos = 0;
+            int32_t m_low = 0; // 还没取的低位代理
+        };
+
+        bool utf16Less(const jsonstring &lhs, const jsonstring &rhs)
+        {
+            Utf16Units a(std::string_view(lhs.data(), lhs.size())), b(std::string_view(rhs.data(), rhs.size()));
+            while (1)
+            {
+                int32_t x = a.next(), y = b.next();
+                if (x != y || x < 0)
+                    return x < y;
+            }
+        }
+
+        // 对象本来就按UTF-8字节序排好了, 只有出现U+E000以上的字符(首字节0xEE起)时才可能和UTF-16的顺序不同
+        bool needsResort(const object &members)
+        {
+            for (const auto &member : members)
+            {
+                for (char c : member.first)
+                {
+                    if (static_cast<unsigned char>(c) >= 0xEE)
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        ///////////////输出//////////////////////
+        class CanonicalWriter
+        {
+        public:
+            // sink为空时只往out里写
+            CanonicalWriter(std::string &out, ByteSink *sink) : m_out(out), m_sink(sink) {}
+
+            void write(const Json &json)
+            {
+                JsonView view = json.view();
+                switch (view.type)
+                {
+                case JsonValueType::NUL:
+                    m_out += "null";
+                    break;
+                case JsonValueType::BOOL:
+                    m_out += view.boolean ? "true" : "false";
+                    break;
+                case JsonValueType::INT64:
+                    writeCanonicalNumber(m_out, static_cast<double>(view.int64));
+                    break;
+                case JsonValueType::UINT64:
+                    writeCanonicalNumber(m_out, static_cast<double>(view.uint64));
+                    break;
+                case JsonValueType::NUMBER:
+                    writeCanonicalNumber(m_out, view.number);
+                    break;
+                case JsonValueType::STRING:
+                    bind::writeString(m_out, std::string_view(view.string->data(), view.string->size()));
+                    break;
+                case JsonValueType::ARRAY:
+                {
+                    m_out += '[';
+                    bool first = true;
+                    for (const Json &item : *view.items)
+                    {
+                        if (!first)
+                            m_out += ',';
+                        first = false;
+                        write(item);
+                    }
+                    m_out += ']';
+                    break;
+                }
+                case JsonValueType::OBJECT:
+                {
+                    m_out += '{';
+                    const object &members = *view.members;
+                    if (!needsResort(members))
+                    {
+                        bool first = true;
+                        for (const auto &member : members)
+                        {
+                            writeMember(member, first);
+                            first = false;
+                        }
+                    }
+                    else
+                    {
+                        std::vector<const object::value_type *> sorted;
+                        sorted.reserve(members.size());
+                        for (const auto &member : members)
+                            sorted.push_back(&member);
+                        std::sort(sorted.begin(), sorted.end(), [](const object::value_type *lhs, const object::value_type *rhs)
+                                  { return utf16Less(lhs->first, rhs->first); });
+                        for (size_t i = 0; i < sorted.size(); i++)
+                            writeMember(*sorted[i], i == 0);
+                    }
+                    m_out += '}';
+                    break;
+                }
+                }
+                flush(false);
+            }
+
+            // 剩下的都交给sink
+            void flush(bool all)
+            {
+                if (m_sink && (all || m_out.size() >= FLUSH_BYTES))
+                {
+                    m_sink->write(m_out.data(), m_out.size());
+                    m_out.clear();
+                }
+            }
+
+        private:
+            static const size_t FLUSH_BYTES = 4096;
+
+            std::string &m_out;
+            ByteSink *m_sink;
+
+            void writeMember(const object::value_type &member, bool first)
+            {
+                if (!first)
+                    m_out += ',';
+                bind::writeString(m_out, std::string_view(member.first.data(), member.first.size()));
+                m_out += ':';
+                write(member.second);
+            }
+        };
+    }
+
+    Sha256::Sha256()
+        : m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+    void Sha256::write(const char *data, size_t size)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+        m_length += size;
+        if (m_used > 0)
+        {
+            size_t take = std::min(size, sizeof(m_block) - m_used);
+            std::memcpy(m_block + m_used, p, take);
+            m_used += take;
+            p += take;
+            size -= take;
+            if (m_used < sizeof(m_block))
+                return;
+            sha256Block(m_state, m_block);
+            m_used = 0;
+        }
+        for (; size >= sizeof(m_block); p += sizeof(m_block), size -= sizeof(m_block))
+            sha256Block(m_state, p);
+        std::memcpy(m_block, p, size);
+        m_used = size;
+    }
+
+    std::array<uint8_t, 32> Sha256::digest() const
+    {
+        // 在副本上补位: 0x80, 补0到56字节, 最后8字节是大端的比特数
+        uint32_t state[8];
+        std::memcpy(state, m_state, sizeof(state));
+        unsigned char block[128] = {};
+        std::memcpy(block, m_block, m_used);
+        block[m_used] = 0x80;
+        size_t blocks = m_used < 56 ? 1 : 2;
+        uint64_t bits = m_length * 8;
+        for (int i = 0; i < 8; i++)
+            block[blocks * 64 - 1 - i] = static_cast<unsigned char>(bits >> (i * 8));
+        for (size_t i = 0; i < blocks; i++)
+            sha256Block(state, block + i * 64);
+        std::array<uint8_t, 32> out;
+        for (int i = 0; i < 8; i++)
+        {
+            out[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+            out[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+            out[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+            out[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+        }
+        return out;
+    }
+
+    std::string Sha256::hexDigest() const
+    {
+        static const char hex[] = "0123456789abcdef";
+        std::string out;
+        for (uint8_t byte : digest())
+        {
+            out += hex[byte >> 4];
+            out += hex[byte & 0xf];
+        }
+        return out;
+    }
+
+    Xxh64::Xxh64(uint64_t seed)
+        : m_seed(seed), m_acc{seed + XXH_PRIME1 + XXH_PRIME2, seed + XXH_PRIME2, seed, seed - XXH_PRIME1} {}
+
+    void Xxh64::write(const char *data, size_t size)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+        m_length += size;
+        if (m_used > 0)
+        {
+            size_t take = std::min(size, sizeof(m_block) - m_used);
+            std::memcpy(m_block + m_used, p, take);
+            m_used += take;
+            p += take;
+            size -= take;
+            if (m_used < sizeof(m_block))
+                return;
+            xxhStripe(m_acc, m_block);
+            m_used = 0;
+        }
+        for (; size >= sizeof(m_block); p += sizeof(m_block), size -= sizeof(m_block))
+            xxhStripe(m_acc, p);
+        std::memcpy(m_block, p, size);
+        m_used = size;
+    }
+
+    uint64_t Xxh64::digest() const
+    {
+        uint64_t h;
+        if (m_length >= 32)
+        {
+            h = rotl64(m_acc[0], 1) + rotl64(m_acc[1], 7) + rotl64(m_acc[2], 12) + rotl64(m_acc[3], 18);
+            for (uint64_t acc : m_acc)
+                h = xxhMerge(h, acc);
+        }
+        else
+        {
+            h = m_seed + XXH_PRIME5;
+        }
+        h += m_length;
+        const unsigned char *p = m_block;
+        const unsigned char *end = m_block + m_used;
+        while (end - p >= 8)
+        {
+            h ^= xxhRound(0, readLE64(p));
+            h = rotl64(h, 27) * XXH_PRIME1 + XXH_PRIME4;
+            p += 8;
+        }
+        if (end - p >= 4)
+        {
+            h ^= static_cast<uint64_t>(readLE32(p)) * XXH_PRIME1;
+            h = rotl64(h, 23) * XXH_PRIME2 + XXH_PRIME3;
+            p += 4;
+        }
+        while (p < end)
+        {
+            h ^= (*p) * XXH_PRIME5;
+            h = rotl64(h, 11) * XXH_PRIME1;
+            p++;
+        }
+        h ^= h >> 33;
+        h *= XXH_PRIME2;
+        h ^= h >> 29;
+        h *= XXH_PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    std::string writeCanonical(const Json &json)
+    {
+        std::string out;
+        writeCanonical(out, json);
+        return out;
+    }
+
+    void writeCanonical(std::string &out, const Json &json)
+    {
+        CanonicalWriter(out, nullptr).write(json);
+    }
+
+    void writeCanonical(ByteSink &sink, const Json &json)
+    {
+        std::string buffer;
+        buffer.reserve(8192);
+        CanonicalWriter writer(buffer, &sink);
+        writer.write(json);
+        writer.flush(true);
+    }
+
+    std::array<uint8_t, 32> canonicalSha256(const Json &json)
+    {
+        Sha256 sha;
+        writeCanonical(sha, json);
+        return sha.digest();
+    }
+
+    uint64_t canonicalXxh64(const Json &json, uint64_t seed)
+    {
+        Xxh64 xxh(seed);
+        writeCanonical(xxh, json);
+        return xxh.digest();
+    }
+}
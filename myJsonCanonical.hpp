@@ -0,0 +1,77 @@
+//
+//  myJsonCanonical.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  RFC 8785 (JCS) 规范化输出, 签名和缓存key用
+//
+//      std::string text = writeCanonical(json);
+//      std::array<uint8_t, 32> digest = canonicalSha256(json);   // 不生成完整的输出
+//
+//      Sha256 sha;
+//      writeCanonical(sha, json); // 或者自己实现ByteSink
+//
+//  - 没有空白; 对象成员按key的UTF-16码元排序(和按UTF-8字节排只在U+E000以上和辅助平面的字符混在一起时不同)
+//  - 字符串只转义 " \ 和控制字符, 控制字符有短写法的用 \b \t \n \f \r, 其余的用小写的\u00xx, 其他字符原样输出UTF-8
+//  - 数字都当成IEEE 754 double, 按ECMAScript的Number.prototype.toString写: 最短能还原的位数,
+//    1e21以下不用指数, -0写成0; 所以超过2^53的整数会按double舍入
+//  - NaN和Infinity没有规范的写法, 抛myJsonException
+//  - 写到ByteSink时输出先攒在几KB的缓冲区里, 满了才交给sink, 内存不随文档大小增长
+//
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    // 规范化输出按顺序分段交过来, 拼起来就是完整的输出
+    class ByteSink
+    {
+    public:
+        virtual ~ByteSink() = default;
+        virtual void write(const char *data, size_t size) = 0;
+    };
+
+    // 流式的SHA-256, digest()不影响状态, 之后还可以接着写
+    class Sha256 : public ByteSink
+    {
+    public:
+        Sha256();
+        void write(const char *data, size_t size) override;
+        std::array<uint8_t, 32> digest() const;
+        std::string hexDigest() const; // 小写十六进制
+
+    private:
+        uint32_t m_state[8];
+        uint64_t m_length = 0; // 已经写了多少字节
+        unsigned char m_block[64];
+        size_t m_used = 0; // m_block里攒了多少字节
+    };
+
+    // 流式的XXH64, 结果和一次性算的XXH64一样
+    class Xxh64 : public ByteSink
+    {
+    public:
+        explicit Xxh64(uint64_t seed = 0);
+        void write(const char *data, size_t size) override;
+        uint64_t digest() const;
+
+    private:
+        uint64_t m_seed;
+        uint64_t m_acc[4];
+        uint64_t m_length = 0;
+        unsigned char m_block[32];
+        size_t m_used = 0;
+    };
+
+    std::string writeCanonical(const Json &json);
+    void writeCanonical(std::string &out, const Json &json); // 追加到out后面
+    void writeCanonical(ByteSink &sink, const Json &json);
+
+    std::array<uint8_t, 32> canonicalSha256(const Json &json);
+    uint64_t canonicalXxh64(const Json &json, uint64_t seed = 0);
+}
@@ -0,0 +1,330 @@
+//
+//  myJsonColumns.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonColumns.hpp"
+#include <limits>
+
+namespace myJson
+{
+    namespace
+    {
+        // 按行追加, 每行每列都会落一个值(缺失的补0/空串), 所以列的长度始终等于行数
+        class ColumnBuilder
+        {
+        public:
+            explicit ColumnBuilder(const std::vector<ColumnSpec> &fields) : m_seen(fields.size(), false)
+            {
+                m_table.columns.resize(fields.size());
+                for (size_t i = 0; i < fields.size(); i++)
+                {
+                    Column &column = m_table.columns[i];
+                    column.name = fields[i].name;
+                    column.type = fields[i].type;
+                    if (column.type == ColumnType::STRING)
+                        column.offsets.push_back(0);
+                }
+            }
+
+            // 没有这个字段返回SIZE_MAX
+            size_t find(std::string_view name) const
+            {
+                for (size_t i = 0; i < m_table.columns.size(); i++)
+                {
+                    if (m_table.columns[i].name == name)
+                        return i;
+                }
+                return std::numeric_limits<size_t>::max();
+            }
+
+            void beginRow()
+            {
+                m_seen.assign(m_seen.size(), false);
+                if (m_table.rows % 64 == 0)
+                {
+                    for (Column &column : m_table.columns)
+                        column.valid.push_back(0);
+                }
+            }
+
+            bool seen(size_t field) const { return m_seen[field]; }
+
+            // 重复的key以最后一个为准: 撤掉这一行里前一个写进去的值
+            void unput(size_t field)
+            {
+                Column &column = m_table.columns[field];
+                if (column.type == ColumnType::NUMBER)
+                {
+                    column.numbers.pop_back();
+                }
+                else
+                {
+                    column.offsets.pop_back();
+                    column.blob.resize(column.offsets.back());
+                }
+                column.valid.back() &= ~(uint64_t(1) << (m_table.rows % 64));
+                m_seen[field] = false;
+            }
+
+            void putNumber(size_t field, double value)
+            {
+                Column &column = m_table.columns[field];
+                if (column.type != ColumnType::NUMBER)
+                    mismatch(field, "is not a string");
+                m_seen[field] = true;
+                column.numbers.push_back(value);
+                setValid(column);
+            }
+
+            void putString(size_t field, std::string_view value)
+            {
+                Column &column = m_table.columns[field];
+                if (column.type != ColumnType::STRING)
+                    mismatch(field, "is not a number");
+                if (column.blob.size() + value.size() > std::numeric_limits<uint32_t>::max())
+                    throw myJsonException("[ERROR] columns: string column \"" + column.name + "\" exceeds 4GB", 0);
+                m_seen[field] = true;
+                column.blob.append(value.data(), value.size());
+                column.offsets.push_back(static_cast<uint32_t>(column.blob.size()));
+                setValid(column);
+            }
+
+            // null和其他类型的值: null算缺失, 其他的报错
+            void putNull(size_t field)
+            {
+                m_seen[field] = true;
+                fill(m_table.columns[field]);
+            }
+
+            void putOther(size_t field)
+            {
+                mismatch(field, m_table.columns[field].type == ColumnType::NUMBER ? "is not a number" : "is not a string");
+            }
+
+            void endRow()
+            {
+                for (size_t i = 0; i < m_seen.size(); i++)
+                {
+                    if (!m_seen[i])
+                        fill(m_table.columns[i]);
+                }
+                m_table.rows++;
+            }
+
+            [[noreturn]] void notObject() const
+            {
+                throw myJsonException("[ERROR] columns: row " + std::to_string(m_table.rows) + " is not an object", 0);
+            }
+
+            ColumnTable release() { return std::move(m_table); }
+
+        private:
+            ColumnTable m_table;
+            std::vector<bool> m_seen;
+
+            void setValid(Column &column)
+            {
+                column.valid.back() |= uint64_t(1) << (m_table.rows % 64);
+            }
+
+            static void fill(Column &column)
+            {
+                if (column.type == ColumnType::NUMBER)
+                    column.numbers.push_back(0);
+                else
+                    column.offsets.push_back(static_cast<uint32_t>(column.blob.size()));
+            }
+
+            [[noreturn]] void mismatch(size_t field, const char *what) const
+            {
+                throw myJsonException("[ERROR] columns: field \"" + m_table.columns[field].name + "\" " + what + " at row " + std::to_string(m_table.rows), 0);
+            }
+        };
+
+        // 只关心 根数组 -> 行对象 -> 成员 这三层, 更深的值整个跳过
+        class ColumnHandler : public JsonHandler
+        {
+        public:
+            explicit ColumnHandler(ColumnBuilder &builder) : m_builder(builder) {}
+
+            bool null() override
+            {
+                if (accept())
+                    m_builder.putNull(m_field);
+                return true;
+            }
+
+            bool boolean(bool) override
+            {
+                if (accept())
+                    m_builder.putOther(m_field);
+                return true;
+            }
+
+            bool integer(int64_t value) override
+            {
+                if (accept())
+                    m_builder.putNumber(m_field, static_cast<double>(value));
+                return true;
+            }
+
+            bool unsignedInteger(uint64_t value) override
+            {
+                if (accept())
+                    m_builder.putNumber(m_field, static_cast<double>(value));
+                return true;
+            }
+
+            bool number(double value) override
+            {
+                if (accept())
+                    m_builder.putNumber(m_field, value);
+                return true;
+            }
+
+            bool string(std::string_view value) override
+            {
+                if (accept())
+                    m_builder.putString(m_field, value);
+                return true;
+            }
+
+            bool startObject() override
+            {
+                if (m_depth == 1)
+                    m_builder.beginRow();
+                else
+                    container();
+                m_depth++;
+                return true;
+            }
+
+            bool key(std::string_view key) override
+            {
+                if (m_depth == 2)
+                {
+                    m_field = m_builder.find(key);
+                    if (m_field != NONE && m_builder.seen(m_field))
+                        m_builder.unput(m_field);
+                }
+                return true;
+            }
+
+            bool endObject() override
+            {
+                if (--m_depth == 1)
+                    m_builder.endRow();
+                return true;
+            }
+
+            bool startArray() override
+            {
+                if (m_depth != 0)
+                    container();
+                m_depth++;
+                return true;
+            }
+
+            bool endArray() override
+            {
+                m_depth--;
+                return true;
+            }
+
+        private:
+            static const size_t NONE = std::numeric_limits<size_t>::max();
+
+            ColumnBuilder &m_builder;
+            size_t m_depth = 0;
+            size_t m_field = NONE;
+
+            // 标量: 是不是要写进列的成员
+            bool accept() const
+            {
+                if (m_depth == 0)
+                    throw myJsonException("[ERROR] columns: root is not an array", 0);
+                if (m_depth == 1)
+                    m_builder.notObject();
+                return m_depth == 2 && m_field != NONE;
+            }
+
+            // 行本身是数组, 或者字段的值是数组/对象
+            void container()
+            {
+                if (m_depth == 0)
+                    throw myJsonException("[ERROR] columns: root is not an array", 0);
+                if (m_depth == 1)
+                    m_builder.notObject();
+                if (m_depth == 2 && m_field != NONE)
+                    m_builder.putOther(m_field);
+            }
+        };
+    }
+
+    const Column &ColumnTable::operator[](std::string_view name) const
+    {
+        for (const Column &column : columns)
+        {
+            if (column.name == name)
+                return column;
+        }
+        throw myJsonException("[ERROR] columns: no column " + std::string(name), 0);
+    }
+
+    ColumnTable toColumns(const Json &json, const std::vector<ColumnSpec> &fields)
+    {
+        if (!json.is_array())
+            throw myJsonException("[ERROR] columns: root is not an array", 0);
+        ColumnBuilder builder(fields);
+        for (const Json &row : json.getArray())
+        {
+            if (!row.is_object())
+                builder.notObject();
+            builder.beginRow();
+            const object &members = row.getObject();
+            for (size_t i = 0; i < fields.size(); i++)
+            {
+                auto iter = members.find(std::string_view(fields[i].name));
+                if (iter == members.end())
+                    continue;
+                const Json &value = iter->second;
+                switch (value.type())
+                {
+                case JsonValueType::NUL:
+                    builder.putNull(i);
+                    break;
+                case JsonValueType::NUMBER:
+                case JsonValueType::INT64:
+                case JsonValueType::UINT64:
+                    builder.putNumber(i, value.getNumber());
+                    break;
+                case JsonValueType::STRING:
+                    builder.putString(i, std::string_view(value.getString().data(), value.getString().size()));
+                    break;
+                default:
+                    builder.putOther(i);
+                    break;
+                }
+            }
+            builder.endRow();
+        }
+        return builder.release();
+    }
+
+    ColumnTable toColumns(const std::string &text, const std::vector<ColumnSpec> &fields)
+    {
+        return toColumns(text, ParseOptions(), fields);
+    }
+
+    ColumnTable toColumns(const std::string &text, const ParseOptions &options, const std::vector<ColumnSpec> &fields)
+    {
+        ColumnBuilder builder(fields);
+        ColumnHandler handler(builder);
+        ParseError error;
+        if (!parse(text, options, handler, error))
+            throwParseError(error);
+        return builder.release();
+    }
+}
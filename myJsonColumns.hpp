@@ -0,0 +1,69 @@
+//
+//  myJsonColumns.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  对象数组按字段拆成列: [{"price": 1.5, "sku": "a"}, ...] -> price列(double), sku列(字符串)
+//
+//      ColumnTable table = toColumns(text, {{"price", ColumnType::NUMBER}, {"sku", ColumnType::STRING}});
+//      const Column &price = table["price"];
+//      for (size_t i = 0; i < table.rows; i++) sum += price.numbers[i]; // 连续内存, 编译器可以向量化
+//
+//  - 数字列: 每行一个double, 整数也转成double
+//  - 字符串列: offsets有rows+1个, 第i行是blob[offsets[i], offsets[i+1])
+//  - 每列一个有效位图, 第i位为1表示这一行有值; 字段缺失或者是null时为0, 这时数字是0, 字符串是空串
+//  - 只认数组最外层的对象的直接成员, 值的类型和列不符时抛myJsonException, 重复的key取最后一个(和parse()默认的一样)
+//  - 从文本直接拆列的版本走SAX, 不建树, 行数多的时候内存只有列本身
+//
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    enum class ColumnType
+    {
+        NUMBER,
+        STRING
+    };
+
+    struct ColumnSpec
+    {
+        std::string name;
+        ColumnType type;
+    };
+
+    struct Column
+    {
+        std::string name;
+        ColumnType type = ColumnType::NUMBER;
+
+        std::vector<double> numbers;  // NUMBER
+        std::vector<uint32_t> offsets; // STRING, rows + 1个
+        std::string blob;              // STRING
+        std::vector<uint64_t> valid;   // 有效位图, 每个uint64管64行
+
+        bool isValid(size_t row) const { return (valid[row / 64] >> (row % 64)) & 1; }
+        std::string_view string(size_t row) const { return std::string_view(blob.data() + offsets[row], offsets[row + 1] - offsets[row]); }
+    };
+
+    struct ColumnTable
+    {
+        size_t rows = 0;
+        std::vector<Column> columns; // 和fields的顺序一致
+
+        // 没有这一列时抛myJsonException
+        const Column &operator[](std::string_view name) const;
+    };
+
+    // json必须是数组, 每个元素必须是对象
+    ColumnTable toColumns(const Json &json, const std::vector<ColumnSpec> &fields);
+    // 直接从文本拆列, json格式不对时抛和parse一样的异常
+    ColumnTable toColumns(const std::string &text, const std::vector<ColumnSpec> &fields);
+    ColumnTable toColumns(const std::string &text, const ParseOptions &options, const std::vector<ColumnSpec> &fields);
+}
@@ -0,0 +1,461 @@
+//
+//  myJsonEdit.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonEdit.hpp"
+#include <algorithm>
+#include <set>
+#include "myJsonBind.hpp"
+#include "myJsonPatch.hpp"
+
+namespace myJson
+{
+    namespace
+    {
+        const size_t NPOS = std::string_view::npos;
+
+        // 路径最后一段对应的位置
+        struct Target
+        {
+            bool exists = false;
+            bool root = false;
+            bool inObject = false;
+            size_t begin = 0, end = 0; // 值的范围
+            size_t member = 0;         // 成员的开头(对象是key的引号, 数组就是值)
+            size_t prevEnd = NPOS;     // 前一个兄弟的值的结尾, 没有就是NPOS
+            size_t next = NPOS;        // 后一个兄弟的开头, 没有就是NPOS
+            size_t container = 0;      // 所在容器的 { 或 [
+            size_t close = 0;          // 不存在时: 所在容器的 } 或 ]
+            size_t count = 0;          // 不存在时: 容器里原有的元素个数
+        };
+
+        // 只认结构: 括号, 逗号, 冒号, 字符串的边界, 其他的token整段跳过
+        class StructureScanner
+        {
+        public:
+            explicit StructureScanner(std::string_view text) : m_text(text) {}
+
+            [[noreturn]] void error(const char *message, size_t pos) const
+            {
+                throw myJsonException(std::string("[ERROR] edit: ") + message + " at offset " + std::to_string(pos), pos);
+            }
+
+            size_t skipWhiteSpace(size_t pos) const
+            {
+                while (pos < m_text.size() && (m_text[pos] == ' ' || m_text[pos] == '\t' || m_text[pos] == '\n' || m_text[pos] == '\r'))
+                    pos++;
+                return pos;
+            }
+
+            static bool isDelimiter(char c)
+            {
+                switch (c)
+                {
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ',':
+                case ':':
+                case '\"':
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            char at(size_t pos) const
+            {
+                if (pos >= m_text.size())
+                    error("unexpected end", pos);
+                return m_text[pos];
+            }
+
+            // pos在开头的引号上, 返回结尾引号之后
+            size_t skipString(size_t pos) const
+            {
+                const char *data = m_text.data();
+                size_t size = m_text.size();
+                pos++;
+                while (pos < size)
+                {
+                    char c = data[pos];
+                    if (c == '\"')
+                        return pos + 1;
+                    pos += c == '\\' ? 2 : 1; // 跳过转义的那个字符
+                }
+                error("unexpected end", size);
+            }
+
+            // 读key, 没有转义时直接返回原文, 有转义时解码到buffer
+            size_t readKey(size_t pos, std::string &buffer, std::string_view &key) const
+            {
+                if (at(pos) != '\"')
+                    error("expected key", pos);
+                size_t end = skipString(pos);
+                std::string_view raw = m_text.substr(pos + 1, end - pos - 2);
+                if (raw.find('\\') == NPOS)
+                {
+                    key = raw;
+                    return end;
+                }
+                buffer.clear();
+                for (size_t i = 0; i < raw.size(); i++)
+                {
+                    if (raw[i] != '\\')
+                    {
+                        buffer += raw[i];
+                        continue;
+                    }
+                    switch (raw[++i])
+                    {
+                    case 'b':
+                        buffer += '\b';
+                        break;
+                    case 'f':
+                        buffer += '\f';
+                        break;
+                    case 'n':
+                        buffer += '\n';
+                        break;
+                    case 'r':
+                        buffer += '\r';
+                        break;
+                    case 't':
+                        buffer += '\t';
+                        break;
+                    case '\"':
+                    case '\\':
+                    case '/':
+                        buffer += raw[i];
+                        break;
+                    case 'u':
+                    {
+                        char utf8[4];
+                        size_t bytes = decodeUnicodeEscape(raw, i, utf8);
+                        if (bytes == 0)
+                            error("invalid escape", pos + i);
+                        buffer.append(utf8, bytes);
+                        break;
+                    }
+                    default:
+                        error("invalid escape", pos + i);
+                    }
+                }
+                key = buffer;
+                return end;
+            }
+
+            // 返回值结尾的位置
+            // 容器里面只需要认引号和括号, 逗号冒号和标量都不影响深度, 一个字符一个字符地快速跳过
+            size_t skipValue(size_t pos) const
+            {
+                char c = at(pos);
+                if (c == '\"')
+                    return skipString(pos);
+                if (c != '{' && c != '[')
+                {
+                    // 数字和字面量
+                    size_t begin = pos;
+                    while (pos < m_text.size() && !isDelimiter(m_text[pos]))
+                        pos++;
+                    if (pos == begin)
+                        error("unexpected character", pos);
+                    return pos;
+                }
+                const char *data = m_text.data();
+                size_t size = m_text.size();
+                size_t depth = 1;
+                pos++;
+                while (pos < size)
+                {
+                    c = data[pos];
+                    if (c == '\"')
+                    {
+                        pos = skipString(pos);
+                        continue;
+                    }
+                    if (c == '{' || c == '[')
+                        depth++;
+                    else if ((c == '}' || c == ']') && --depth == 0)
+                        return pos + 1;
+                    pos++;
+                }
+                error("unexpected end", size);
+            }
+
+            // 找路径, 中间的段不存在时抛异常, 最后一段不存在时返回exists=false
+            Target locate(const std::vector<std::string> &tokens) const
+            {
+                Target target;
+                size_t pos = skipWhiteSpace(0);
+                if (tokens.empty())
+                {
+                    target.exists = target.root = true;
+                    target.begin = pos;
+                    target.end = skipValue(pos);
+                    return target;
+                }
+                std::string buffer;
+                for (size_t i = 0; i < tokens.size(); i++)
+                {
+                    const std::string &token = tokens[i];
+                    bool last = i + 1 == tokens.size();
+                    char open = at(pos);
+                    if (open != '{' && open != '[')
+                        error("path goes through a scalar", pos);
+                    bool isObject = open == '{';
+                    size_t index = 0;
+                    if (!isObject && token != "-" && !parseArrayIndex(token, index))
+                        error("invalid array index", pos);
+                    if (!isObject && token == "-")
+                        index = NPOS;
+
+                    target = Target();
+                    target.inObject = isObject;
+                    target.container = pos;
+                    pos = skipWhiteSpace(pos + 1);
+                    bool found = false;
+                    size_t count = 0;
+                    size_t prevEnd = NPOS;
+                    char close = isObject ? '}' : ']';
+                    while (at(pos) != close)
+                    {
+                        size_t member = pos;
+                        bool match = false;
+                        if (isObject)
+                        {
+                            std::string_view key;
+                            pos = skipWhiteSpace(readKey(pos, buffer, key));
+                            if (at(pos) != ':')
+                                error("expected ':'", pos);
+                            pos = skipWhiteSpace(pos + 1);
+                            match = key == token;
+                        }
+                        else
+                        {
+                            match = count == index;
+                        }
+                        size_t begin = pos;
+                        size_t end = skipValue(pos);
+                        pos = skipWhiteSpace(end);
+                        count++;
+                        if (at(pos) == ',')
+                            pos = skipWhiteSpace(pos + 1);
+                        else if (at(pos) != close)
+                            error(isObject ? "expected ',' or '}'" : "expected ',' or ']'", pos);
+                        if (match)
+                        {
+                            found = true;
+                            target.member = member;
+                            target.begin = begin;
+                            target.end = end;
+                            target.prevEnd = prevEnd;
+                            target.next = at(pos) == close ? NPOS : pos;
+                            // 重复的key和parse()默认的一样认最后一个, 对象要扫到结尾; 数组的下标找到就停
+                            if (!isObject)
+                                break;
+                        }
+                        prevEnd = end;
+                    }
+                    if (found)
+                        pos = target.begin;
+                    if (!found)
+                    {
+                        if (!last || (!isObject && index != NPOS))
+                            error("path not found", pos);
+                        target.close = pos;
+                        target.count = count;
+                        return target;
+                    }
+                    target.exists = true;
+                }
+                return target;
+            }
+
+        private:
+            std::string_view m_text;
+        };
+
+        std::vector<std::string> splitPath(std::string_view pointer)
+        {
+            std::vector<std::string> tokens;
+            if (!splitPointer(pointer, tokens))
+                throw myJsonException("[ERROR] edit: invalid pointer " + std::string(pointer), 0);
+            return tokens;
+        }
+    }
+
+    JsonEditor &JsonEditor::set(std::string_view pointer, const Json &value)
+    {
+        std::string text;
+        bind::writeAny(text, value);
+        return setRaw(pointer, text);
+    }
+
+    JsonEditor &JsonEditor::setRaw(std::string_view pointer, std::string_view value)
+    {
+        std::vector<std::string> tokens = splitPath(pointer);
+        Target target = StructureScanner(m_text).locate(tokens);
+        if (target.exists)
+        {
+            splice(Splice{target.begin, target.end - target.begin, std::string(value)});
+            return *this;
+        }
+        // 加在容器的最后, 逗号等resolve时看容器还剩几个成员再定
+        std::string text;
+        if (target.inObject)
+        {
+            bind::writeString(text, tokens.back());
+            text += ':';
+        }
+        text += value;
+        splice(Splice{target.close, 0, std::move(text), SpliceKind::APPEND, target.container});
+        m_containerSizes[target.container] = target.count;
+        return *this;
+    }
+
+    JsonEditor &JsonEditor::remove(std::string_view pointer)
+    {
+        std::vector<std::string> tokens = splitPath(pointer);
+        Target target = StructureScanner(m_text).locate(tokens);
+        if (!target.exists)
+            throw myJsonException("[ERROR] edit: path not found " + std::string(pointer), 0);
+        if (target.root)
+            throw myJsonException("[ERROR] edit: cannot remove the root", 0);
+        // 先只占住成员本身, 相邻的成员一起删时逗号不会算两次
+        splice(Splice{target.member, target.end - target.member, std::string(), SpliceKind::REMOVE, target.container, target.prevEnd, target.next});
+        return *this;
+    }
+
+    void JsonEditor::splice(Splice edit)
+    {
+        size_t offset = edit.offset;
+        size_t length = edit.length;
+        // 插入(length为0)可以挨着别的编辑, 但不能落在别的编辑中间
+        for (const Splice &other : m_splices)
+        {
+            bool overlap = length == 0 || other.length == 0
+                               ? (other.offset < offset && offset < other.offset + other.length) || (offset < other.offset && other.offset < offset + length)
+                               : offset < other.offset + other.length && other.offset < offset + length;
+            if (overlap)
+                throw myJsonException("[ERROR] edit: overlapping edits at offset " + std::to_string(offset), offset);
+        }
+        // 同一个位置的插入保持调用的顺序
+        auto iter = std::upper_bound(m_splices.begin(), m_splices.end(), offset, [](size_t value, const Splice &splice)
+                                     { return value < splice.offset; });
+        m_splices.insert(iter, std::move(edit));
+    }
+
+    std::vector<JsonEditor::Piece> JsonEditor::resolve() const
+    {
+        // 删掉的成员后面还有留下的兄弟: 连同后面的逗号一起删, 到下一个成员的开头
+        // 后面的兄弟全删了(包括自己是最后一个): 连同前面的逗号一起删, 从前一个值的结尾开始
+        // 这样一串相邻的删除正好首尾相接, 删光时也不会剩下逗号
+        // 倒着扫, 后一个兄弟先定下来
+        std::set<size_t> trailing;
+        std::map<size_t, size_t> removed; // 容器 -> 删掉的成员数
+        for (auto iter = m_splices.rbegin(); iter != m_splices.rend(); ++iter)
+        {
+            if (iter->kind != SpliceKind::REMOVE)
+                continue;
+            if (iter->next == NPOS || trailing.count(iter->next))
+                trailing.insert(iter->offset);
+            removed[iter->container]++;
+        }
+
+        std::vector<Piece> pieces;
+        pieces.reserve(m_splices.size());
+        std::set<size_t> appended;
+        for (const Splice &splice : m_splices)
+        {
+            Piece piece{splice.offset, splice.length, false, &splice.replacement};
+            if (splice.kind == SpliceKind::REMOVE)
+            {
+                size_t end = splice.offset + splice.length;
+                if (!trailing.count(splice.offset))
+                    end = splice.next;
+                else if (splice.prevEnd != NPOS)
+                    piece.offset = splice.prevEnd;
+                piece.length = end - piece.offset;
+            }
+            else if (splice.kind == SpliceKind::APPEND)
+            {
+                // 容器里还有原来的成员, 或者前面已经加过, 就要先加逗号
+                auto count = removed.find(splice.container);
+                size_t left = m_containerSizes.at(splice.container) - (count == removed.end() ? 0 : count->second);
+                piece.comma = left > 0 || !appended.insert(splice.container).second;
+            }
+            pieces.push_back(piece);
+        }
+        // 带走前面逗号的删除往前挪了, 挪过的范围里没有别的编辑, 排序不会打乱同一位置的插入
+        std::stable_sort(pieces.begin(), pieces.end(), [](const Piece &a, const Piece &b)
+                         { return a.offset < b.offset; });
+        return pieces;
+    }
+
+    size_t JsonEditor::size() const
+    {
+        size_t bytes = m_text.size();
+        for (const Piece &piece : resolve())
+            bytes = bytes - piece.length + piece.comma + piece.replacement->size();
+        return bytes;
+    }
+
+    void JsonEditor::apply(std::string &out) const
+    {
+        std::vector<Piece> pieces = resolve();
+        size_t bytes = m_text.size();
+        for (const Piece &piece : pieces)
+            bytes = bytes - piece.length + piece.comma + piece.replacement->size();
+        out.reserve(out.size() + bytes);
+        size_t pos = 0;
+        for (const Piece &piece : pieces)
+        {
+            out.append(m_text.data() + pos, piece.offset - pos);
+            if (piece.comma)
+                out += ',';
+            out += *piece.replacement;
+            pos = piece.offset + piece.length;
+        }
+        out.append(m_text.data() + pos, m_text.size() - pos);
+    }
+
+    std::string JsonEditor::apply() const
+    {
+        std::string out;
+        apply(out);
+        return out;
+    }
+
+#ifndef _WIN32
+    std::vector<iovec> JsonEditor::iovecs() const
+    {
+        std::vector<iovec> iov;
+        iov.reserve(m_splices.size() * 3 + 1);
+        auto push = [&iov](const char *data, size_t length)
+        {
+            if (length > 0)
+                iov.push_back(iovec{const_cast<char *>(data), length});
+        };
+        static const char comma = ',';
+        size_t pos = 0;
+        for (const Piece &piece : resolve())
+        {
+            push(m_text.data() + pos, piece.offset - pos);
+            if (piece.comma)
+                push(&comma, 1);
+            push(piece.replacement->data(), piece.replacement->size());
+            pos = piece.offset + piece.length;
+        }
+        push(m_text.data() + pos, m_text.size() - pos);
+        return iov;
+    }
+#endif
+}
@@ -0,0 +1,94 @@
+//
+//  myJsonEdit.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  直接在序列化好的文本上改值, 不parse整个文档也不重新dump
+//
+//      JsonEditor editor(blob);
+//      editor.set("/users/3/name", Json("bob")).remove("/users/3/tmp");
+//      std::string patched = editor.apply();     // 或者 editor.iovecs() 交给writev
+//
+//  - 按JSON Pointer找位置: 只扫描结构, 不要的值整段跳过, 找到之后后面的内容不再看(对象要扫完, 重复的key认最后一个)
+//  - 每次编辑记成一段替换(原文的字节范围 -> 新的字节), 没改的部分逐字节保持原样
+//  - 新值用writeJson的紧凑格式写, 加成员/删成员时顺带处理逗号, 空白保持原文的
+//    逗号归谁等所有编辑都记下来之后再定, 一个容器里删几个相邻的成员, 删光再加都可以
+//  - 所有编辑都按原文定位, 互相重叠(比如先改/a再改/a/b)时抛myJsonException
+//  - 假定原文是合法的json, 扫描时只检查找路径用到的结构
+//
+#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "myJson.hpp"
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+namespace myJson
+{
+    class JsonEditor
+    {
+    public:
+        // 不拷贝text, text要比editor活得久
+        explicit JsonEditor(std::string_view text) : m_text(text) {}
+
+        // 替换已有的值; 对象里没有的key加在最后; 数组的"-"表示追加
+        JsonEditor &set(std::string_view pointer, const Json &value);
+        // value是已经序列化好的json, 原样放进去, 不检查
+        JsonEditor &setRaw(std::string_view pointer, std::string_view value);
+        // 删掉对象成员或者数组元素, 路径不存在时抛myJsonException
+        JsonEditor &remove(std::string_view pointer);
+
+        size_t editCount() const { return m_splices.size(); }
+        // 改完之后的大小, 不用真的拼出来
+        size_t size() const;
+
+        std::string apply() const;
+        void apply(std::string &out) const; // 追加到out后面
+#ifndef _WIN32
+        // 没改的段指向原文, 改过的段指向editor里的新内容, 两者都活着时有效
+        std::vector<iovec> iovecs() const;
+#endif
+
+    private:
+        enum class SpliceKind
+        {
+            REPLACE,
+            REMOVE, // 删成员, 登记时只是成员本身, 连带的逗号在resolve里定
+            APPEND  // 加在容器最后, 要不要先加逗号在resolve里定
+        };
+
+        // 原文的[offset, offset + length)换成replacement, 按offset排序
+        struct Splice
+        {
+            size_t offset;
+            size_t length;
+            std::string replacement;
+            SpliceKind kind = SpliceKind::REPLACE;
+            size_t container = 0; // REMOVE/APPEND: 所在容器开头的偏移
+            size_t prevEnd = 0;   // REMOVE: 前一个兄弟的值的结尾, 没有是npos
+            size_t next = 0;      // REMOVE: 后一个兄弟的开头, 没有是npos
+        };
+
+        // resolve之后真正要替换的一段, 指向Splice里的内容
+        struct Piece
+        {
+            size_t offset;
+            size_t length;
+            bool comma;
+            const std::string *replacement;
+        };
+
+        std::string_view m_text;
+        std::vector<Splice> m_splices;
+        std::map<size_t, size_t> m_containerSizes; // 加过成员的容器原有的成员数, key是容器开头的偏移
+
+        // 定下每个删除带走哪个逗号, 追加要不要逗号, 返回按offset排好的
+        std::vector<Piece> resolve() const;
+        void splice(Splice edit);
+    };
+}
@@ -0,0 +1,705 @@
+//
+//  myJsonLiteral.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  编译期的JSON字面量(C++20)
+//
+//      using namespace myJson::literals;
+//      auto config = R"({"port": 8080, "hosts": ["a", "b"]})"_json;
+//      config["port"].getInt64();
+//
+//  - constexpr的parser在编译期把文本解析并直接编码成快照格式(见myJsonSnapshot.hpp)的字节, 放在只读的静态存储里
+//  - _json返回SnapshotValue, 读接口和Json一致, 运行时没有解析也没有分配
+//  - 字面量格式不对时常量求值里抛异常, 编译直接失败, 报错的调用链里能看到是哪一步不认
+//  - 语义和parse()默认的一致: 同样的转义, 重复的key以最后一个为准, 整数按INT64/UINT64存, 数字语法都按RFC 8259(不接受01, 1., .5)
+//    非规格化数照常存, 太小的下溢成±0, 只有溢出成无穷大的算超出范围
+//  - 生成的字节和dumpSnapshot(parse(文本))完全相同, 也可以交给Snapshot校验
+//
+#pragma once
+#if __cplusplus < 202002L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#error "myJsonLiteral.hpp requires C++20"
+#endif
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "myJsonSnapshot.hpp"
+
+namespace myJson
+{
+    namespace literal
+    {
+        // 字面量做模板参数用
+        template <size_t N>
+        struct FixedString
+        {
+            char data[N] = {};
+
+            constexpr FixedString(const char (&str)[N])
+            {
+                std::copy_n(str, N, data);
+            }
+
+            constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+        };
+
+        // 编译期递归有深度限制(gcc默认512层), 字面量的嵌套不会很深
+        inline constexpr size_t MAX_LITERAL_DEPTH = 128;
+
+        // 解析出来的临时树, 只活在常量求值里
+        struct LiteralNode
+        {
+            JsonValueType type = JsonValueType::NUL;
+            uint64_t payload = 0; // bool / 整数 / double的位
+            std::string text;     // 字符串
+            std::vector<size_t> children;
+            std::vector<std::string> keys; // 对象的key, 和children一一对应
+        };
+
+        // 多精度无符号整数, 只用来把十进制数正确舍入成double
+        class BigInt
+        {
+        public:
+            constexpr explicit BigInt(uint32_t value = 0)
+            {
+                if (value)
+                    m_limbs.push_back(value);
+            }
+
+            constexpr void mulAdd(uint32_t mul, uint32_t add)
+            {
+                uint64_t carry = add;
+                for (uint32_t &limb : m_limbs)
+                {
+                    uint64_t value = uint64_t(limb) * mul + carry;
+                    limb = static_cast<uint32_t>(value);
+                    carry = value >> 32;
+                }
+                if (carry)
+                    m_limbs.push_back(static_cast<uint32_t>(carry));
+            }
+
+            constexpr void mulPow10(size_t exponent)
+            {
+                for (; exponent >= 9; exponent -= 9)
+                    mulAdd(1000000000u, 0);
+                uint32_t rest = 1;
+                while (exponent--)
+                    rest *= 10;
+                mulAdd(rest, 0);
+            }
+
+            constexpr void shiftLeft(size_t bits)
+            {
+                if (m_limbs.empty())
+                    return;
+                m_limbs.insert(m_limbs.begin(), bits / 32, 0u);
+                bits %= 32;
+                if (bits == 0)
+                    return;
+                uint32_t carry = 0;
+                for (uint32_t &limb : m_limbs)
+                {
+                    uint32_t next = limb >> (32 - bits);
+                    limb = (limb << bits) | carry;
+                    carry = next;
+                }
+                if (carry)
+                    m_limbs.push_back(carry);
+            }
+
+            // 调用方保证 *this >= other
+            constexpr void subtract(const BigInt &other)
+            {
+                int64_t borrow = 0;
+                for (size_t i = 0; i < m_limbs.size(); i++)
+                {
+                    int64_t value = int64_t(m_limbs[i]) - borrow - (i < other.m_limbs.size() ? int64_t(other.m_limbs[i]) : 0);
+                    borrow = value < 0;
+                    m_limbs[i] = static_cast<uint32_t>(value + (borrow << 32));
+                }
+                trim();
+            }
+
+            constexpr int compare(const BigInt &other) const
+            {
+                if (m_limbs.size() != other.m_limbs.size())
+                    return m_limbs.size() < other.m_limbs.size() ? -1 : 1;
+                for (size_t i = m_limbs.size(); i-- > 0;)
+                {
+                    if (m_limbs[i] != other.m_limbs[i])
+                        return m_limbs[i] < other.m_limbs[i] ? -1 : 1;
+                }
+                return 0;
+            }
+
+            constexpr size_t bitLength() const
+            {
+                if (m_limbs.empty())
+                    return 0;
+                return (m_limbs.size() - 1) * 32 + std::bit_width(m_limbs.back());
+            }
+
+        private:
+            std::vector<uint32_t> m_limbs; // 低位在前
+
+            constexpr void trim()
+            {
+                while (!m_limbs.empty() && m_limbs.back() == 0)
+                    m_limbs.pop_back();
+            }
+        };
+
+        class LiteralParser
+        {
+        public:
+            constexpr explicit LiteralParser(std::string_view in) : m_in(in) {}
+
+            // 返回根节点的下标, 节点在nodes()里
+            constexpr size_t parse()
+            {
+                skipWhiteSpace();
+                if (m_pos == m_in.size())
+                    error("empty input");
+                size_t root = parseValue(0);
+                skipWhiteSpace();
+                if (m_pos != m_in.size())
+                    error("root not singular");
+                return root;
+            }
+
+            constexpr const std::vector<LiteralNode> &nodes() const { return m_nodes; }
+
+        private:
+            std::string_view m_in;
+            size_t m_pos = 0;
+            std::vector<LiteralNode> m_nodes;
+
+            // 常量求值里抛异常就是编译错误
+            [[noreturn]] void error(const char *message) const
+            {
+                throw myJsonException(std::string("[ERROR] json literal: ") + message + " at offset " + std::to_string(m_pos), m_pos);
+            }
+
+            constexpr void skipWhiteSpace()
+            {
+                while (m_pos < m_in.size() && (m_in[m_pos] == ' ' || m_in[m_pos] == '\t' || m_in[m_pos] == '\n' || m_in[m_pos] == '\r'))
+                    m_pos++;
+            }
+
+            constexpr size_t addNode(JsonValueType type, uint64_t payload = 0)
+            {
+                LiteralNode node;
+                node.type = type;
+                node.payload = payload;
+                m_nodes.push_back(std::move(node));
+                return m_nodes.size() - 1;
+            }
+
+            constexpr void parseLiteral(std::string_view literal)
+            {
+                if (m_in.substr(m_pos, literal.size()) != literal)
+                    error("invalid literal");
+                m_pos += literal.size();
+            }
+
+            constexpr size_t parseValue(size_t depth)
+            {
+                if (m_pos == m_in.size())
+                    error("unexpected end");
+                switch (m_in[m_pos])
+                {
+                case 'n':
+                    parseLiteral("null");
+                    return addNode(JsonValueType::NUL);
+                case 't':
+                    parseLiteral("true");
+                    return addNode(JsonValueType::BOOL, 1);
+                case 'f':
+                    parseLiteral("false");
+                    return addNode(JsonValueType::BOOL, 0);
+                case '\"':
+                {
+                    size_t index = addNode(JsonValueType::STRING);
+                    std::string text = parseString();
+                    m_nodes[index].text = std::move(text);
+                    return index;
+                }
+                case '[':
+                    return parseArray(depth + 1);
+                case '{':
+                    return parseObject(depth + 1);
+                default:
+                    return parseNumber();
+                }
+            }
+
+            // 转义和parse()支持的一样
+            constexpr std::string parseString()
+            {
+                std::string out;
+                m_pos++;
+                while (1)
+                {
+                    if (m_pos == m_in.size())
+                        error("unexpected end");
+                    char c = m_in[m_pos];
+                    if (c == '\"')
+                        break;
+                    if (c == '\\')
+                    {
+                        if (++m_pos == m_in.size())
+                            error("unexpected end");
+                        switch (m_in[m_pos])
+                        {
+                        case '\"':
+                        case '\\':
+                        case '/':
+                            out += m_in[m_pos];
+                            break;
+                        case 'b':
+                            out += '\b';
+                            break;
+                        case 'f':
+                            out += '\f';
+                            break;
+                        case 'n':
+                            out += '\n';
+                            break;
+                        case 'r':
+                            out += '\r';
+                            break;
+                        case 't':
+                            out += '\t';
+                            break;
+                        case 'u':
+                        {
+                            char utf8[4] = {};
+                            size_t bytes = decodeUnicodeEscape(m_in, m_pos, utf8);
+                            if (bytes == 0)
+                            {
+                                m_pos--;
+                                error("invalid escape");
+                            }
+                            out.append(utf8, bytes);
+                            break;
+                        }
+                        default:
+                            m_pos--;
+                            error("invalid escape");
+                        }
+                    }
+                    else if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        error("unescaped control character");
+                    }
+                    else
+                    {
+                        out += c;
+                    }
+                    m_pos++;
+                }
+                m_pos++;
+                return out;
+            }
+
+            constexpr size_t parseArray(size_t depth)
+            {
+                if (depth > MAX_LITERAL_DEPTH)
+                    error("depth exceeded");
+                size_t index = addNode(JsonValueType::ARRAY);
+                m_pos++;
+                skipWhiteSpace();
+                if (m_pos < m_in.size() && m_in[m_pos] == ']')
+                {
+                    m_pos++;
+                    return index;
+                }
+                while (1)
+                {
+                    skipWhiteSpace();
+                    size_t child = parseValue(depth);
+                    m_nodes[index].children.push_back(child); // parseValue可能让m_nodes扩容, 不能提前拿引用
+                    skipWhiteSpace();
+                    if (m_pos == m_in.size())
+                        error("unexpected end");
+                    if (m_in[m_pos] == ']')
+                        break;
+                    if (m_in[m_pos] != ',')
+                        error("expected ',' or ']'");
+                    m_pos++;
+                }
+                m_pos++;
+                return index;
+            }
+
+            constexpr size_t parseObject(size_t depth)
+            {
+                if (depth > MAX_LITERAL_DEPTH)
+                    error("depth exceeded");
+                size_t index = addNode(JsonValueType::OBJECT);
+                m_pos++;
+                skipWhiteSpace();
+                if (m_pos < m_in.size() && m_in[m_pos] == '}')
+                {
+                    m_pos++;
+                    return index;
+                }
+                while (1)
+                {
+                    skipWhiteSpace();
+                    if (m_pos == m_in.size() || m_in[m_pos] != '\"')
+                        error("expected key");
+                    std::string key = parseString();
+                    skipWhiteSpace();
+                    if (m_pos == m_in.size() || m_in[m_pos] != ':')
+                        error("expected ':'");
+                    m_pos++;
+                    skipWhiteSpace();
+                    size_t child = parseValue(depth);
+                    // 和parse()默认的一样, 重复的key以最后一个为准
+                    const std::vector<std::string> &keys = m_nodes[index].keys;
+                    auto found = std::find(keys.begin(), keys.end(), key);
+                    if (found == keys.end())
+                    {
+                        m_nodes[index].keys.push_back(std::move(key));
+                        m_nodes[index].children.push_back(child);
+                    }
+                    else
+                    {
+                        m_nodes[index].children[found - keys.begin()] = child;
+                    }
+                    skipWhiteSpace();
+                    if (m_pos == m_in.size())
+                        error("unexpected end");
+                    if (m_in[m_pos] == '}')
+                        break;
+                    if (m_in[m_pos] != ',')
+                        error("expected ',' or '}'");
+                    m_pos++;
+                }
+                m_pos++;
+                return index;
+            }
+
+            // RFC 8259的数字语法; 能放进int64/uint64的整数和parse()一样存成整数, 其余的正确舍入成double
+            constexpr size_t parseNumber()
+            {
+                size_t start = m_pos;
+                bool negative = m_in[m_pos] == '-';
+                if (negative)
+                    m_pos++;
+                std::string digits; // 去掉前导0的有效数字
+                int64_t exponent = 0;
+                bool isInteger = true;
+                if (m_pos < m_in.size() && m_in[m_pos] == '0')
+                {
+                    m_pos++;
+                }
+                else if (m_pos < m_in.size() && m_in[m_pos] >= '1' && m_in[m_pos] <= '9')
+                {
+                    while (m_pos < m_in.size() && m_in[m_pos] >= '0' && m_in[m_pos] <= '9')
+                        digits += m_in[m_pos++];
+                }
+                else
+                {
+                    m_pos = start;
+                    error("invalid number");
+                }
+                if (m_pos < m_in.size() && m_in[m_pos] == '.')
+                {
+                    isInteger = false;
+                    m_pos++;
+                    size_t fraction = m_pos;
+                    while (m_pos < m_in.size() && m_in[m_pos] >= '0' && m_in[m_pos] <= '9')
+                    {
+                        if (!digits.empty() || m_in[m_pos] != '0')
+                            digits += m_in[m_pos];
+                        exponent--;
+                        m_pos++;
+                    }
+                    if (m_pos == fraction)
+                        error("invalid number");
+                }
+                if (m_pos < m_in.size() && (m_in[m_pos] == 'e' || m_in[m_pos] == 'E'))
+                {
+                    isInteger = false;
+                    m_pos++;
+                    bool negativeExponent = false;
+                    if (m_pos < m_in.size() && (m_in[m_pos] == '+' || m_in[m_pos] == '-'))
+                        negativeExponent = m_in[m_pos++] == '-';
+                    size_t begin = m_pos;
+                    int64_t value = 0;
+                    while (m_pos < m_in.size() && m_in[m_pos] >= '0' && m_in[m_pos] <= '9')
+                    {
+                        if (value < 100000) // 再大也只是溢出或者变成0, 不用再累加
+                            value = value * 10 + (m_in[m_pos] - '0');
+                        m_pos++;
+                    }
+                    if (m_pos == begin)
+                        error("invalid number");
+                    exponent += negativeExponent ? -value : value;
+                }
+
+                if (isInteger)
+                {
+                    uint64_t value = 0;
+                    bool overflow = false;
+                    for (char c : digits)
+                    {
+                        unsigned digit = static_cast<unsigned>(c - '0');
+                        if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                            overflow = true;
+                        value = value * 10 + digit;
+                    }
+                    const uint64_t int64Limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1;
+                    if (!overflow && (!negative || value <= int64Limit))
+                    {
+                        if (negative)
+                            return addNode(JsonValueType::INT64, value == int64Limit ? value : static_cast<uint64_t>(-static_cast<int64_t>(value)));
+                        if (value < int64Limit)
+                            return addNode(JsonValueType::INT64, value);
+                        return addNode(JsonValueType::UINT64, value);
+                    }
+                }
+                return addNode(JsonValueType::NUMBER, toDouble(negative, digits, exponent, start));
+            }
+
+            // 值 = digits * 10^exponent, 返回double的位
+            // 先用多精度算出53位的商, 再按余数做round-half-even, 结果和from_chars一致
+            constexpr uint64_t toDouble(bool negative, const std::string &digits, int64_t exponent, size_t start)
+            {
+                const uint64_t sign = negative ? uint64_t(1) << 63 : 0;
+                if (digits.empty())
+                    return sign;
+                // 十进制的量级先筛掉一定溢出/一定变成0的
+                int64_t magnitude = static_cast<int64_t>(digits.size()) + exponent;
+                if (magnitude > 310)
+                {
+                    m_pos = start;
+                    error("number out of range");
+                }
+                if (magnitude < -324)
+                    return sign;
+
+                BigInt num;
+                for (char c : digits)
+                    num.mulAdd(10, static_cast<uint32_t>(c - '0'));
+                BigInt den(1);
+                if (exponent >= 0)
+                    num.mulPow10(static_cast<size_t>(exponent));
+                else
+                    den.mulPow10(static_cast<size_t>(-exponent));
+
+                // 找k使得 num/den / 2^k 落在[2^52, 2^53), 太小的数k固定在-1074, 商不够52位就是非规格化数
+                int64_t k = static_cast<int64_t>(num.bitLength()) - static_cast<int64_t>(den.bitLength()) - 53;
+                uint64_t q = 0;
+                BigInt remainder;
+                BigInt divisor;
+                while (1)
+                {
+                    if (k < -1074)
+                        k = -1074;
+                    remainder = num;
+                    divisor = den;
+                    if (k < 0)
+                        remainder.shiftLeft(static_cast<size_t>(-k));
+                    else
+                        divisor.shiftLeft(static_cast<size_t>(k));
+                    // 商最多55位, 逐位试减
+                    q = 0;
+                    for (int bit = 55; bit >= 0; bit--)
+                    {
+                        BigInt shifted = divisor;
+                        shifted.shiftLeft(static_cast<size_t>(bit));
+                        if (remainder.compare(shifted) >= 0)
+                        {
+                            remainder.subtract(shifted);
+                            q |= uint64_t(1) << bit;
+                        }
+                    }
+                    if (q < (uint64_t(1) << 53))
+                        break;
+                    k++;
+                }
+                remainder.shiftLeft(1);
+                int cmp = remainder.compare(divisor);
+                if (cmp > 0 || (cmp == 0 && (q & 1)))
+                    q++;
+                if (q == (uint64_t(1) << 53))
+                {
+                    q >>= 1;
+                    k++;
+                }
+                // 和parse()一样只有溢出算超出范围; 商不够52位时k是-1074, 指数位为0, 正好是非规格化数的编码(q为0就是±0)
+                if (k > 971)
+                {
+                    m_pos = start;
+                    error("number out of range");
+                }
+                if (q < (uint64_t(1) << 52))
+                    return sign | q;
+                return sign | (uint64_t(k + 1075) << 52) | (q & ((uint64_t(1) << 52) - 1));
+            }
+        };
+
+        ///////////////编码成快照//////////////////////
+        // 布局和myJsonSnapshot.cpp里的SnapshotHeader/SnapNode/SnapEntry一致, 按本机字节序写
+        inline constexpr size_t SNAP_HEADER_SIZE = 48;
+        inline constexpr size_t SNAP_ROOT_OFFSET = 32;
+        inline constexpr size_t SNAP_NODE_SIZE = 16;
+        inline constexpr size_t SNAP_ENTRY_SIZE = 32;
+
+        class LiteralEncoder
+        {
+        public:
+            constexpr explicit LiteralEncoder(const std::vector<LiteralNode> &nodes) : m_nodes(nodes) {}
+
+            // 和SnapshotWriter的顺序一样: 先预留子节点块, 再按顺序编码子节点, 字符串按第一次出现的顺序进池
+            constexpr std::vector<char> encode(size_t root)
+            {
+                m_out.assign(SNAP_HEADER_SIZE, '\0');
+                const char magic[8] = {'M', 'Y', 'J', 'S', 'N', 'A', 'P', '\0'};
+                std::copy_n(magic, 8, m_out.begin());
+                put(8, 1, 4);          // version
+                put(12, 0x01020304, 4); // byteOrder
+                writeNode(SNAP_ROOT_OFFSET, root);
+                put(24, m_out.size(), 8); // stringsOffset
+                m_out.insert(m_out.end(), m_strings.begin(), m_strings.end());
+                put(16, m_out.size(), 8); // size
+                return std::move(m_out);
+            }
+
+        private:
+            const std::vector<LiteralNode> &m_nodes;
+            std::vector<char> m_out;
+            std::string m_strings;
+            std::vector<std::pair<std::string, uint64_t>> m_stringIndex;
+
+            constexpr void put(size_t offset, uint64_t value, size_t width)
+            {
+                for (size_t i = 0; i < width; i++)
+                {
+                    size_t shift = std::endian::native == std::endian::little ? i : width - 1 - i;
+                    m_out[offset + i] = static_cast<char>((value >> (shift * 8)) & 0xff);
+                }
+            }
+
+            constexpr uint64_t intern(const std::string &str)
+            {
+                for (const auto &entry : m_stringIndex)
+                {
+                    if (entry.first == str)
+                        return entry.second;
+                }
+                uint64_t offset = m_strings.size();
+                m_strings += str;
+                m_stringIndex.emplace_back(str, offset);
+                return offset;
+            }
+
+            constexpr uint64_t reserve(size_t bytes)
+            {
+                uint64_t offset = m_out.size();
+                m_out.resize(m_out.size() + bytes, '\0');
+                return offset;
+            }
+
+            constexpr void writeNode(size_t offset, size_t index)
+            {
+                const LiteralNode &node = m_nodes[index];
+                uint64_t count = 0;
+                uint64_t payload = node.payload;
+                switch (node.type)
+                {
+                case JsonValueType::STRING:
+                    count = node.text.size();
+                    payload = intern(node.text);
+                    break;
+                case JsonValueType::ARRAY:
+                {
+                    count = node.children.size();
+                    payload = reserve(count * SNAP_NODE_SIZE);
+                    for (size_t i = 0; i < count; i++)
+                        writeNode(payload + i * SNAP_NODE_SIZE, node.children[i]);
+                    break;
+                }
+                case JsonValueType::OBJECT:
+                {
+                    // 快照里的entry按key排序
+                    count = node.children.size();
+                    std::vector<size_t> order(count);
+                    for (size_t i = 0; i < count; i++)
+                        order[i] = i;
+                    std::sort(order.begin(), order.end(), [&node](size_t a, size_t b)
+                              { return node.keys[a] < node.keys[b]; });
+                    payload = reserve(count * SNAP_ENTRY_SIZE);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        size_t slot = payload + i * SNAP_ENTRY_SIZE;
+                        const std::string &key = node.keys[order[i]];
+                        put(slot, key.size(), 4);
+                        put(slot + 8, intern(key), 8);
+                        writeNode(slot + 16, node.children[order[i]]);
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+                m_out[offset] = static_cast<char>(node.type);
+                put(offset + 4, count, 4);
+                put(offset + 8, payload, 8);
+            }
+        };
+
+        constexpr std::vector<char> lower(std::string_view text)
+        {
+            LiteralParser parser(text);
+            size_t root = parser.parse();
+            LiteralEncoder encoder(parser.nodes());
+            return encoder.encode(root);
+        }
+
+        // 常量求值里分配的内存不能留到运行时, 先求出大小, 再拷进定长数组
+        template <FixedString S>
+        struct Lowered
+        {
+            static constexpr size_t size = lower(S.view()).size();
+
+            static constexpr std::array<char, size> build()
+            {
+                std::vector<char> bytes = lower(S.view());
+                std::array<char, size> out{};
+                std::copy(bytes.begin(), bytes.end(), out.begin());
+                return out;
+            }
+
+            alignas(8) static constexpr std::array<char, size> bytes = build();
+        };
+
+        // 字面量的快照字节, 可以交给Snapshot或者写到文件里
+        template <FixedString S>
+        constexpr std::string_view snapshotBytes()
+        {
+            return std::string_view(Lowered<S>::bytes.data(), Lowered<S>::size);
+        }
+    }
+
+    namespace literals
+    {
+        template <literal::FixedString S>
+        constexpr SnapshotValue operator""_json()
+        {
+            using Lowered = literal::Lowered<S>;
+            return SnapshotValue(Lowered::bytes.data(), Lowered::size, Lowered::bytes.data() + literal::SNAP_ROOT_OFFSET);
+        }
+    }
+}
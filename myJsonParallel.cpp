@@ -0,0 +1,328 @@
+//
+//  myJsonParallel.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonParallel.hpp"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace myJson
+{
+    namespace
+    {
+        // 每个worker一个双端队列: 自己从尾部取, 空了从别人的头部偷
+        // 任务在开始前全部分好, 执行中不会产生新任务, 所以所有队列都空了就可以退出
+        class WorkStealingPool
+        {
+        public:
+            explicit WorkStealingPool(size_t workers) : m_queues(workers) {}
+
+            // 调用线程当0号worker, 全部做完才返回, 任务抛的第一个异常在这里重新抛出
+            void run(std::vector<std::function<void()>> &tasks)
+            {
+                for (size_t i = 0; i < tasks.size(); i++)
+                    m_queues[i % m_queues.size()].tasks.push_back(&tasks[i]);
+                std::vector<std::thread> threads;
+                for (size_t i = 1; i < m_queues.size(); i++)
+                    threads.emplace_back([this, i]
+                                         { work(i); });
+                work(0);
+                for (auto &thread : threads)
+                    thread.join();
+                if (m_error)
+                    std::rethrow_exception(m_error);
+            }
+
+        private:
+            struct Queue
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()> *> tasks;
+            };
+
+            std::vector<Queue> m_queues;
+            std::mutex m_errorMutex;
+            std::exception_ptr m_error;
+
+            std::function<void()> *pop(size_t self)
+            {
+                {
+                    Queue &own = m_queues[self];
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (!own.tasks.empty())
+                    {
+                        std::function<void()> *task = own.tasks.back();
+                        own.tasks.pop_back();
+                        return task;
+                    }
+                }
+                for (size_t i = 1; i < m_queues.size(); i++)
+                {
+                    Queue &victim = m_queues[(self + i) % m_queues.size()];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty())
+                    {
+                        std::function<void()> *task = victim.tasks.front();
+                        victim.tasks.pop_front();
+                        return task;
+                    }
+                }
+                return nullptr;
+            }
+
+            void work(size_t self)
+            {
+                while (std::function<void()> *task = pop(self))
+                {
+                    try
+                    {
+                        (*task)();
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(m_errorMutex);
+                        if (!m_error)
+                            m_error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        // 数到limit就停, 小树不用走完
+        size_t countNodes(const Json &node, size_t limit)
+        {
+            size_t count = 1;
+            if (node.is_array())
+            {
+                for (const Json &item : node.getArray())
+                {
+                    if (count >= limit)
+                        break;
+                    count += countNodes(item, limit - count);
+                }
+            }
+            else if (node.is_object())
+            {
+                for (const auto &member : node.getObject())
+                {
+                    if (count >= limit)
+                        break;
+                    count += countNodes(member.second, limit - count);
+                }
+            }
+            return count;
+        }
+
+        // 输出切成一串piece: 固定的部分由这里顺序写好, 任务的部分各自写进自己的piece
+        // 大容器(元素数>=splitCount)按元素切成连续的几段, 每段一个任务;
+        // 小容器只输出边界, 接着往下找大容器, 超过MAX_LEVEL层的整个子树当一个任务
+        class DumpPlan
+        {
+        public:
+            DumpPlan(size_t splitCount, size_t taskCount)
+                : pieces(1), m_splitCount(splitCount), m_taskCount(taskCount) {}
+
+            std::vector<std::string> pieces;
+            std::vector<std::function<void()>> tasks;
+
+            void plan(const Json &node, size_t depth, size_t level)
+            {
+                if (node.is_array())
+                    planArray(node.getArray(), depth, level);
+                else if (node.is_object())
+                    planObject(node.getObject(), depth, level);
+                else
+                    node.dump(current(), depth);
+            }
+
+        private:
+            static const size_t MAX_LEVEL = 16;
+            size_t m_splitCount;
+            size_t m_taskCount;
+
+            std::string &current() { return pieces.back(); }
+
+            // 任务的piece后面再开一个新的固定piece, 任务执行时pieces已经不会再变了
+            size_t addTask()
+            {
+                pieces.emplace_back();
+                pieces.emplace_back();
+                return pieces.size() - 2;
+            }
+
+            void planChild(const Json &child, size_t depth, size_t level)
+            {
+                if (level < MAX_LEVEL)
+                {
+                    plan(child, depth, level);
+                    return;
+                }
+                size_t piece = addTask();
+                tasks.emplace_back([this, &child, depth, piece]
+                                   { child.dump(pieces[piece], depth); });
+            }
+
+            void planArray(const array &items, size_t depth, size_t level)
+            {
+                DumpFormat::beginArray(current(), depth);
+                if (items.size() >= m_splitCount)
+                {
+                    size_t grain = (items.size() + m_taskCount - 1) / m_taskCount;
+                    for (size_t begin = 0; begin < items.size(); begin += grain)
+                    {
+                        size_t end = std::min(items.size(), begin + grain);
+                        size_t piece = addTask();
+                        tasks.emplace_back([this, &items, begin, end, depth, piece]
+                                           {
+                                               std::string &out = pieces[piece];
+                                               for (size_t i = begin; i < end; i++)
+                                               {
+                                                   DumpFormat::arrayItem(out, i, depth);
+                                                   items[i].dump(out, depth + 1);
+                                               } });
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < items.size(); i++)
+                    {
+                        DumpFormat::arrayItem(current(), i, depth);
+                        planChild(items[i], depth + 1, level + 1);
+                    }
+                }
+                DumpFormat::endArray(current(), items.size(), depth);
+            }
+
+            void planObject(const object &members, size_t depth, size_t level)
+            {
+                DumpFormat::beginObject(current(), depth);
+                if (members.size() >= m_splitCount)
+                {
+                    size_t grain = (members.size() + m_taskCount - 1) / m_taskCount;
+                    auto iter = members.begin();
+                    for (size_t begin = 0; begin < members.size(); begin += grain)
+                    {
+                        size_t end = std::min(members.size(), begin + grain);
+                        auto first = iter;
+                        std::advance(iter, end - begin);
+                        size_t piece = addTask();
+                        tasks.emplace_back([this, first, begin, end, depth, piece]
+                                           {
+                                               std::string &out = pieces[piece];
+                                               auto member = first;
+                                               for (size_t i = begin; i < end; i++, ++member)
+                                               {
+                                                   DumpFormat::objectMember(out, i, member->first, depth);
+                                                   member->second.dump(out, depth + 1);
+                                               } });
+                    }
+                }
+                else
+                {
+                    size_t index = 0;
+                    for (const auto &member : members)
+                    {
+                        DumpFormat::objectMember(current(), index++, member.first, depth);
+                        planChild(member.second, depth + 1, level + 1);
+                    }
+                }
+                DumpFormat::endObject(current(), members.size(), depth);
+            }
+        };
+
+        size_t threadCount(const ParallelDumpOptions &options)
+        {
+            if (options.threads)
+                return options.threads;
+            return std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // 返回false表示不值得并行, 直接dump
+        bool runPlan(const Json &json, const ParallelDumpOptions &options, std::vector<std::string> &pieces)
+        {
+            size_t threads = threadCount(options);
+            if (threads == 1 || countNodes(json, options.minParallelNodes) < options.minParallelNodes)
+                return false;
+            DumpPlan plan(std::max<size_t>(2, threads * 2), threads * std::max<size_t>(1, options.tasksPerThread));
+            plan.plan(json, 0, 0);
+            if (!plan.tasks.empty())
+                WorkStealingPool(std::min(threads, plan.tasks.size())).run(plan.tasks);
+            pieces = std::move(plan.pieces);
+            return true;
+        }
+    }
+
+    std::string dumpParallel(const Json &json, const ParallelDumpOptions &options)
+    {
+        std::vector<std::string> pieces;
+        if (!runPlan(json, options, pieces))
+            return json.dump();
+        size_t total = 0;
+        for (const auto &piece : pieces)
+            total += piece.size();
+        std::string out;
+        out.reserve(total);
+        for (const auto &piece : pieces)
+            out += piece;
+        return out;
+    }
+
+#ifndef _WIN32
+    namespace
+    {
+        bool writeAll(int fd, const std::vector<std::string> &pieces)
+        {
+            std::vector<iovec> iov;
+            iov.reserve(pieces.size());
+            for (const auto &piece : pieces)
+            {
+                if (!piece.empty())
+                    iov.push_back({const_cast<char *>(piece.data()), piece.size()});
+            }
+            size_t next = 0;
+            while (next < iov.size())
+            {
+                int count = static_cast<int>(std::min<size_t>(iov.size() - next, IOV_MAX));
+                ssize_t written = ::writev(fd, &iov[next], count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                // 跳过写完的, 写了一半的从剩下的地方接着写
+                size_t remaining = static_cast<size_t>(written);
+                while (next < iov.size() && remaining >= iov[next].iov_len)
+                    remaining -= iov[next++].iov_len;
+                if (remaining)
+                {
+                    iov[next].iov_base = static_cast<char *>(iov[next].iov_base) + remaining;
+                    iov[next].iov_len -= remaining;
+                }
+            }
+            return true;
+        }
+    }
+
+    bool dumpParallel(const Json &json, int fd, const ParallelDumpOptions &options)
+    {
+        std::vector<std::string> pieces;
+        if (!runPlan(json, options, pieces))
+            pieces.assign(1, json.dump());
+        return writeAll(fd, pieces);
+    }
+#endif
+}
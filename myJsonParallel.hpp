@@ -0,0 +1,31 @@
+//
+//  myJsonParallel.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  多线程dump: 大的数组/对象按元素切成连续的几段, 每段在工作窃取的线程池里各自dump到自己的buffer,
+//  最后按顺序拼起来或者用writev直接写出去. 分段的边界用DumpFormat输出, 结果和dump()逐字节一样
+//
+//  只对大树有意义, 节点数少于minParallelNodes时直接走dump()
+//
+#pragma once
+#include <string>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    struct ParallelDumpOptions
+    {
+        size_t threads = 0;                // 0表示std::thread::hardware_concurrency(), 调用线程也算一个
+        size_t minParallelNodes = 1 << 14; // 树比这个小就不开线程
+        size_t tasksPerThread = 8;         // 切得细一些, 子树大小不均时靠窃取补平
+    };
+
+    std::string dumpParallel(const Json &json, const ParallelDumpOptions &options = ParallelDumpOptions());
+
+#ifndef _WIN32
+    // 每段直接用writev写到fd, 不拼成一整块. 写失败返回false, errno是write的错误
+    bool dumpParallel(const Json &json, int fd, const ParallelDumpOptions &options = ParallelDumpOptions());
+#endif
+}
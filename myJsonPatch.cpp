@@ -0,0 +1,422 @@
+//
+//  myJsonPatch.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonPatch.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace myJson
+{
+    namespace
+    {
+        const Json *findChild(const Json &parent, const std::string &token)
+        {
+            if (parent.is_object())
+            {
+                const object &members = parent.getObject();
+                auto iter = members.find(token);
+                return iter == members.end() ? nullptr : &iter->second;
+            }
+            size_t index;
+            if (parent.is_array() && parseArrayIndex(token, index) && index < parent.getArray().size())
+                return &parent.getArray()[index];
+            return nullptr;
+        }
+
+        // 要改的路径上走非const的operator[], 顺便清掉路上节点缓存的hash
+        Json *findChild(Json &parent, const std::string &token)
+        {
+            if (!findChild(static_cast<const Json &>(parent), token))
+                return nullptr;
+            if (parent.is_object())
+                return &parent[token];
+            size_t index;
+            parseArrayIndex(token, index);
+            return &parent[index];
+        }
+
+        ///////////////diff//////////////////////
+        Json makeOp(const char *op, const std::string &path)
+        {
+            Json result{object()};
+            result["op"] = op;
+            result["path"] = path;
+            return result;
+        }
+
+        void diffValue(const Json &from, const Json &to, std::string &path, Json &patch);
+
+        // 两边的key都是有序的, 一遍归并就能分出删除/新增/都有的key
+        void diffObject(const object &from, const object &to, std::string &path, Json &patch)
+        {
+            auto a = from.begin();
+            auto b = to.begin();
+            size_t length = path.size();
+            while (a != from.end() || b != to.end())
+            {
+                if (b == to.end() || (a != from.end() && a->first < b->first))
+                {
+                    path += "/" + escapePointerToken(a->first);
+                    patch.addToArray(makeOp("remove", path));
+                    ++a;
+                }
+                else if (a == from.end() || b->first < a->first)
+                {
+                    path += "/" + escapePointerToken(b->first);
+                    Json op = makeOp("add", path);
+                    op["value"] = b->second;
+                    patch.addToArray(op);
+                    ++b;
+                }
+                else
+                {
+                    path += "/" + escapePointerToken(a->first);
+                    diffValue(a->second, b->second, path, patch);
+                    ++a;
+                    ++b;
+                }
+                path.resize(length);
+            }
+        }
+
+        // 去掉相同的头尾, 中间的按下标逐个比较, 多出来的删掉或者补上
+        void diffArray(const array &from, const array &to, std::string &path, Json &patch)
+        {
+            size_t begin = 0;
+            while (begin < from.size() && begin < to.size() && from[begin] == to[begin])
+                begin++;
+            size_t fromEnd = from.size();
+            size_t toEnd = to.size();
+            while (fromEnd > begin && toEnd > begin && from[fromEnd - 1] == to[toEnd - 1])
+            {
+                fromEnd--;
+                toEnd--;
+            }
+
+            size_t length = path.size();
+            size_t common = std::min(fromEnd, toEnd);
+            for (size_t i = begin; i < common; i++)
+            {
+                path += "/" + std::to_string(i);
+                diffValue(from[i], to[i], path, patch);
+                path.resize(length);
+            }
+            // 从后往前删, 前面的下标不受影响
+            for (size_t i = fromEnd; i > common; i--)
+            {
+                patch.addToArray(makeOp("remove", path + "/" + std::to_string(i - 1)));
+            }
+            for (size_t i = common; i < toEnd; i++)
+            {
+                Json op = makeOp("add", path + "/" + std::to_string(i));
+                op["value"] = to[i];
+                patch.addToArray(op);
+            }
+        }
+
+        void diffValue(const Json &from, const Json &to, std::string &path, Json &patch)
+        {
+            if (from == to)
+                return;
+            if (from.is_object() && to.is_object())
+            {
+                diffObject(from.getObject(), to.getObject(), path, patch);
+            }
+            else if (from.is_array() && to.is_array())
+            {
+                diffArray(from.getArray(), to.getArray(), path, patch);
+            }
+            else
+            {
+                Json op = makeOp("replace", path);
+                op["value"] = to;
+                patch.addToArray(op);
+            }
+        }
+
+        ///////////////apply//////////////////////
+        [[noreturn]] void patchError(size_t op, const std::string &message)
+        {
+            throw myJsonException("[ERROR] patch op " + std::to_string(op) + ": " + message, op);
+        }
+
+        // 路径的父节点和最后一段, 整个文档时parent是nullptr
+        struct Location
+        {
+            Json *parent = nullptr;
+            std::string token;
+        };
+
+        Location locate(Json &doc, const std::string &pointer, size_t op)
+        {
+            std::vector<std::string> tokens;
+            if (!splitPointer(pointer, tokens))
+                patchError(op, "invalid pointer " + pointer);
+            Location location;
+            if (tokens.empty())
+                return location;
+            location.token = std::move(tokens.back());
+            tokens.pop_back();
+            Json *parent = &doc;
+            for (const auto &token : tokens)
+            {
+                parent = findChild(*parent, token);
+                if (!parent)
+                    patchError(op, "path not found " + pointer);
+            }
+            if (!parent->is_object() && !parent->is_array())
+                patchError(op, "parent is not a container " + pointer);
+            location.parent = parent;
+            return location;
+        }
+
+        std::string member(const Json &op, std::string_view name, size_t index)
+        {
+            const object &members = op.getObject();
+            auto iter = members.find(name);
+            if (iter == members.end() || !iter->second.is_string())
+                patchError(index, "missing \"" + std::string(name) + "\"");
+            const jsonstring &value = iter->second.getString();
+            return std::string(value.data(), value.size());
+        }
+
+        const Json &valueOf(const Json &op, size_t index)
+        {
+            const object &members = op.getObject();
+            auto iter = members.find("value");
+            if (iter == members.end())
+                patchError(index, "missing \"value\"");
+            return iter->second;
+        }
+
+        void addValue(Json &doc, const std::string &path, const Json &value, size_t op)
+        {
+            Location location = locate(doc, path, op);
+            if (!location.parent)
+            {
+                doc = value;
+                return;
+            }
+            Json &parent = *location.parent;
+            if (parent.is_object())
+            {
+                parent[location.token] = value;
+                return;
+            }
+            size_t index;
+            if (location.token == "-")
+                parent.addToArray(value);
+            else if (parseArrayIndex(location.token, index) && index <= parent.getArray().size())
+                parent.insertToArray(index, value);
+            else
+                patchError(op, "invalid array index " + path);
+        }
+
+        Json removeValue(Json &doc, const std::string &path, size_t op)
+        {
+            Location location = locate(doc, path, op);
+            if (!location.parent)
+                patchError(op, "cannot remove the whole document");
+            Json &parent = *location.parent;
+            Json *target = findChild(parent, location.token);
+            if (!target)
+                patchError(op, "path not found " + path);
+            Json removed = std::move(*target);
+            if (parent.is_object())
+            {
+                parent.removeFromObject(location.token);
+            }
+            else
+            {
+                size_t index;
+                parseArrayIndex(location.token, index);
+                parent.removeFromArray(index);
+            }
+            return removed;
+        }
+    }
+
+    bool splitPointer(std::string_view pointer, std::vector<std::string> &tokens)
+    {
+        tokens.clear();
+        if (pointer.empty())
+            return true;
+        if (pointer[0] != '/')
+            return false;
+        size_t pos = 1;
+        while (1)
+        {
+            size_t end = std::min(pointer.find('/', pos), pointer.size());
+            std::string token;
+            for (size_t i = pos; i < end; i++)
+            {
+                if (pointer[i] != '~')
+                {
+                    token += pointer[i];
+                    continue;
+                }
+                if (i + 1 == end || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+                    return false;
+                token += pointer[++i] == '0' ? '~' : '/';
+            }
+            tokens.push_back(std::move(token));
+            if (end == pointer.size())
+                return true;
+            pos = end + 1;
+        }
+    }
+
+    bool parseArrayIndex(const std::string &token, size_t &index)
+    {
+        if (token.empty() || token.size() > 19 || (token.size() > 1 && token[0] == '0'))
+            return false;
+        index = 0;
+        for (char c : token)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            index = index * 10 + static_cast<size_t>(c - '0');
+        }
+        return true;
+    }
+
+    std::string escapePointerToken(std::string_view token)
+    {
+        std::string out;
+        out.reserve(token.size());
+        for (char c : token)
+        {
+            if (c == '~')
+                out += "~0";
+            else if (c == '/')
+                out += "~1";
+            else
+                out += c;
+        }
+        return out;
+    }
+
+    const Json *findPointer(const Json &doc, std::string_view pointer)
+    {
+        std::vector<std::string> tokens;
+        if (!splitPointer(pointer, tokens))
+            return nullptr;
+        const Json *current = &doc;
+        for (const auto &token : tokens)
+        {
+            current = findChild(*current, token);
+            if (!current)
+                return nullptr;
+        }
+        return current;
+    }
+
+    Json *findPointer(Json &doc, std::string_view pointer)
+    {
+        std::vector<std::string> tokens;
+        if (!splitPointer(pointer, tokens))
+            return nullptr;
+        Json *current = &doc;
+        for (const auto &token : tokens)
+        {
+            current = findChild(*current, token);
+            if (!current)
+                return nullptr;
+        }
+        return current;
+    }
+
+    Json diff(const Json &from, const Json &to)
+    {
+        Json patch{array()};
+        std::string path;
+        diffValue(from, to, path, patch);
+        return patch;
+    }
+
+    void applyPatch(Json &doc, const Json &patch)
+    {
+        if (!patch.is_array())
+            throw myJsonException("[ERROR] patch must be an array", 0);
+        const array &ops = patch.getArray();
+        for (size_t i = 0; i < ops.size(); i++)
+        {
+            const Json &op = ops[i];
+            if (!op.is_object())
+                patchError(i, "op must be an object");
+            std::string name = member(op, "op", i);
+            std::string path = member(op, "path", i);
+            if (name == "add")
+            {
+                addValue(doc, path, valueOf(op, i), i);
+            }
+            else if (name == "remove")
+            {
+                removeValue(doc, path, i);
+            }
+            else if (name == "replace")
+            {
+                Json *target = findPointer(doc, path);
+                if (!target)
+                    patchError(i, "path not found " + path);
+                *target = valueOf(op, i);
+            }
+            else if (name == "move")
+            {
+                std::string from = member(op, "from", i);
+                if (from == path)
+                    continue;
+                // 不能挪到自己下面
+                if (path.size() > from.size() && path.compare(0, from.size(), from) == 0 && path[from.size()] == '/')
+                    patchError(i, "cannot move " + from + " into itself");
+                Json value = removeValue(doc, from, i);
+                addValue(doc, path, value, i);
+            }
+            else if (name == "copy")
+            {
+                std::string from = member(op, "from", i);
+                const Json *source = findPointer(doc, from);
+                if (!source)
+                    patchError(i, "path not found " + from);
+                Json value = *source; // 先拷出来, add可能让source失效
+                addValue(doc, path, value, i);
+            }
+            else if (name == "test")
+            {
+                const Json *target = findPointer(doc, path);
+                if (!target || *target != valueOf(op, i))
+                    patchError(i, "test failed at " + path);
+            }
+            else
+            {
+                patchError(i, "unknown op " + name);
+            }
+        }
+    }
+
+    void mergePatch(Json &target, const Json &patch)
+    {
+        if (!patch.is_object())
+        {
+            target = patch;
+            return;
+        }
+        if (!target.is_object())
+            target = Json(object());
+        for (auto iter = patch.const_objectBegin(); iter != patch.const_objectEnd(); ++iter)
+        {
+            if (iter->second.is_null())
+            {
+                if (target.getObject().count(iter->first))
+                    target.removeFromObject(iter->first);
+            }
+            else
+            {
+                mergePatch(target[iter->first], iter->second);
+            }
+        }
+    }
+}
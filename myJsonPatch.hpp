@@ -0,0 +1,40 @@
+//
+//  myJsonPatch.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  增量同步: JSON Pointer(RFC 6901), JSON Patch(RFC 6902), JSON Merge Patch(RFC 7386)
+//
+//  - diff只走变了的部分: 相同的子树靠operator==跳过, 对象按有序的key归并, 数组先去掉相同的头尾
+//  - patch是一个op数组, 可以直接dump出去发给别的节点, 对面parse之后applyPatch
+//
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    // JSON Pointer的一段: ~ 写成 ~0, / 写成 ~1
+    std::string escapePointerToken(std::string_view token);
+    // 拆成一段段并去掉转义, 格式不对返回false
+    bool splitPointer(std::string_view pointer, std::vector<std::string> &tokens);
+    // 数组下标: 只能是十进制数字, 不能有多余的前导0
+    bool parseArrayIndex(const std::string &token, size_t &index);
+    // 按JSON Pointer找值, 空串是整个文档, 找不到返回nullptr
+    const Json *findPointer(const Json &doc, std::string_view pointer);
+    // 非const版本当作要修改, 路径上的节点都会清掉缓存的hash
+    Json *findPointer(Json &doc, std::string_view pointer);
+
+    // from变成to需要的JSON Patch, 只用add/remove/replace
+    Json diff(const Json &from, const Json &to);
+
+    // 按顺序执行patch里的op(add/remove/replace/move/copy/test), 失败时抛myJsonException, position是op的下标
+    // 直接在doc上改, 失败时前面的op已经生效了, 要整体回滚的话先拷贝一份
+    void applyPatch(Json &doc, const Json &patch);
+
+    // RFC 7386: patch里的null表示删除, 对象递归合并, 其他值直接替换
+    void mergePatch(Json &target, const Json &patch);
+}
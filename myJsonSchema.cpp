@@ -0,0 +1,1356 @@
+//
+//  myJsonSchema.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonSchema.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include "myJsonPatch.hpp"
+
+namespace myJson
+{
+    namespace
+    {
+        enum TypeBits : unsigned
+        {
+            TYPE_NULL = 1,
+            TYPE_BOOLEAN = 2,
+            TYPE_OBJECT = 4,
+            TYPE_ARRAY = 8,
+            TYPE_NUMBER = 16,
+            TYPE_STRING = 32,
+            TYPE_INTEGER = 64,
+            TYPE_ANY = 127
+        };
+
+        const char *const TYPE_NAMES[] = {"null", "boolean", "object", "array", "number", "string", "integer"};
+
+        // 没有schema约束的值, 比如没写items的数组元素
+        const size_t NO_NODE = SIZE_MAX;
+
+        std::string typeList(unsigned types)
+        {
+            std::string out;
+            for (unsigned i = 0; i < 7; i++)
+            {
+                if (!(types & (1u << i)))
+                    continue;
+                if (!out.empty())
+                    out += "/";
+                out += TYPE_NAMES[i];
+            }
+            return out;
+        }
+
+        // 按字符数算, 不是字节数
+        size_t utf8Length(std::string_view value)
+        {
+            size_t length = 0;
+            for (char c : value)
+            {
+                if ((static_cast<unsigned char>(c) & 0xC0) != 0x80)
+                    length++;
+            }
+            return length;
+        }
+
+        std::string formatNumber(double value)
+        {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            return std::string(buffer, result.ptr);
+        }
+    }
+
+    ///////////////pattern//////////////////////
+    namespace
+    {
+        const uint32_t NO_CHAR = UINT32_MAX; // 字符串的开头之前/结尾之后
+
+        // 按UTF-8解一个字符, 不合法的字节当成单独一个字符
+        uint32_t decodeChar(std::string_view text, size_t pos, size_t &length)
+        {
+            unsigned char lead = static_cast<unsigned char>(text[pos]);
+            length = lead < 0x80 ? 1 : lead >= 0xF0 && lead < 0xF8 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+            if (length == 0 || length > text.size() - pos)
+            {
+                length = 1;
+                return lead;
+            }
+            if (length == 1)
+                return lead;
+            uint32_t c = lead & (0x7F >> length);
+            for (size_t i = 1; i < length; i++)
+            {
+                unsigned char next = static_cast<unsigned char>(text[pos + i]);
+                if ((next & 0xC0) != 0x80)
+                {
+                    length = 1;
+                    return lead;
+                }
+                c = (c << 6) | (next & 0x3F);
+            }
+            return c;
+        }
+
+        bool isWordChar(uint32_t c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        bool isLineTerminator(uint32_t c)
+        {
+            return c == '\n' || c == '\r' || c == 0x2028 || c == 0x2029;
+        }
+    }
+
+    // ECMA-262正则的一个子集, JSON Schema建议pattern只用这些:
+    // 字面量, ., [...], \d \w \s \D \W \S, \b \B, ^ $, (...) (?:...), |, * + ? {n} {n,} {n,m}和它们的非贪婪形式
+    // 反向引用和环视不支持, 编译时报错
+    // 用Thompson NFA匹配: 每个字符把所有状态一起往前推一步, 不回溯也不递归,
+    // 时间是O(字符串长度 × 程序长度), 栈深度和输入无关(std::regex每个字符递归一层, 长字符串会爆栈)
+    class Pattern
+    {
+    public:
+        // 格式不对或者用了不支持的语法时抛myJsonException
+        void compile(std::string_view text)
+        {
+            m_text = text;
+            m_pos = 0;
+            m_depth = 0;
+            m_program.clear();
+            m_classes.clear();
+            Node root = parseAlternation();
+            if (m_pos < m_text.size())
+                fail("unmatched ')'");
+            emit(root);
+            push({Op::MATCH});
+        }
+
+        // 不锚定, 和ECMA-262的search一样, 字符串里任何位置开始匹配上都算
+        bool search(std::string_view input) const
+        {
+            std::vector<uint32_t> current, next, stack;
+            std::vector<size_t> mark(m_program.size(), SIZE_MAX); // 状态在哪个位置已经加过
+            size_t pos = 0;
+            uint32_t prev = NO_CHAR;
+            size_t length = 0;
+            uint32_t c = input.empty() ? NO_CHAR : decodeChar(input, 0, length);
+            while (true)
+            {
+                // 每个位置都从头开始一个新的线程
+                if (follow(0, pos, prev, c, current, stack, mark))
+                    return true;
+                if (c == NO_CHAR)
+                    return false;
+                size_t nextPos = pos + length;
+                uint32_t nextChar = nextPos < input.size() ? decodeChar(input, nextPos, length) : NO_CHAR;
+                next.clear();
+                for (uint32_t pc : current)
+                {
+                    if (consumes(m_program[pc], c) && follow(pc + 1, nextPos, c, nextChar, next, stack, mark))
+                        return true;
+                }
+                current.swap(next);
+                pos = nextPos;
+                prev = c;
+                c = nextChar;
+            }
+        }
+
+    private:
+        // {n,m}展开之后的指令数上限, 防止{1000}{1000}这种撑爆内存
+        static constexpr size_t MAX_PROGRAM = 100000;
+        static constexpr size_t MAX_NESTING = 256;
+
+        enum class Op : uint8_t
+        {
+            CHAR,  // x是字符
+            ANY,   // 除了换行的任意字符
+            CLASS, // x是m_classes的下标
+            SPLIT, // 同时走x和y
+            JMP,
+            BEGIN, // ^
+            END,   // $
+            WORD_BOUNDARY,
+            NOT_WORD_BOUNDARY,
+            MATCH
+        };
+
+        struct Inst
+        {
+            Op op;
+            uint32_t x = 0;
+            uint32_t y = 0;
+        };
+
+        struct CharClass
+        {
+            std::vector<std::pair<uint32_t, uint32_t>> ranges; // 闭区间
+            bool negate = false;
+
+            bool contains(uint32_t c) const
+            {
+                bool found = false;
+                for (const auto &range : ranges)
+                {
+                    if (c >= range.first && c <= range.second)
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+                return found != negate;
+            }
+        };
+
+        // 语法树, 展开{n,m}时要把子树重复生成几遍
+        struct Node
+        {
+            enum Kind
+            {
+                EMPTY,
+                INST, // 单条指令: 字符, ., 字符类, 断言
+                CONCAT,
+                ALTERNATE,
+                REPEAT
+            } kind = EMPTY;
+            Inst inst{Op::MATCH};
+            size_t min = 0, max = 0; // REPEAT, max是SIZE_MAX表示不限
+            std::vector<Node> children;
+        };
+
+        std::string_view m_text;
+        size_t m_pos = 0;
+        size_t m_depth = 0;
+        std::vector<Inst> m_program;
+        std::vector<CharClass> m_classes;
+
+        [[noreturn]] void fail(const char *message) const
+        {
+            throw myJsonException(std::string(message) + " at offset " + std::to_string(m_pos), m_pos);
+        }
+
+        bool atEnd() const { return m_pos >= m_text.size(); }
+        char peek() const { return m_text[m_pos]; }
+
+        uint32_t nextChar()
+        {
+            size_t length;
+            uint32_t c = decodeChar(m_text, m_pos, length);
+            m_pos += length;
+            return c;
+        }
+
+        static Node single(Inst inst)
+        {
+            Node node;
+            node.kind = Node::INST;
+            node.inst = inst;
+            return node;
+        }
+
+        Node parseAlternation()
+        {
+            if (++m_depth > MAX_NESTING)
+                fail("pattern nested too deeply");
+            Node node = parseConcat();
+            if (!atEnd() && peek() == '|')
+            {
+                Node alternate;
+                alternate.kind = Node::ALTERNATE;
+                alternate.children.push_back(std::move(node));
+                while (!atEnd() && peek() == '|')
+                {
+                    m_pos++;
+                    alternate.children.push_back(parseConcat());
+                }
+                node = std::move(alternate);
+            }
+            m_depth--;
+            return node;
+        }
+
+        Node parseConcat()
+        {
+            Node concat;
+            concat.kind = Node::CONCAT;
+            while (!atEnd() && peek() != '|' && peek() != ')')
+            {
+                Node atom = parseAtom();
+                parseQuantifier(atom);
+                concat.children.push_back(std::move(atom));
+            }
+            return concat;
+        }
+
+        Node parseAtom()
+        {
+            char c = peek();
+            switch (c)
+            {
+            case '(':
+            {
+                m_pos++;
+                if (m_text.compare(m_pos, 2, "?:") == 0)
+                    m_pos += 2;
+                else if (!atEnd() && peek() == '?')
+                    fail("lookaround and named groups are not supported");
+                Node group = parseAlternation();
+                if (atEnd() || peek() != ')')
+                    fail("missing ')'");
+                m_pos++;
+                return group;
+            }
+            case '[':
+                m_pos++;
+                return single({Op::CLASS, parseClass()});
+            case '.':
+                m_pos++;
+                return single({Op::ANY});
+            case '^':
+                m_pos++;
+                return single({Op::BEGIN});
+            case '$':
+                m_pos++;
+                return single({Op::END});
+            case '*':
+            case '+':
+            case '?':
+                fail("nothing to repeat");
+            case '{':
+            {
+                size_t start = m_pos;
+                size_t min, max;
+                if (parseBraces(min, max))
+                {
+                    m_pos = start;
+                    fail("nothing to repeat");
+                }
+                m_pos = start + 1; // 不是量词的{当普通字符
+                return single({Op::CHAR, '{'});
+            }
+            case '\\':
+            {
+                m_pos++;
+                if (atEnd())
+                    fail("trailing '\\'");
+                char e = peek();
+                if (e == 'b' || e == 'B')
+                {
+                    m_pos++;
+                    return single({e == 'b' ? Op::WORD_BOUNDARY : Op::NOT_WORD_BOUNDARY});
+                }
+                CharClass escaped;
+                if (classEscape(escaped))
+                {
+                    m_classes.push_back(std::move(escaped));
+                    return single({Op::CLASS, static_cast<uint32_t>(m_classes.size() - 1)});
+                }
+                return single({Op::CHAR, characterEscape()});
+            }
+            default:
+                return single({Op::CHAR, nextChar()});
+            }
+        }
+
+        void parseQuantifier(Node &atom)
+        {
+            if (atEnd())
+                return;
+            size_t min, max;
+            char c = peek();
+            if (c == '*' || c == '+' || c == '?')
+            {
+                m_pos++;
+                min = c == '+' ? 1 : 0;
+                max = c == '?' ? 1 : SIZE_MAX;
+            }
+            else if (c != '{' || !parseBraces(min, max))
+            {
+                return;
+            }
+            if (!atEnd() && peek() == '?') // 非贪婪, 只问有没有匹配时和贪婪一样
+                m_pos++;
+            if (atom.kind == Node::INST && atom.inst.op >= Op::BEGIN)
+                fail("nothing to repeat");
+            Node repeat;
+            repeat.kind = Node::REPEAT;
+            repeat.min = min;
+            repeat.max = max;
+            repeat.children.push_back(std::move(atom));
+            atom = std::move(repeat);
+        }
+
+        // {n} {n,} {n,m}, 不是这几种形式时返回false, m_pos不动
+        bool parseBraces(size_t &min, size_t &max)
+        {
+            size_t pos = m_pos + 1;
+            auto number = [&](size_t &out)
+            {
+                size_t begin = pos;
+                out = 0;
+                while (pos < m_text.size() && m_text[pos] >= '0' && m_text[pos] <= '9')
+                    out = std::min<size_t>(out * 10 + (m_text[pos++] - '0'), MAX_PROGRAM + 1);
+                return pos > begin;
+            };
+            if (!number(min))
+                return false;
+            max = min;
+            if (pos < m_text.size() && m_text[pos] == ',')
+            {
+                pos++;
+                if (!number(max))
+                    max = SIZE_MAX;
+            }
+            if (pos >= m_text.size() || m_text[pos] != '}')
+                return false;
+            if (max < min)
+                fail("numbers out of order in {} quantifier");
+            m_pos = pos + 1;
+            return true;
+        }
+
+        // \d \w \s和大写的反义, 是的话填好out并吃掉
+        bool classEscape(CharClass &out)
+        {
+            char e = peek();
+            switch (e)
+            {
+            case 'd':
+            case 'D':
+                out.ranges = {{'0', '9'}};
+                break;
+            case 'w':
+            case 'W':
+                out.ranges = {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}};
+                break;
+            case 's':
+            case 'S':
+                out.ranges = {{'\t', '\r'}, {' ', ' '}, {0xA0, 0xA0}, {0x1680, 0x1680}, {0x2000, 0x200A}, {0x2028, 0x2029}, {0x202F, 0x202F}, {0x205F, 0x205F}, {0x3000, 0x3000}, {0xFEFF, 0xFEFF}};
+                break;
+            default:
+                return false;
+            }
+            out.negate = e >= 'A' && e <= 'Z';
+            m_pos++;
+            return true;
+        }
+
+        // '\'之后的单个字符
+        uint32_t characterEscape()
+        {
+            char e = peek();
+            switch (e)
+            {
+            case 'n':
+                m_pos++;
+                return '\n';
+            case 'r':
+                m_pos++;
+                return '\r';
+            case 't':
+                m_pos++;
+                return '\t';
+            case 'f':
+                m_pos++;
+                return '\f';
+            case 'v':
+                m_pos++;
+                return '\v';
+            case '0':
+                m_pos++;
+                if (!atEnd() && peek() >= '0' && peek() <= '9')
+                    fail("octal escapes are not supported");
+                return 0;
+            case 'x':
+            case 'u':
+            {
+                size_t digits = e == 'x' ? 2 : 4;
+                long value = 0;
+                for (size_t i = 1; i <= digits; i++)
+                {
+                    int digit = m_pos + i < m_text.size() ? hexDigit(m_text[m_pos + i]) : -1;
+                    if (digit < 0)
+                        fail("invalid hex escape");
+                    value = value * 16 + digit;
+                }
+                m_pos += digits + 1;
+                // 😀这样的代理对合成一个字符
+                if (e == 'u' && value >= 0xD800 && value <= 0xDBFF && m_text.compare(m_pos, 2, "\\u") == 0)
+                {
+                    long low = readHex4(m_text, m_pos + 2);
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        m_pos += 6;
+                        value = 0x10000 + ((value - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                }
+                return static_cast<uint32_t>(value);
+            }
+            default:
+                if (e >= '1' && e <= '9')
+                    fail("backreferences are not supported");
+                if ((e >= 'a' && e <= 'z') || (e >= 'A' && e <= 'Z'))
+                    fail("unknown escape");
+                return nextChar(); // 标点符号转义成自己
+            }
+        }
+
+        // '['之后, 返回m_classes的下标
+        uint32_t parseClass()
+        {
+            CharClass result;
+            if (!atEnd() && peek() == '^')
+            {
+                result.negate = true;
+                m_pos++;
+            }
+            while (atEnd() || peek() != ']')
+            {
+                if (atEnd())
+                    fail("missing ']'");
+                uint32_t low;
+                if (!classAtom(result, low))
+                    continue;
+                uint32_t high = low;
+                // a-z; 结尾的'-'是普通字符
+                if (m_pos + 1 < m_text.size() && peek() == '-' && m_text[m_pos + 1] != ']')
+                {
+                    m_pos++;
+                    CharClass ignored;
+                    if (!classAtom(ignored, high))
+                        fail("invalid character class range");
+                    if (high < low)
+                        fail("range out of order in character class");
+                }
+                result.ranges.push_back({low, high});
+            }
+            m_pos++;
+            m_classes.push_back(std::move(result));
+            return static_cast<uint32_t>(m_classes.size() - 1);
+        }
+
+        // 字符类里的一项: 单个字符返回true; \d这种把区间加进out, 返回false
+        bool classAtom(CharClass &out, uint32_t &c)
+        {
+            if (peek() != '\\')
+            {
+                c = nextChar();
+                return true;
+            }
+            m_pos++;
+            if (atEnd())
+                fail("trailing '\\'");
+            if (peek() == 'b') // 字符类里的\b是退格
+            {
+                m_pos++;
+                c = '\b';
+                return true;
+            }
+            if (peek() == '-')
+            {
+                m_pos++;
+                c = '-';
+                return true;
+            }
+            CharClass escaped;
+            if (!classEscape(escaped))
+            {
+                c = characterEscape();
+                return true;
+            }
+            if (!escaped.negate)
+            {
+                out.ranges.insert(out.ranges.end(), escaped.ranges.begin(), escaped.ranges.end());
+                return false;
+            }
+            // [\D]这种: 加补集
+            uint32_t from = 0;
+            for (const auto &range : escaped.ranges)
+            {
+                if (range.first > from)
+                    out.ranges.push_back({from, range.first - 1});
+                from = range.second + 1;
+            }
+            out.ranges.push_back({from, 0x10FFFF});
+            return false;
+        }
+
+        void push(Inst inst)
+        {
+            if (m_program.size() >= MAX_PROGRAM)
+                throw myJsonException("pattern too large after expanding repetitions", 0);
+            m_program.push_back(inst);
+        }
+
+        uint32_t here() const { return static_cast<uint32_t>(m_program.size()); }
+
+        void emit(const Node &node)
+        {
+            switch (node.kind)
+            {
+            case Node::EMPTY:
+                break;
+            case Node::INST:
+                push(node.inst);
+                break;
+            case Node::CONCAT:
+                for (const Node &child : node.children)
+                    emit(child);
+                break;
+            case Node::ALTERNATE:
+            {
+                // SPLIT L1, L2; L1: a; JMP end; L2: SPLIT ... 最后一个不用SPLIT
+                std::vector<uint32_t> jumps;
+                for (size_t i = 0; i < node.children.size(); i++)
+                {
+                    uint32_t split = here();
+                    bool last = i + 1 == node.children.size();
+                    if (!last)
+                        push({Op::SPLIT, split + 1});
+                    emit(node.children[i]);
+                    if (!last)
+                    {
+                        jumps.push_back(here());
+                        push({Op::JMP});
+                        m_program[split].y = here();
+                    }
+                }
+                for (uint32_t jump : jumps)
+                    m_program[jump].x = here();
+                break;
+            }
+            case Node::REPEAT:
+            {
+                const Node &child = node.children[0];
+                for (size_t i = 0; i < node.min; i++)
+                    emit(child);
+                if (node.max == SIZE_MAX)
+                {
+                    // L: SPLIT body, out; body: child; JMP L
+                    uint32_t loop = here();
+                    push({Op::SPLIT, loop + 1});
+                    emit(child);
+                    push({Op::JMP, loop});
+                    m_program[loop].y = here();
+                    break;
+                }
+                // 剩下的每一次都可以不要: SPLIT body, out; body: child; ...
+                std::vector<uint32_t> splits;
+                for (size_t i = node.min; i < node.max; i++)
+                {
+                    splits.push_back(here());
+                    push({Op::SPLIT, here() + 1});
+                    emit(child);
+                }
+                for (uint32_t split : splits)
+                    m_program[split].y = here();
+                break;
+            }
+            }
+        }
+
+        bool consumes(const Inst &inst, uint32_t c) const
+        {
+            switch (inst.op)
+            {
+            case Op::CHAR:
+                return c == inst.x;
+            case Op::ANY:
+                return !isLineTerminator(c);
+            case Op::CLASS:
+                return m_classes[inst.x].contains(c);
+            default:
+                return false;
+            }
+        }
+
+        // 从pc出发走完所有不吃字符的指令, 停在吃字符的指令上的加进list; 碰到MATCH返回true
+        // prev/c是当前位置前后的字符, 断言要用
+        bool follow(uint32_t start, size_t pos, uint32_t prev, uint32_t c, std::vector<uint32_t> &list,
+                    std::vector<uint32_t> &stack, std::vector<size_t> &mark) const
+        {
+            stack.clear();
+            stack.push_back(start);
+            while (!stack.empty())
+            {
+                uint32_t pc = stack.back();
+                stack.pop_back();
+                if (mark[pc] == pos)
+                    continue;
+                mark[pc] = pos;
+                const Inst &inst = m_program[pc];
+                switch (inst.op)
+                {
+                case Op::MATCH:
+                    return true;
+                case Op::JMP:
+                    stack.push_back(inst.x);
+                    break;
+                case Op::SPLIT:
+                    stack.push_back(inst.y);
+                    stack.push_back(inst.x);
+                    break;
+                case Op::BEGIN:
+                    if (prev == NO_CHAR)
+                        stack.push_back(pc + 1);
+                    break;
+                case Op::END:
+                    if (c == NO_CHAR)
+                        stack.push_back(pc + 1);
+                    break;
+                case Op::WORD_BOUNDARY:
+                case Op::NOT_WORD_BOUNDARY:
+                    if ((isWordChar(prev) != isWordChar(c)) == (inst.op == Op::WORD_BOUNDARY))
+                        stack.push_back(pc + 1);
+                    break;
+                default:
+                    list.push_back(pc);
+                    break;
+                }
+            }
+            return false;
+        }
+    };
+
+    // 编译好的一个schema, 子schema用下标引用
+    struct SchemaNode
+    {
+        bool reject = false; // false schema, 什么都不接受
+        unsigned types = TYPE_ANY;
+
+        bool hasMinimum = false, hasMaximum = false, hasExclusiveMinimum = false, hasExclusiveMaximum = false;
+        double minimum = 0, maximum = 0, exclusiveMinimum = 0, exclusiveMaximum = 0;
+
+        size_t minLength = 0, maxLength = SIZE_MAX;
+        bool hasPattern = false;
+        std::string patternText;
+        Pattern pattern;
+
+        size_t minItems = 0, maxItems = SIZE_MAX;
+        size_t items = NO_NODE;
+
+        size_t minProperties = 0, maxProperties = SIZE_MAX;
+        std::map<std::string, size_t, std::less<>> properties;
+        size_t additionalProperties = NO_NODE;
+        // required的名字和它在seen里的位置
+        std::vector<std::string> required;
+        std::map<std::string, size_t, std::less<>> requiredIndex;
+
+        bool hasEnum = false;
+        std::vector<Json> enumValues; // const也放在这里
+    };
+
+    struct Schema::Compiled
+    {
+        std::vector<SchemaNode> nodes; // nodes[0]是根
+    };
+
+    ///////////////编译//////////////////////
+    namespace
+    {
+        [[noreturn]] void schemaError(const std::string &pointer, const std::string &message)
+        {
+            throw myJsonException("[ERROR] schema " + (pointer.empty() ? std::string("(root)") : pointer) + ": " + message, 0);
+        }
+
+        class SchemaCompiler
+        {
+        public:
+            explicit SchemaCompiler(std::vector<SchemaNode> &nodes) : m_nodes(nodes) {}
+
+            size_t compile(const Json &schema, const std::string &pointer)
+            {
+                size_t index = m_nodes.size();
+                m_nodes.emplace_back();
+                if (schema.is_bool())
+                {
+                    m_nodes[index].reject = !schema.getBool();
+                    return index;
+                }
+                if (!schema.is_object())
+                    schemaError(pointer, "schema must be an object or a boolean");
+
+                // 先编译子schema, m_nodes扩容之后再取引用
+                const object &keywords = schema.getObject();
+                size_t items = NO_NODE;
+                size_t additional = NO_NODE;
+                std::map<std::string, size_t, std::less<>> properties;
+                if (const Json *value = find(keywords, "items"))
+                    items = compile(*value, pointer + "/items");
+                if (const Json *value = find(keywords, "additionalProperties"))
+                    additional = compile(*value, pointer + "/additionalProperties");
+                if (const Json *value = find(keywords, "properties"))
+                {
+                    if (!value->is_object())
+                        schemaError(pointer + "/properties", "must be an object");
+                    for (const auto &member : value->getObject())
+                    {
+                        std::string name(member.first.data(), member.first.size());
+                        size_t child = compile(member.second, pointer + "/properties/" + escapePointerToken(name));
+                        properties.emplace(std::move(name), child);
+                    }
+                }
+
+                SchemaNode &node = m_nodes[index];
+                node.items = items;
+                node.additionalProperties = additional;
+                node.properties = std::move(properties);
+                if (const Json *value = find(keywords, "type"))
+                    node.types = compileType(*value, pointer + "/type");
+                compileBound(keywords, "minimum", pointer, node.hasMinimum, node.minimum);
+                compileBound(keywords, "maximum", pointer, node.hasMaximum, node.maximum);
+                compileBound(keywords, "exclusiveMinimum", pointer, node.hasExclusiveMinimum, node.exclusiveMinimum);
+                compileBound(keywords, "exclusiveMaximum", pointer, node.hasExclusiveMaximum, node.exclusiveMaximum);
+                compileCount(keywords, "minLength", pointer, node.minLength);
+                compileCount(keywords, "maxLength", pointer, node.maxLength);
+                compileCount(keywords, "minItems", pointer, node.minItems);
+                compileCount(keywords, "maxItems", pointer, node.maxItems);
+                compileCount(keywords, "minProperties", pointer, node.minProperties);
+                compileCount(keywords, "maxProperties", pointer, node.maxProperties);
+                if (const Json *value = find(keywords, "pattern"))
+                {
+                    if (!value->is_string())
+                        schemaError(pointer + "/pattern", "must be a string");
+                    node.hasPattern = true;
+                    node.patternText.assign(value->getString().data(), value->getString().size());
+                    try
+                    {
+                        node.pattern.compile(node.patternText);
+                    }
+                    catch (const myJsonException &e)
+                    {
+                        schemaError(pointer + "/pattern", std::string("invalid regex: ") + e.what());
+                    }
+                }
+                if (const Json *value = find(keywords, "required"))
+                {
+                    if (!value->is_array())
+                        schemaError(pointer + "/required", "must be an array");
+                    for (const Json &name : value->getArray())
+                    {
+                        if (!name.is_string())
+                            schemaError(pointer + "/required", "names must be strings");
+                        std::string text(name.getString().data(), name.getString().size());
+                        if (node.requiredIndex.emplace(text, node.required.size()).second)
+                            node.required.push_back(std::move(text));
+                    }
+                }
+                if (const Json *value = find(keywords, "enum"))
+                {
+                    if (!value->is_array())
+                        schemaError(pointer + "/enum", "must be an array");
+                    node.hasEnum = true;
+                    node.enumValues.assign(value->getArray().begin(), value->getArray().end());
+                }
+                if (const Json *value = find(keywords, "const"))
+                {
+                    // enum和const都写了就是两个都要满足, 等价于enum里只留等于const的
+                    std::vector<Json> values;
+                    if (!node.hasEnum || std::find(node.enumValues.begin(), node.enumValues.end(), *value) != node.enumValues.end())
+                        values.push_back(*value);
+                    node.hasEnum = true;
+                    node.enumValues = std::move(values);
+                }
+                return index;
+            }
+
+        private:
+            std::vector<SchemaNode> &m_nodes;
+
+            static const Json *find(const object &keywords, std::string_view name)
+            {
+                auto iter = keywords.find(name);
+                return iter == keywords.end() ? nullptr : &iter->second;
+            }
+
+            static unsigned typeBit(const Json &name, const std::string &pointer)
+            {
+                if (name.is_string())
+                {
+                    std::string_view text(name.getString().data(), name.getString().size());
+                    for (unsigned i = 0; i < 7; i++)
+                    {
+                        if (text == TYPE_NAMES[i])
+                            return 1u << i;
+                    }
+                }
+                schemaError(pointer, "unknown type");
+            }
+
+            static unsigned compileType(const Json &value, const std::string &pointer)
+            {
+                if (!value.is_array())
+                    return typeBit(value, pointer);
+                unsigned types = 0;
+                for (const Json &name : value.getArray())
+                    types |= typeBit(name, pointer);
+                return types;
+            }
+
+            static void compileBound(const object &keywords, const char *name, const std::string &pointer, bool &has, double &out)
+            {
+                const Json *value = find(keywords, name);
+                if (!value)
+                    return;
+                if (!value->is_number())
+                    schemaError(pointer + "/" + name, "must be a number");
+                has = true;
+                out = value->getNumber();
+            }
+
+            static void compileCount(const object &keywords, const char *name, const std::string &pointer, size_t &out)
+            {
+                const Json *value = find(keywords, name);
+                if (!value)
+                    return;
+                double count = value->is_number() ? value->getNumber() : -1;
+                if (count < 0 || count != std::floor(count))
+                    schemaError(pointer + "/" + name, "must be a non-negative integer");
+                out = count >= 1.8e19 ? SIZE_MAX : static_cast<size_t>(count);
+            }
+        };
+
+        // 把树按SAX事件的顺序走一遍
+        void replay(const Json &value, JsonHandler &handler)
+        {
+            switch (value.type())
+            {
+            case JsonValueType::NUL:
+                handler.null();
+                break;
+            case JsonValueType::BOOL:
+                handler.boolean(value.getBool());
+                break;
+            case JsonValueType::INT64:
+                handler.integer(value.getInt64());
+                break;
+            case JsonValueType::UINT64:
+                handler.unsignedInteger(value.getUint64());
+                break;
+            case JsonValueType::NUMBER:
+                handler.number(value.getNumber());
+                break;
+            case JsonValueType::STRING:
+                handler.string(std::string_view(value.getString().data(), value.getString().size()));
+                break;
+            case JsonValueType::ARRAY:
+                handler.startArray();
+                for (const Json &item : value.getArray())
+                    replay(item, handler);
+                handler.endArray();
+                break;
+            case JsonValueType::OBJECT:
+                handler.startObject();
+                for (const auto &member : value.getObject())
+                {
+                    handler.key(std::string_view(member.first.data(), member.first.size()));
+                    replay(member.second, handler);
+                }
+                handler.endObject();
+                break;
+            }
+        }
+    }
+
+    Schema Schema::compile(const Json &schema)
+    {
+        auto compiled = std::make_shared<Compiled>();
+        SchemaCompiler(compiled->nodes).compile(schema, "");
+        return Schema(std::move(compiled));
+    }
+
+    bool Schema::validate(const Json &doc, std::vector<SchemaError> *errors) const
+    {
+        SchemaValidator validator(*this);
+        replay(doc, validator);
+        if (errors)
+            *errors = validator.errors();
+        return validator.ok();
+    }
+
+    bool Schema::validate(const std::string &text, std::vector<SchemaError> *errors, ParseError &parseError) const
+    {
+        SchemaValidator validator(*this);
+        bool parsed = parse(text, validator, parseError);
+        if (errors)
+            *errors = validator.errors();
+        return parsed && validator.ok();
+    }
+
+    ///////////////验证//////////////////////
+    class SchemaValidator::Impl
+    {
+    public:
+        explicit Impl(std::shared_ptr<const Schema::Compiled> compiled) : m_compiled(std::move(compiled)) {}
+
+        std::vector<SchemaError> errors;
+
+        void reset()
+        {
+            errors.clear();
+            m_frames.clear();
+            m_values.clear();
+            m_pointer.clear();
+            m_started = false;
+        }
+
+        // 标量: 先找到对应的schema, 再检查
+        // make只在要和enum比较或者外层在capture时才调用
+        template <typename Check, typename Make>
+        void scalar(unsigned types, Check &&check, Make &&make)
+        {
+            size_t index = enter();
+            const SchemaNode *node = index == NO_NODE ? nullptr : &m_compiled->nodes[index];
+            if (node && checkType(*node, types))
+                check(*node);
+            bool captured = !m_frames.empty() && m_frames.back().capture;
+            if ((node && node->hasEnum) || captured)
+            {
+                Json json = make();
+                if (node && node->hasEnum)
+                    checkEnum(*node, json);
+                if (captured)
+                    append(std::move(json));
+            }
+        }
+
+        void checkNumber(const SchemaNode &node, double value)
+        {
+            if (node.hasMinimum && value < node.minimum)
+                error("must be >= " + formatNumber(node.minimum));
+            if (node.hasMaximum && value > node.maximum)
+                error("must be <= " + formatNumber(node.maximum));
+            if (node.hasExclusiveMinimum && value <= node.exclusiveMinimum)
+                error("must be > " + formatNumber(node.exclusiveMinimum));
+            if (node.hasExclusiveMaximum && value >= node.exclusiveMaximum)
+                error("must be < " + formatNumber(node.exclusiveMaximum));
+        }
+
+        void checkString(const SchemaNode &node, std::string_view value)
+        {
+            if (node.minLength > 0 || node.maxLength != SIZE_MAX)
+            {
+                size_t length = utf8Length(value);
+                if (length < node.minLength)
+                    error("string shorter than " + std::to_string(node.minLength));
+                if (length > node.maxLength)
+                    error("string longer than " + std::to_string(node.maxLength));
+            }
+            if (node.hasPattern && !node.pattern.search(value))
+                error("does not match pattern " + node.patternText);
+        }
+
+        void startContainer(bool isObject)
+        {
+            size_t index = enter();
+            const SchemaNode *node = index == NO_NODE ? nullptr : &m_compiled->nodes[index];
+            if (node && !checkType(*node, isObject ? TYPE_OBJECT : TYPE_ARRAY))
+                index = NO_NODE; // 类型都不对, 里面的就不再检查了
+            bool capture = (node && node->hasEnum) || (!m_frames.empty() && m_frames.back().capture);
+            Frame frame;
+            frame.node = index;
+            frame.isObject = isObject;
+            frame.capture = capture;
+            frame.pointerLength = m_pointer.size();
+            if (isObject && index != NO_NODE)
+                frame.seen.assign(m_compiled->nodes[index].required.size(), false);
+            m_frames.push_back(std::move(frame));
+            if (capture)
+                m_values.emplace_back(isObject ? Json(object()) : Json(array()));
+        }
+
+        void key(std::string_view key)
+        {
+            Frame &frame = m_frames.back();
+            closeMember(frame);
+            if (frame.node != NO_NODE)
+            {
+                // 重复的key和parse()默认的一样以最后一个为准: 撤掉前一个的错误, 也不重复计数
+                auto previous = frame.members.find(key);
+                if (previous != frame.members.end())
+                {
+                    eraseErrors(frame, previous->second);
+                    frame.members.erase(previous);
+                    frame.count--;
+                }
+                frame.member.assign(key.data(), key.size());
+                frame.memberErrors = errors.size();
+                frame.inMember = true;
+            }
+            frame.count++;
+            m_pointer.resize(frame.pointerLength);
+            m_pointer += '/';
+            m_pointer += escapePointerToken(key);
+            if (frame.capture)
+                frame.key.assign(key.data(), key.size());
+            frame.child = NO_NODE;
+            if (frame.node == NO_NODE)
+                return;
+            const SchemaNode &node = m_compiled->nodes[frame.node];
+            auto property = node.properties.find(key);
+            frame.child = property != node.properties.end() ? property->second : node.additionalProperties;
+            auto required = node.requiredIndex.find(key);
+            if (required != node.requiredIndex.end())
+                frame.seen[required->second] = true;
+        }
+
+        void endContainer()
+        {
+            closeMember(m_frames.back());
+            Frame frame = std::move(m_frames.back());
+            m_frames.pop_back();
+            m_pointer.resize(frame.pointerLength);
+            if (frame.node != NO_NODE)
+            {
+                const SchemaNode &node = m_compiled->nodes[frame.node];
+                if (frame.isObject)
+                {
+                    for (size_t i = 0; i < node.required.size(); i++)
+                    {
+                        if (!frame.seen[i])
+                            error("missing required property \"" + node.required[i] + "\"");
+                    }
+                    if (frame.count < node.minProperties)
+                        error("fewer than " + std::to_string(node.minProperties) + " properties");
+                    if (frame.count > node.maxProperties)
+                        error("more than " + std::to_string(node.maxProperties) + " properties");
+                }
+                else
+                {
+                    if (frame.count < node.minItems)
+                        error("fewer than " + std::to_string(node.minItems) + " items");
+                    if (frame.count > node.maxItems)
+                        error("more than " + std::to_string(node.maxItems) + " items");
+                }
+            }
+            if (!frame.capture)
+                return;
+            Json value = std::move(m_values.back());
+            m_values.pop_back();
+            if (frame.node != NO_NODE && m_compiled->nodes[frame.node].hasEnum)
+                checkEnum(m_compiled->nodes[frame.node], value);
+            if (!m_frames.empty() && m_frames.back().capture)
+                append(std::move(value));
+        }
+
+    private:
+        struct Frame
+        {
+            size_t node = NO_NODE; // 这个容器自己的schema
+            bool isObject = false;
+            bool capture = false;  // 要把这个容器建成Json, 留给enum比较
+            size_t count = 0;      // 数组元素数/对象成员数
+            size_t pointerLength = 0;
+            size_t child = NO_NODE; // 对象: 当前key对应的schema
+            std::vector<bool> seen; // 对象: 出现过的required
+            std::string key;        // 对象: capture时当前的key
+            // 对象: 成员的key -> 它的值产生的错误在errors里的范围, 遇到重复的key时撤掉前一个
+            // 只有要数成员个数, 或者成员有错误时才记
+            std::map<std::string, std::pair<size_t, size_t>, std::less<>> members;
+            std::string member;      // 对象: 当前成员的key
+            size_t memberErrors = 0; // 对象: 当前成员开始时errors的大小
+            bool inMember = false;
+        };
+
+        std::shared_ptr<const Schema::Compiled> m_compiled;
+        std::vector<Frame> m_frames;
+        std::vector<Json> m_values; // capture中的容器
+        std::string m_pointer;      // 当前值的JSON Pointer
+        bool m_started = false;
+
+        // 当前成员结束了, 记下它的错误范围
+        void closeMember(Frame &frame)
+        {
+            if (!frame.inMember)
+                return;
+            frame.inMember = false;
+            const SchemaNode &node = m_compiled->nodes[frame.node];
+            bool counted = node.minProperties > 0 || node.maxProperties != SIZE_MAX;
+            if (counted || errors.size() > frame.memberErrors)
+                frame.members[std::move(frame.member)] = {frame.memberErrors, errors.size()};
+        }
+
+        // 删掉[range.first, range.second)的错误, 同一个对象里后面成员的范围跟着前移
+        // 外层对象当前的成员开始得更早, 里层的已经结束了, 都不受影响
+        void eraseErrors(Frame &frame, std::pair<size_t, size_t> range)
+        {
+            size_t removed = range.second - range.first;
+            if (removed == 0)
+                return;
+            errors.erase(errors.begin() + range.first, errors.begin() + range.second);
+            for (auto &member : frame.members)
+            {
+                if (member.second.first >= range.second)
+                {
+                    member.second.first -= removed;
+                    member.second.second -= removed;
+                }
+            }
+        }
+
+        void error(std::string message)
+        {
+            errors.push_back({m_pointer, std::move(message)});
+        }
+
+        // 一个新的值开始了, 返回它的schema, 顺便把m_pointer指到它
+        size_t enter()
+        {
+            size_t index = NO_NODE;
+            if (m_frames.empty())
+            {
+                if (m_started)
+                    error("more than one document");
+                m_started = true;
+                index = 0;
+            }
+            else if (m_frames.back().isObject)
+            {
+                index = m_frames.back().child;
+            }
+            else
+            {
+                Frame &frame = m_frames.back();
+                m_pointer.resize(frame.pointerLength);
+                m_pointer += '/';
+                m_pointer += std::to_string(frame.count++);
+                if (frame.node != NO_NODE)
+                    index = m_compiled->nodes[frame.node].items;
+            }
+            if (index != NO_NODE && m_compiled->nodes[index].reject)
+            {
+                error(m_frames.empty() || !m_frames.back().isObject ? "value is not allowed" : "property is not allowed");
+                return NO_NODE;
+            }
+            return index;
+        }
+
+        bool checkType(const SchemaNode &node, unsigned types)
+        {
+            if (node.types & types)
+                return true;
+            error("expected " + typeList(node.types) + ", got " + typeList(types & TYPE_INTEGER ? TYPE_INTEGER : types));
+            return false;
+        }
+
+        void checkEnum(const SchemaNode &node, const Json &value)
+        {
+            if (std::find(node.enumValues.begin(), node.enumValues.end(), value) == node.enumValues.end())
+                error("value is not in enum");
+        }
+
+        void append(Json value)
+        {
+            Frame &frame = m_frames.back();
+            if (frame.isObject)
+                m_values.back().addToObject(frame.key, value);
+            else
+                m_values.back().addToArray(value);
+        }
+    };
+
+    SchemaValidator::SchemaValidator(const Schema &schema, JsonHandler *next)
+        : m_impl(std::make_unique<Impl>(schema.m_compiled)), m_next(next) {}
+
+    SchemaValidator::~SchemaValidator() {}
+
+    bool SchemaValidator::ok() const
+    {
+        return m_impl->errors.empty();
+    }
+
+    const std::vector<SchemaError> &SchemaValidator::errors() const
+    {
+        return m_impl->errors;
+    }
+
+    void SchemaValidator::reset()
+    {
+        m_impl->reset();
+    }
+
+    bool SchemaValidator::null()
+    {
+        m_impl->scalar(
+            TYPE_NULL, [](const SchemaNode &) {}, [] { return Json(nullptr); });
+        return m_next ? m_next->null() : true;
+    }
+
+    bool SchemaValidator::boolean(bool value)
+    {
+        m_impl->scalar(
+            TYPE_BOOLEAN, [](const SchemaNode &) {}, [&] { return Json(value); });
+        return m_next ? m_next->boolean(value) : true;
+    }
+
+    bool SchemaValidator::integer(int64_t value)
+    {
+        m_impl->scalar(
+            TYPE_NUMBER | TYPE_INTEGER, [&](const SchemaNode &node) { m_impl->checkNumber(node, static_cast<double>(value)); },
+            [&] { return Json(value); });
+        return m_next ? m_next->integer(value) : true;
+    }
+
+    bool SchemaValidator::unsignedInteger(uint64_t value)
+    {
+        m_impl->scalar(
+            TYPE_NUMBER | TYPE_INTEGER, [&](const SchemaNode &node) { m_impl->checkNumber(node, static_cast<double>(value)); },
+            [&] { return Json(value); });
+        return m_next ? m_next->unsignedInteger(value) : true;
+    }
+
+    bool SchemaValidator::number(double value)
+    {
+        // 1.0这种也算integer
+        unsigned types = std::isfinite(value) && value == std::floor(value) ? TYPE_NUMBER | TYPE_INTEGER : TYPE_NUMBER;
+        m_impl->scalar(
+            types, [&](const SchemaNode &node) { m_impl->checkNumber(node, value); },
+            [&] { return Json(value); });
+        return m_next ? m_next->number(value) : true;
+    }
+
+    bool SchemaValidator::string(std::string_view value)
+    {
+        m_impl->scalar(
+            TYPE_STRING, [&](const SchemaNode &node) { m_impl->checkString(node, value); },
+            [&] { return Json(std::string(value)); });
+        return m_next ? m_next->string(value) : true;
+    }
+
+    bool SchemaValidator::startObject()
+    {
+        m_impl->startContainer(true);
+        return m_next ? m_next->startObject() : true;
+    }
+
+    bool SchemaValidator::key(std::string_view key)
+    {
+        m_impl->key(key);
+        return m_next ? m_next->key(key) : true;
+    }
+
+    bool SchemaValidator::endObject()
+    {
+        m_impl->endContainer();
+        return m_next ? m_next->endObject() : true;
+    }
+
+    bool SchemaValidator::startArray()
+    {
+        m_impl->startContainer(false);
+        return m_next ? m_next->startArray() : true;
+    }
+
+    bool SchemaValidator::endArray()
+    {
+        m_impl->endContainer();
+        return m_next ? m_next->endArray() : true;
+    }
+}
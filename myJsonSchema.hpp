@@ -0,0 +1,85 @@
+//
+//  myJsonSchema.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  JSON Schema(draft 2020-12的子集)
+//  支持的关键字: type, enum, const, properties, required, additionalProperties, items,
+//  minimum, maximum, exclusiveMinimum, exclusiveMaximum, minLength, maxLength, pattern,
+//  minItems, maxItems, minProperties, maxProperties, 其他关键字忽略
+//
+//  - Schema::compile只做一次, 关键字都解析成节点数组, pattern预先编译好, 验证时不再查schema文档
+//  - pattern是ECMA-262的子集(JSON Schema建议的那些, 不支持反向引用和环视), 用不回溯的NFA匹配,
+//    时间和字符串长度成线性, 不会因为客户端发来的长字符串爆栈
+//  - SchemaValidator是一个JsonHandler, 直接挂在SAX parse上边解析边验证, 不用建树再走一遍
+//    还可以把事件转发给下一个handler, 验证和业务处理在同一遍里完成
+//  - 错误的位置是JSON Pointer, 比如 /users/3/name
+//
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    struct SchemaError
+    {
+        std::string pointer; // 出错的值, 整个文档是空串
+        std::string message;
+    };
+
+    class Schema
+    {
+    public:
+        // schema本身不合法时抛myJsonException
+        static Schema compile(const Json &schema);
+
+        // 已经有树的时候, 把树按SAX事件的顺序走一遍
+        bool validate(const Json &doc, std::vector<SchemaError> *errors = nullptr) const;
+        // 解析和验证一遍完成, 不建树, json格式不对时填好parseError并返回false
+        bool validate(const std::string &text, std::vector<SchemaError> *errors, ParseError &parseError) const;
+
+        struct Compiled;
+
+    private:
+        explicit Schema(std::shared_ptr<const Compiled> compiled) : m_compiled(std::move(compiled)) {}
+
+        // 编译完就不变了, 拷贝Schema只是多一个引用, 可以在多个线程里同时用
+        std::shared_ptr<const Compiled> m_compiled;
+
+        friend class SchemaValidator;
+    };
+
+    // 收到的事件先验证, 再转发给next, 验证失败不会停止解析, 所有错误都记下来
+    // 重复的key和parse()默认的一样以最后一个为准, 前一个值的错误会撤掉, 成员数也只算一次
+    // 一个validator验证一个文档, 再用的话先reset
+    class SchemaValidator : public JsonHandler
+    {
+    public:
+        explicit SchemaValidator(const Schema &schema, JsonHandler *next = nullptr);
+        ~SchemaValidator() override;
+
+        bool ok() const;
+        const std::vector<SchemaError> &errors() const;
+        void reset();
+
+        bool null() override;
+        bool boolean(bool value) override;
+        bool integer(int64_t value) override;
+        bool unsignedInteger(uint64_t value) override;
+        bool number(double value) override;
+        bool string(std::string_view value) override;
+        bool startObject() override;
+        bool key(std::string_view key) override;
+        bool endObject() override;
+        bool startArray() override;
+        bool endArray() override;
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+        JsonHandler *m_next;
+    };
+}
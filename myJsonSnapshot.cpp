@@ -0,0 +1,597 @@
+//
+//  myJsonSnapshot.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonSnapshot.hpp"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace myJson
+{
+    namespace
+    {
+        const char SNAPSHOT_MAGIC[8] = {'M', 'Y', 'J', 'S', 'N', 'A', 'P', '\0'};
+        const uint32_t SNAPSHOT_VERSION = 1;
+        const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+        struct SnapNode
+        {
+            uint8_t type;
+            uint8_t reserved[3];
+            uint32_t count;   // 字符串长度 / 数组对象的元素个数
+            uint64_t payload; // 数值 / bool / 字符串偏移 / 子节点块偏移
+        };
+
+        struct SnapEntry
+        {
+            uint32_t keyLength;
+            uint32_t reserved;
+            uint64_t keyOffset;
+            SnapNode value;
+        };
+
+        struct SnapshotHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t size;
+            uint64_t stringsOffset;
+            SnapNode root;
+        };
+
+        static_assert(sizeof(SnapNode) == 16, "snapshot node must be 16 bytes");
+        static_assert(sizeof(SnapEntry) == 32, "snapshot entry must be 32 bytes");
+
+        // 映射的内存不保证对齐, 统一用memcpy读
+        template <typename T>
+        T load(const char *p)
+        {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            return value;
+        }
+
+        void checkRange(size_t size, uint64_t offset, uint64_t length)
+        {
+            if (offset > size || length > size - offset)
+            {
+                throw myJsonException("Bad snapshot: offset out of range", offset);
+            }
+        }
+
+        const SnapshotHeader loadHeader(const char *base)
+        {
+            return load<SnapshotHeader>(base);
+        }
+
+        ///////////////writer//////////////////////
+        class SnapshotWriter
+        {
+        public:
+            explicit SnapshotWriter(std::string &out) : m_out(out) {}
+
+            void write(const Json &json)
+            {
+                size_t start = m_out.size();
+                m_start = start;
+                m_out.append(sizeof(SnapshotHeader), '\0');
+
+                SnapNode root = encode(json);
+
+                SnapshotHeader header;
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+                header.version = SNAPSHOT_VERSION;
+                header.byteOrder = SNAPSHOT_BYTE_ORDER;
+                header.stringsOffset = m_out.size() - start;
+                header.root = root;
+                m_out += m_strings;
+                header.size = m_out.size() - start;
+                std::memcpy(&m_out[start], &header, sizeof(header));
+            }
+
+        private:
+            std::string &m_out;
+            std::string m_strings;
+            // key指向原Json里的字符串, 写快照期间Json不会变
+            std::unordered_map<std::string_view, uint64_t> m_stringIndex;
+            size_t m_start = 0;
+
+            uint64_t intern(std::string_view str)
+            {
+                auto iter = m_stringIndex.find(str);
+                if (iter != m_stringIndex.end())
+                {
+                    return iter->second;
+                }
+                uint64_t offset = m_strings.size();
+                m_strings += str;
+                m_stringIndex.emplace(str, offset);
+                return offset;
+            }
+
+            // 在末尾预留一块, 返回相对快照开头的偏移
+            uint64_t reserve(size_t bytes)
+            {
+                uint64_t offset = m_out.size() - m_start;
+                m_out.append(bytes, '\0');
+                return offset;
+            }
+
+            // 长度和个数在文件里是32位的, 截断了文件照样能通过校验, 只能在写的时候拦住
+            static uint32_t narrow(size_t count, const char *what)
+            {
+                if (count > std::numeric_limits<uint32_t>::max())
+                    throw myJsonException(std::string("[ERROR] snapshot: ") + what + " does not fit in 32 bits", 0);
+                return static_cast<uint32_t>(count);
+            }
+
+            SnapNode encode(const Json &json)
+            {
+                SnapNode node;
+                std::memset(&node, 0, sizeof(node));
+                node.type = static_cast<uint8_t>(json.type());
+                switch (json.type())
+                {
+                case JsonValueType::NUL:
+                    break;
+                case JsonValueType::BOOL:
+                    node.payload = json.getBool() ? 1 : 0;
+                    break;
+                case JsonValueType::NUMBER:
+                {
+                    double value = json.getNumber();
+                    std::memcpy(&node.payload, &value, sizeof(value));
+                    break;
+                }
+                case JsonValueType::INT64:
+                {
+                    int64_t value = json.getInt64();
+                    std::memcpy(&node.payload, &value, sizeof(value));
+                    break;
+                }
+                case JsonValueType::UINT64:
+                    node.payload = json.getUint64();
+                    break;
+                case JsonValueType::STRING:
+                {
+                    const jsonstring &str = json.getString();
+                    node.count = narrow(str.size(), "string length");
+                    node.payload = intern(str);
+                    break;
+                }
+                case JsonValueType::ARRAY:
+                {
+                    const array &items = json.getArray();
+                    node.count = narrow(items.size(), "array size");
+                    node.payload = reserve(items.size() * sizeof(SnapNode));
+                    uint64_t slot = node.payload;
+                    for (const auto &item : items)
+                    {
+                        // 先编码子节点(可能继续在末尾追加), 再写回预留的位置
+                        SnapNode child = encode(item);
+                        std::memcpy(&m_out[m_start + slot], &child, sizeof(child));
+                        slot += sizeof(SnapNode);
+                    }
+                    break;
+                }
+                case JsonValueType::OBJECT:
+                {
+                    // object是std::map, 遍历出来就是按key排好序的
+                    const object &members = json.getObject();
+                    node.count = narrow(members.size(), "object size");
+                    node.payload = reserve(members.size() * sizeof(SnapEntry));
+                    uint64_t slot = node.payload;
+                    for (const auto &member : members)
+                    {
+                        SnapEntry entry;
+                        std::memset(&entry, 0, sizeof(entry));
+                        entry.keyLength = narrow(member.first.size(), "key length");
+                        entry.keyOffset = intern(member.first);
+                        entry.value = encode(member.second);
+                        std::memcpy(&m_out[m_start + slot], &entry, sizeof(entry));
+                        slot += sizeof(SnapEntry);
+                    }
+                    break;
+                }
+                }
+                return node;
+            }
+        };
+    }
+
+    ///////////////iterators//////////////////////
+    SnapshotValue SnapshotArrayIter::operator*() const
+    {
+        return SnapshotValue(m_base, m_size, m_node);
+    }
+
+    SnapshotArrayIter &SnapshotArrayIter::operator++()
+    {
+        m_node += sizeof(SnapNode);
+        return *this;
+    }
+
+    SnapshotArrayIter SnapshotArrayIter::operator++(int)
+    {
+        SnapshotArrayIter old = *this;
+        ++*this;
+        return old;
+    }
+
+    SnapshotObjectIter::member SnapshotObjectIter::operator*() const
+    {
+        const SnapshotHeader header = loadHeader(m_base);
+        const SnapEntry entry = load<SnapEntry>(m_entry);
+        uint64_t offset = header.stringsOffset + entry.keyOffset;
+        checkRange(m_size, offset, entry.keyLength);
+        return member(std::string_view(m_base + offset, entry.keyLength),
+                      SnapshotValue(m_base, m_size, m_entry + offsetof(SnapEntry, value)));
+    }
+
+    SnapshotObjectIter::arrow_proxy SnapshotObjectIter::operator->() const
+    {
+        return arrow_proxy(**this);
+    }
+
+    SnapshotObjectIter &SnapshotObjectIter::operator++()
+    {
+        m_entry += sizeof(SnapEntry);
+        return *this;
+    }
+
+    SnapshotObjectIter SnapshotObjectIter::operator++(int)
+    {
+        SnapshotObjectIter old = *this;
+        ++*this;
+        return old;
+    }
+
+    ///////////////SnapshotValue//////////////////////
+    JsonValueType SnapshotValue::type() const
+    {
+        return static_cast<JsonValueType>(load<SnapNode>(m_node).type);
+    }
+
+    double SnapshotValue::getNumber() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        switch (static_cast<JsonValueType>(node.type))
+        {
+        case JsonValueType::NUMBER:
+        {
+            double value;
+            std::memcpy(&value, &node.payload, sizeof(value));
+            return value;
+        }
+        case JsonValueType::INT64:
+            return static_cast<double>(getInt64());
+        case JsonValueType::UINT64:
+            return static_cast<double>(node.payload);
+        default:
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+    }
+
+    int64_t SnapshotValue::getInt64() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::INT64))
+        {
+            // 其他数值类型的转换规则和Json一致
+            return toJson().getInt64();
+        }
+        int64_t value;
+        std::memcpy(&value, &node.payload, sizeof(value));
+        return value;
+    }
+
+    uint64_t SnapshotValue::getUint64() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::UINT64))
+        {
+            return toJson().getUint64();
+        }
+        return node.payload;
+    }
+
+    bool SnapshotValue::getBool() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::BOOL))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        return node.payload != 0;
+    }
+
+    std::string_view SnapshotValue::getString() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::STRING))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        uint64_t offset = loadHeader(m_base).stringsOffset + node.payload;
+        checkRange(m_size, offset, node.count);
+        return std::string_view(m_base + offset, node.count);
+    }
+
+    size_t SnapshotValue::size() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::ARRAY) && node.type != static_cast<uint8_t>(JsonValueType::OBJECT))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        return node.count;
+    }
+
+    SnapshotValue SnapshotValue::operator[](size_t index) const
+    {
+        if (!is_array())
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        if (index >= size())
+        {
+            throw myJsonException(std::string(__func__) + "index out of range", 0);
+        }
+        arrayBegin(); // 校验子节点块的范围
+        const SnapNode node = load<SnapNode>(m_node);
+        return SnapshotValue(m_base, m_size, m_base + node.payload + index * sizeof(SnapNode));
+    }
+
+    const char *SnapshotValue::findMember(std::string_view key) const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::OBJECT))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        // entry按key排好序, 二分查找
+        checkRange(m_size, node.payload, uint64_t(node.count) * sizeof(SnapEntry));
+        const char *entries = m_base + node.payload;
+        size_t lo = 0, hi = node.count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            std::string_view midKey = (*SnapshotObjectIter(m_base, m_size, entries + mid * sizeof(SnapEntry))).first;
+            int cmp = midKey.compare(key);
+            if (cmp == 0)
+            {
+                return entries + mid * sizeof(SnapEntry);
+            }
+            if (cmp < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return nullptr;
+    }
+
+    SnapshotValue SnapshotValue::operator[](std::string_view key) const
+    {
+        const char *entry = findMember(key);
+        if (!entry)
+        {
+            throw myJsonException(std::string(__func__) + "key[" + std::string(key) + "] not exists!", 0);
+        }
+        return SnapshotValue(m_base, m_size, entry + offsetof(SnapEntry, value));
+    }
+
+    bool SnapshotValue::contains(std::string_view key) const
+    {
+        return findMember(key) != nullptr;
+    }
+
+    SnapshotArrayIter SnapshotValue::arrayBegin() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::ARRAY))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        checkRange(m_size, node.payload, uint64_t(node.count) * sizeof(SnapNode));
+        return SnapshotArrayIter(m_base, m_size, m_base + node.payload);
+    }
+
+    SnapshotArrayIter SnapshotValue::arrayEnd() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        arrayBegin();
+        return SnapshotArrayIter(m_base, m_size, m_base + node.payload + uint64_t(node.count) * sizeof(SnapNode));
+    }
+
+    SnapshotObjectIter SnapshotValue::objectBegin() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        if (node.type != static_cast<uint8_t>(JsonValueType::OBJECT))
+        {
+            THROW_INVALID_TYPE_EXCEPTION(type());
+        }
+        checkRange(m_size, node.payload, uint64_t(node.count) * sizeof(SnapEntry));
+        return SnapshotObjectIter(m_base, m_size, m_base + node.payload);
+    }
+
+    SnapshotObjectIter SnapshotValue::objectEnd() const
+    {
+        const SnapNode node = load<SnapNode>(m_node);
+        objectBegin();
+        return SnapshotObjectIter(m_base, m_size, m_base + node.payload + uint64_t(node.count) * sizeof(SnapEntry));
+    }
+
+    Json SnapshotValue::toJson() const
+    {
+        switch (type())
+        {
+        case JsonValueType::NUL:
+            return Json(nullptr);
+        case JsonValueType::BOOL:
+            return Json(getBool());
+        case JsonValueType::NUMBER:
+            return Json(getNumber());
+        case JsonValueType::INT64:
+            return Json(getInt64());
+        case JsonValueType::UINT64:
+            return Json(getUint64());
+        case JsonValueType::STRING:
+            return Json(jsonstring(getString()));
+        case JsonValueType::ARRAY:
+        {
+            array out;
+            out.reserve(size());
+            for (auto iter = arrayBegin(); iter != arrayEnd(); ++iter)
+            {
+                out.emplace_back((*iter).toJson());
+            }
+            return Json(std::move(out));
+        }
+        case JsonValueType::OBJECT:
+        {
+            object out;
+            for (auto iter = objectBegin(); iter != objectEnd(); ++iter)
+            {
+                out.emplace_hint(out.end(), iter->first, iter->second.toJson());
+            }
+            return Json(std::move(out));
+        }
+        }
+        throw myJsonException("Bad snapshot: unknown node type", 0);
+    }
+
+    ///////////////Snapshot//////////////////////
+    Snapshot::Snapshot(const char *data, size_t size)
+        : Snapshot(data, size, false) {}
+
+    Snapshot::Snapshot(const char *data, size_t size, bool mapped)
+        : m_data(data), m_size(size), m_mapped(mapped)
+    {
+        if (size < sizeof(SnapshotHeader))
+        {
+            release();
+            throw myJsonException("Bad snapshot: too small", 0);
+        }
+        const SnapshotHeader header = loadHeader(data);
+        const char *error = nullptr;
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+            error = "Bad snapshot: wrong magic";
+        else if (header.version != SNAPSHOT_VERSION)
+            error = "Bad snapshot: unsupported version";
+        else if (header.byteOrder != SNAPSHOT_BYTE_ORDER)
+            error = "Bad snapshot: byte order mismatch";
+        else if (header.size > size || header.stringsOffset > header.size)
+            error = "Bad snapshot: truncated";
+        if (error)
+        {
+            release();
+            throw myJsonException(error, 0);
+        }
+    }
+
+    Snapshot::Snapshot(Snapshot &&other) noexcept
+        : m_data(other.m_data), m_size(other.m_size), m_mapped(other.m_mapped)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_mapped = false;
+    }
+
+    Snapshot &Snapshot::operator=(Snapshot &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_mapped = other.m_mapped;
+            other.m_data = nullptr;
+            other.m_size = 0;
+            other.m_mapped = false;
+        }
+        return *this;
+    }
+
+    Snapshot::~Snapshot() noexcept
+    {
+        release();
+    }
+
+    void Snapshot::release() noexcept
+    {
+        if (m_mapped && m_data)
+        {
+            munmap(const_cast<char *>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_mapped = false;
+    }
+
+    Snapshot Snapshot::open(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw myJsonException("Cannot open snapshot: " + path, 0);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            throw myJsonException("Cannot stat snapshot: " + path, 0);
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // 映射建立之后fd就可以关掉了
+        if (addr == MAP_FAILED)
+        {
+            throw myJsonException("Cannot mmap snapshot: " + path, 0);
+        }
+        return Snapshot(static_cast<const char *>(addr), size, true);
+    }
+
+    SnapshotValue Snapshot::root() const
+    {
+        return SnapshotValue(m_data, m_size, m_data + offsetof(SnapshotHeader, root));
+    }
+
+    ///////////////dump//////////////////////
+    void dumpSnapshot(const Json &json, std::string &out)
+    {
+        SnapshotWriter writer(out);
+        writer.write(json);
+    }
+
+    std::string dumpSnapshot(const Json &json)
+    {
+        std::string out;
+        dumpSnapshot(json, out);
+        return out;
+    }
+
+    void writeSnapshot(const Json &json, const std::string &path)
+    {
+        std::string out = dumpSnapshot(json);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw myJsonException("Cannot write snapshot: " + path, 0);
+        }
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file)
+        {
+            throw myJsonException("Cannot write snapshot: " + path, 0);
+        }
+    }
+}
@@ -0,0 +1,157 @@
+//
+//  myJsonSnapshot.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  二进制快照: 把Json拍平成带偏移的tape, 可以直接mmap后只读访问, 不需要反序列化
+//
+//  文件布局 (本机字节序, 所有偏移都是相对文件开头):
+//      [SnapshotHeader][节点块...][字符串池]
+//  - 每个节点16字节: type + count + payload, 整数按INT64/UINT64原样存
+//  - keepNumberText解析出来的数字只存数值, 原文不进快照
+//  - 数组: payload指向count个连续的子节点
+//  - 对象: payload指向count个按key排序的entry(key + 子节点), 查找用二分
+//  - 字符串和key只在字符串池里存一份, payload是相对字符串池的偏移
+//
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    class SnapshotArrayIter;
+    class SnapshotObjectIter;
+
+    // 快照里的一个值, 只是(base, node)两个指针, 拷贝很便宜
+    // 读接口和Json保持一致, 字符串以string_view返回, 指向映射的内存
+    class SnapshotValue
+    {
+    public:
+        constexpr SnapshotValue(const char *base, size_t size, const char *node)
+            : m_base(base), m_size(size), m_node(node) {}
+
+        JsonValueType type() const;
+        bool is_null() const { return type() == JsonValueType::NUL; }
+        bool is_number() const { return isNumberType(type()); }
+        bool is_integer() const { return type() == JsonValueType::INT64 || type() == JsonValueType::UINT64; }
+        bool is_bool() const { return type() == JsonValueType::BOOL; }
+        bool is_string() const { return type() == JsonValueType::STRING; }
+        bool is_array() const { return type() == JsonValueType::ARRAY; }
+        bool is_object() const { return type() == JsonValueType::OBJECT; }
+
+        double getNumber() const;
+        int64_t getInt64() const;
+        uint64_t getUint64() const;
+        bool getBool() const;
+        std::string_view getString() const;
+
+        // 数组/对象的元素个数
+        size_t size() const;
+        SnapshotValue operator[](size_t index) const;
+        SnapshotValue operator[](std::string_view key) const;
+        bool contains(std::string_view key) const;
+
+        SnapshotArrayIter arrayBegin() const;
+        SnapshotArrayIter arrayEnd() const;
+        SnapshotObjectIter objectBegin() const;
+        SnapshotObjectIter objectEnd() const;
+
+        // 还原成Json(会分配内存), 调试或需要修改时用
+        Json toJson() const;
+
+    private:
+        const char *m_base;
+        size_t m_size;
+        const char *m_node;
+
+        const char *findMember(std::string_view key) const;
+    };
+
+    // 数组迭代器
+    class SnapshotArrayIter
+    {
+    public:
+        SnapshotArrayIter(const char *base, size_t size, const char *node)
+            : m_base(base), m_size(size), m_node(node) {}
+
+        SnapshotValue operator*() const;
+        SnapshotArrayIter &operator++();
+        SnapshotArrayIter operator++(int);
+        bool operator==(const SnapshotArrayIter &other) const { return m_node == other.m_node; }
+        bool operator!=(const SnapshotArrayIter &other) const { return m_node != other.m_node; }
+
+    private:
+        const char *m_base;
+        size_t m_size;
+        const char *m_node;
+    };
+
+    // 对象迭代器, 解引用得到(key, value), 用法和objectiter的first/second一致
+    class SnapshotObjectIter
+    {
+    public:
+        using member = std::pair<std::string_view, SnapshotValue>;
+
+        class arrow_proxy
+        {
+        public:
+            explicit arrow_proxy(member &&m) : m_member(std::move(m)) {}
+            const member *operator->() const { return &m_member; }
+
+        private:
+            member m_member;
+        };
+
+        SnapshotObjectIter(const char *base, size_t size, const char *entry)
+            : m_base(base), m_size(size), m_entry(entry) {}
+
+        member operator*() const;
+        arrow_proxy operator->() const;
+        SnapshotObjectIter &operator++();
+        SnapshotObjectIter operator++(int);
+        bool operator==(const SnapshotObjectIter &other) const { return m_entry == other.m_entry; }
+        bool operator!=(const SnapshotObjectIter &other) const { return m_entry != other.m_entry; }
+
+    private:
+        const char *m_base;
+        size_t m_size;
+        const char *m_entry;
+    };
+
+    // 打开的快照, 要么持有mmap的映射, 要么只是一段外部内存的视图
+    class Snapshot
+    {
+    public:
+        // 不拷贝也不持有data, data要比Snapshot活得久
+        Snapshot(const char *data, size_t size);
+        Snapshot(Snapshot &&other) noexcept;
+        Snapshot &operator=(Snapshot &&other) noexcept;
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+        ~Snapshot() noexcept;
+
+        // mmap整个文件, 只校验文件头, 加载时间和文件大小无关
+        static Snapshot open(const std::string &path);
+
+        SnapshotValue root() const;
+        const char *data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        bool m_mapped;
+
+        Snapshot(const char *data, size_t size, bool mapped);
+        void release() noexcept;
+    };
+
+    // 生成快照
+    void dumpSnapshot(const Json &json, std::string &out);
+    std::string dumpSnapshot(const Json &json);
+    void writeSnapshot(const Json &json, const std::string &path);
+}
@@ -0,0 +1,188 @@
+//
+//  myJsonTemplate.cpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+#include "myJsonTemplate.hpp"
+#include <algorithm>
+
+namespace myJson
+{
+    // 按writeAny的格式走一遍骨架, 遇到槽就切一段
+    class TemplateCompiler
+    {
+    public:
+        explicit TemplateCompiler(Template &tpl) : m_tpl(tpl) {}
+
+        void compile(const Json &skeleton)
+        {
+            write(skeleton);
+            m_tpl.m_segments.push_back(std::move(m_current));
+            for (const std::string &segment : m_tpl.m_segments)
+                m_tpl.m_constantBytes += segment.size();
+        }
+
+    private:
+        Template &m_tpl;
+        std::string m_current;
+
+        // "{{name}}" -> name, 不是槽返回空
+        static std::string_view slotName(const Json &value)
+        {
+            if (!value.is_string())
+                return std::string_view();
+            const jsonstring &str = value.getString();
+            std::string_view text(str.data(), str.size());
+            if (text.size() <= 4 || text.substr(0, 2) != "{{" || text.substr(text.size() - 2) != "}}")
+                return std::string_view();
+            return text.substr(2, text.size() - 4);
+        }
+
+        void hole(std::string_view name)
+        {
+            auto iter = std::find(m_tpl.m_names.begin(), m_tpl.m_names.end(), name);
+            size_t slot = static_cast<size_t>(iter - m_tpl.m_names.begin());
+            if (iter == m_tpl.m_names.end())
+                m_tpl.m_names.emplace_back(name);
+            m_tpl.m_segments.push_back(std::move(m_current));
+            m_current.clear();
+            m_tpl.m_holes.push_back(slot);
+        }
+
+        void write(const Json &value)
+        {
+            switch (value.type())
+            {
+            case JsonValueType::ARRAY:
+            {
+                m_current += '[';
+                bool first = true;
+                for (const Json &item : value.getArray())
+                {
+                    if (!first)
+                        m_current += ',';
+                    first = false;
+                    write(item);
+                }
+                m_current += ']';
+                break;
+            }
+            case JsonValueType::OBJECT:
+            {
+                m_current += '{';
+                bool first = true;
+                for (const auto &member : value.getObject())
+                {
+                    if (!first)
+                        m_current += ',';
+                    first = false;
+                    bind::writeString(m_current, std::string_view(member.first.data(), member.first.size()));
+                    m_current += ':';
+                    write(member.second);
+                }
+                m_current += '}';
+                break;
+            }
+            default:
+            {
+                std::string_view name = slotName(value);
+                if (!name.empty())
+                    hole(name);
+                else
+                    bind::writeAny(m_current, value);
+                break;
+            }
+            }
+        }
+    };
+
+    ///////////////Template//////////////////////
+    Template Template::compile(const Json &skeleton)
+    {
+        Template tpl;
+        TemplateCompiler(tpl).compile(skeleton);
+        return tpl;
+    }
+
+    size_t Template::slot(std::string_view name) const
+    {
+        auto iter = std::find(m_names.begin(), m_names.end(), name);
+        if (iter == m_names.end())
+        {
+            throw myJsonException("Template has no slot: " + std::string(name), 0);
+        }
+        return static_cast<size_t>(iter - m_names.begin());
+    }
+
+    void Template::render(const TemplateArgs &args, std::string &out) const
+    {
+        if (args.m_template != this)
+        {
+            throw myJsonException("TemplateArgs belongs to another template", 0);
+        }
+        // 先算好总长度, 整个输出只分配一次
+        size_t bytes = m_constantBytes;
+        for (size_t hole : m_holes)
+        {
+            if (!args.m_set[hole])
+            {
+                throw myJsonException("Template slot not set: " + m_names[hole], 0);
+            }
+            bytes += args.m_values[hole].size();
+        }
+        out.reserve(out.size() + bytes);
+        out += m_segments[0];
+        for (size_t i = 0; i < m_holes.size(); i++)
+        {
+            out += args.m_values[m_holes[i]];
+            out += m_segments[i + 1];
+        }
+    }
+
+    std::string Template::render(const TemplateArgs &args) const
+    {
+        std::string out;
+        render(args, out);
+        return out;
+    }
+
+    ///////////////TemplateArgs//////////////////////
+    TemplateArgs::TemplateArgs(const Template &tpl)
+        : m_template(&tpl), m_values(tpl.slotCount()), m_set(tpl.slotCount(), false) {}
+
+    std::string &TemplateArgs::begin(size_t slot)
+    {
+        if (slot >= m_values.size())
+        {
+            throw myJsonException("Template slot out of range: " + std::to_string(slot), 0);
+        }
+        m_set[slot] = true;
+        m_values[slot].clear();
+        return m_values[slot];
+    }
+
+    TemplateArgs &TemplateArgs::setSlot(size_t slot, std::string_view value)
+    {
+        bind::writeString(begin(slot), value);
+        return *this;
+    }
+
+    TemplateArgs &TemplateArgs::setSlot(size_t slot, const char *value)
+    {
+        return setSlot(slot, std::string_view(value));
+    }
+
+    TemplateArgs &TemplateArgs::setSlot(size_t slot, std::nullptr_t)
+    {
+        begin(slot) += "null";
+        return *this;
+    }
+
+    void TemplateArgs::clear()
+    {
+        std::fill(m_set.begin(), m_set.end(), false);
+        for (std::string &value : m_values)
+            value.clear();
+    }
+}
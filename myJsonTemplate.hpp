@@ -0,0 +1,94 @@
+//
+//  myJsonTemplate.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  响应模板: 结构固定, 只有少数几个值每次不同
+//
+//      Template tpl = Template::compile(parse(R"({"code": 0, "data": {"id": "{{id}}", "name": "{{name}}"}})"));
+//      TemplateArgs args(tpl);
+//      args.set("id", 42).set("name", user.name);
+//      std::string body = tpl.render(args);
+//
+//  - 骨架里值正好是 "{{名字}}" 的字符串就是一个槽, 同名的槽可以出现多次, key不能做槽
+//  - compile时把槽之间的常量部分一次写好, render只把各段和槽的值按顺序拼起来
+//  - 槽的值在set时就转义/格式化好(规则和writeJson一样), 同一个TemplateArgs可以clear后复用, 缓冲区不释放
+//  - 输出是紧凑的合法json, 和把值填进骨架后writeJson的结果相同
+//
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "myJson.hpp"
+#include "myJsonBind.hpp"
+
+namespace myJson
+{
+    class TemplateArgs;
+
+    class Template
+    {
+    public:
+        static Template compile(const Json &skeleton);
+
+        size_t slotCount() const { return m_names.size(); }
+        const std::string &slotName(size_t slot) const { return m_names[slot]; }
+        // 没有这个槽时抛myJsonException
+        size_t slot(std::string_view name) const;
+
+        // 追加到out后面, 有槽没set时抛myJsonException
+        void render(const TemplateArgs &args, std::string &out) const;
+        std::string render(const TemplateArgs &args) const;
+
+    private:
+        Template() = default;
+
+        // m_segments比m_holes多一个: seg0 hole0 seg1 hole1 ... segN
+        std::vector<std::string> m_segments;
+        std::vector<size_t> m_holes; // 每个位置填哪个槽
+        std::vector<std::string> m_names;
+        size_t m_constantBytes = 0;
+
+        friend class TemplateCompiler;
+    };
+
+    // 一次render用到的槽值, 和编译它的Template绑定
+    class TemplateArgs
+    {
+    public:
+        explicit TemplateArgs(const Template &tpl);
+
+        // 值的类型和writeJson支持的一样, 另外还可以是string_view/const char*/nullptr
+        template <typename T>
+        TemplateArgs &set(std::string_view name, const T &value)
+        {
+            return setSlot(m_template->slot(name), value);
+        }
+
+        template <typename T>
+        TemplateArgs &setSlot(size_t slot, const T &value)
+        {
+            std::string &out = begin(slot);
+            bind::writeValue(out, value);
+            return *this;
+        }
+
+        TemplateArgs &setSlot(size_t slot, std::string_view value);
+        TemplateArgs &setSlot(size_t slot, const char *value);
+        TemplateArgs &setSlot(size_t slot, std::nullptr_t);
+
+        // 清掉所有的值, 保留缓冲区给下一次用
+        void clear();
+
+    private:
+        const Template *m_template;
+        std::vector<std::string> m_values;
+        std::vector<bool> m_set;
+
+        std::string &begin(size_t slot);
+
+        friend class Template;
+    };
+}
@@ -0,0 +1,179 @@
+//
+//  myJsonVisit.hpp
+//  myJson
+//
+//  Created by garyxuan on 2026/10/19.
+//
+//  按类型分派的访问和原地改写
+//
+//      size_t strings = 0;
+//      visit(json, overloaded{[&](const jsonstring &) { strings++; }, [](const auto &) {}});
+//
+//      transform(payload, [](Json &value, const TransformSite &site) {
+//          if (site.isMember && site.key == "ssn")
+//          {
+//              value = "***";
+//              return TransformAction::SKIP;
+//          }
+//          return site.key == "debug" ? TransformAction::REMOVE : TransformAction::DESCEND;
+//      });
+//
+//  - visit对一个节点只有一次虚调用(Json::view), 然后按类型调visitor的一个重载, 参数是
+//    std::nullptr_t / bool / int64_t / uint64_t / double / const jsonstring & / const array & / const object &
+//    要往下走就在visitor里对子节点再visit, 不用type()之后再getArray()/getObject()各一次check和虚调用
+//  - transform按深度优先的先序把每个值交给fn, 栈在堆上, 嵌套多深都不递归, 节点原地改, 不拷贝
+//    fn可以随意改传进来的值(包括换成别的类型, 返回DESCEND时按新的值往下走), 不能动它所在的容器
+//    数组里删掉的元素在这一层结束时一次挪走, 不是每删一个挪一次
+//
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "myJson.hpp"
+
+namespace myJson
+{
+    // 把几个lambda拼成一个visitor
+    template <typename... Fs>
+    struct overloaded : Fs...
+    {
+        using Fs::operator()...;
+    };
+    template <typename... Fs>
+    overloaded(Fs...) -> overloaded<Fs...>;
+
+    // 各个重载的返回类型要一样, 和std::visit一样
+    template <typename Visitor>
+    decltype(auto) visit(const Json &json, Visitor &&visitor)
+    {
+        JsonView view = json.view();
+        switch (view.type)
+        {
+        case JsonValueType::BOOL:
+            return visitor(view.boolean);
+        case JsonValueType::INT64:
+            return visitor(view.int64);
+        case JsonValueType::UINT64:
+            return visitor(view.uint64);
+        case JsonValueType::NUMBER:
+            return visitor(view.number);
+        case JsonValueType::STRING:
+            return visitor(*view.string);
+        case JsonValueType::ARRAY:
+            return visitor(*view.items);
+        case JsonValueType::OBJECT:
+            return visitor(*view.members);
+        default:
+            return visitor(nullptr);
+        }
+    }
+
+    enum class TransformAction
+    {
+        DESCEND, // 接着看这个值的子节点(不是容器就和SKIP一样)
+        SKIP,    // 不看这个值的子节点
+        REMOVE   // 从所在的数组/对象里删掉; 根没有地方删, 变成null
+    };
+
+    // fn拿到的值在树里的位置
+    struct TransformSite
+    {
+        std::string_view key; // 对象成员的key, 只在fn执行期间有效
+        size_t index;         // 数组元素在原数组里的下标
+        size_t depth;         // 根是0
+        bool isMember;        // 对象成员还是数组元素(根两个都不是, key为空index为0)
+    };
+
+    // fn(Json &value, const TransformSite &site) -> TransformAction
+    // fn抛异常时已经删掉的都删好了, 没看到的保持原样, 异常原样抛出
+    template <typename F>
+    void transform(Json &root, F &&fn)
+    {
+        // 数组: [0, write)是留下的, [write, read)是删掉的或者已经挪走的空位, [read, size)还没看
+        struct Frame
+        {
+            array *items;
+            object *members;
+            size_t read;
+            size_t write;
+            objectiter next;
+            size_t depth; // 子节点的深度
+        };
+
+        TransformAction action = fn(root, TransformSite{std::string_view(), 0, 0, false});
+        if (action == TransformAction::REMOVE)
+        {
+            root = Json(nullptr);
+            return;
+        }
+        if (action == TransformAction::SKIP)
+            return;
+
+        std::vector<Frame> stack;
+        auto enter = [&stack](Json &value, size_t depth)
+        {
+            JsonView view = value.mutableView(); // 路径上的容器都会清掉缓存的hash
+            if (view.type == JsonValueType::ARRAY)
+                stack.push_back(Frame{const_cast<array *>(view.items), nullptr, 0, 0, objectiter(), depth});
+            else if (view.type == JsonValueType::OBJECT)
+            {
+                object *members = const_cast<object *>(view.members);
+                stack.push_back(Frame{nullptr, members, 0, 0, members->begin(), depth});
+            }
+        };
+
+        try
+        {
+            enter(root, 1);
+            while (!stack.empty())
+            {
+                Frame &frame = stack.back();
+                size_t depth = frame.depth;
+                if (frame.items)
+                {
+                    array &items = *frame.items;
+                    if (frame.read == items.size())
+                    {
+                        items.erase(items.begin() + frame.write, items.end());
+                        stack.pop_back();
+                        continue;
+                    }
+                    size_t index = frame.read;
+                    action = fn(items[index], TransformSite{std::string_view(), index, depth, false});
+                    frame.read++;
+                    if (action == TransformAction::REMOVE)
+                        continue;
+                    Json &kept = items[frame.write];
+                    if (frame.write++ != index)
+                        kept = std::move(items[index]); // 同一个数组同一个resource, 只是挪指针
+                    if (action == TransformAction::DESCEND)
+                        enter(kept, depth + 1);
+                }
+                else
+                {
+                    if (frame.next == frame.members->end())
+                    {
+                        stack.pop_back();
+                        continue;
+                    }
+                    objectiter member = frame.next;
+                    action = fn(member->second, TransformSite{std::string_view(member->first.data(), member->first.size()), 0, depth, true});
+                    frame.next++;
+                    if (action == TransformAction::REMOVE)
+                        frame.members->erase(member);
+                    else if (action == TransformAction::DESCEND)
+                        enter(member->second, depth + 1);
+                }
+            }
+        }
+        catch (...)
+        {
+            for (Frame &frame : stack)
+            {
+                if (frame.items)
+                    frame.items->erase(frame.items->begin() + frame.write, frame.items->begin() + frame.read);
+            }
+            throw;
+        }
+    }
+}